@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../waresim/sim/algo/dispatch/matching_dispatch_algo.h"
+#include "../waresim/sim/concurrent/thread_pool.h"
+#include "../waresim/sim/order.h"
+#include "../waresim/sim/rand/rand.h"
+#include "../waresim/sim/warehouse.h"
+
+/**
+ * Times the matching dispatch algorithm on consecutive batches of random
+ * orders. Each batch is assigned on top of the last, so the later batches
+ * show the effect of the warm start and of the workers' growing loads.
+ *
+ * The arguments are the warehouse file, the number of orders in each batch,
+ * the number of threads and the number of batches. bench_warehouse.txt has
+ * 1000 workers, so the defaults time 1000 orders against 1000 workers.
+ */
+int main(int argc, char **argv)
+{
+    std::string warehouse_file = argc > 1 ? argv[1] : "bench_warehouse.txt";
+    int num_orders = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int threads = argc > 3 ? std::atoi(argv[3]) : 1;
+    int batches = argc > 4 ? std::atoi(argv[4]) : 3;
+
+    Warehouse warehouse = Warehouse::parse_default_warehouse(warehouse_file);
+    std::vector<int> bins = warehouse.get_bins();
+    if (bins.empty() || num_orders < 1 || threads < 1)
+    {
+        std::cout << "Usage: ./dispatch-bench [warehouse] [orders] [threads] "
+            << "[batches]" << std::endl;
+        return 1;
+    }
+
+    std::cout << warehouse.get_workers().size() << " workers, " << num_orders
+        << " orders per batch, " << threads << " threads" << std::endl;
+
+    ThreadPool pool(threads);
+    MatchingDispatchAlgo algo(&pool);
+    Rand rand(5);
+
+    for (int batch = 0; batch < batches; batch++)
+    {
+        std::vector<Order> orders{};
+        for (int i = 0; i < num_orders; i++)
+            orders.push_back(Order(bins[(int) (rand.rand() * bins.size())]));
+
+        auto start = std::chrono::steady_clock::now();
+        algo.assign_orders(&warehouse, orders);
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "Batch " << batch << ": "
+            << std::chrono::duration<double, std::milli>(end - start).count()
+            << " ms" << std::endl;
+    }
+
+    return 0;
+}
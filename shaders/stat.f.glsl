@@ -0,0 +1,36 @@
+varying vec2 texpos;
+uniform sampler2D tex;
+// The size of the grid in cells.
+uniform vec2 cells;
+// The size the grid is drawn at in pixels.
+uniform vec2 pixels;
+
+// The most samples taken along each axis of a pixel.
+const int SAMPLES = 4;
+
+// Maps [0, 1] to blue, cyan, green, yellow and red.
+vec3 heat(float val) {
+  if (val < 0.25)
+    return vec3(0, val / 0.25, 1);
+  if (val < 0.5)
+    return vec3(0, 1, 1 - (val - 0.25) / 0.25);
+  if (val < 0.75)
+    return vec3((val - 0.5) / 0.25, 1, 0);
+  return vec3(1, 1 - (val - 0.75) / 0.25, 0);
+}
+
+void main(void) {
+  // A pixel covering several cells averages a few samples spread over them.
+  vec2 n = clamp(ceil(cells / pixels), 1.0, float(SAMPLES));
+  float sum = 0.0;
+  for (int i = 0; i < SAMPLES; i++) {
+    for (int j = 0; j < SAMPLES; j++) {
+      if (float(i) < n.x && float(j) < n.y) {
+        vec2 offset = (vec2(float(i), float(j)) + 0.5) / n - 0.5;
+        sum += texture2D(tex, texpos + offset / pixels).r;
+      }
+    }
+  }
+
+  gl_FragColor = vec4(heat(clamp(sum / (n.x * n.y), 0.0, 1.0)), 1);
+}
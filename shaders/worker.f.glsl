@@ -0,0 +1,5 @@
+varying vec3 f_color;
+
+void main(void) {
+  gl_FragColor = vec4(f_color, 1);
+}
@@ -0,0 +1,32 @@
+attribute vec3 coord;
+attribute vec3 normal;
+attribute vec3 color;
+attribute vec2 offset;
+// Whether GL_LIGHTING and GL_LIGHT0 are enabled.
+uniform bool lighting;
+uniform bool light0;
+varying vec3 f_color;
+
+void main(void) {
+  vec4 pos = vec4(coord.x + offset.x, coord.y, coord.z + offset.y, 1);
+  gl_Position = gl_ModelViewProjectionMatrix * pos;
+
+  if (!lighting) {
+    f_color = color;
+    return;
+  }
+
+  // Light the worker as the fixed-function pipeline would, with the color as
+  // its ambient and diffuse material (GL_COLOR_MATERIAL).
+  vec3 lit = gl_LightModel.ambient.rgb * color;
+  if (light0) {
+    vec3 n = normalize(gl_NormalMatrix * normal);
+    vec4 light = gl_LightSource[0].position;
+    vec3 dir = light.w == 0.0 ? light.xyz
+      : light.xyz - (gl_ModelViewMatrix * pos).xyz;
+    float diffuse = max(dot(n, normalize(dir)), 0.0);
+    lit += gl_LightSource[0].ambient.rgb * color
+      + diffuse * gl_LightSource[0].diffuse.rgb * color;
+  }
+  f_color = clamp(lit, 0.0, 1.0);
+}
@@ -22,7 +22,10 @@ ConfigParser::~ConfigParser()
 }
 
 /**
- * Parse the config file.
+ * Parse the config file. Throws if the config asks for something its engine
+ * cannot do, such as a checkpoint on the tick engine or a planner on the
+ * event engine, or if replicates or a sweep are missing the number of ticks to
+ * simulate.
  */
 void ConfigParser::parse()
 {
@@ -42,64 +45,171 @@ void ConfigParser::parse()
             continue;
         }
 
-        // Rename the parts.
-        std::string key = parts[0];
-        std::string value = parts[1];
+        set(parts[0], parts[1]);
+    }
 
-        if (key == "Length")
-        {
-            sim_length = std::stoi(value);
-        }
-        else if (key == "Warehouse")
-        {
-            warehouse = value;
-        }
-        else if (key == "Seed")
-        {
-            // We use stol because seed is an unsigned int, so we need the
-            // extra space.
-            seed = std::stol(value);
-        }
-        else if (key == "Log")
-        {
-            log_dir = value;
-        }
-        else if (key == "View")
-        {
-            view = value;
-        }
-        else if (key == "Wait")
-        {
-            wait_time = std::stoi(value);
-        }
-        else if (key == "Dispatch")
-        {
-            dispatch = value;
-        }
-        else if (key == "Routing")
-        {
-            routing = value;
-        }
-        else if (key == "Path")
-        {
-            path_algo = value;
-        }
-        else if (key == "Decay")
-        {
-            decay_factor = strtod(value.c_str(), nullptr);
-        }
-        else if (key == "Order")
-        {
-            order_algo = value;
-        }
-        else if (key == "Contention")
-        {
-            contention_algo = value;
-        }
-        else // Print a simple error if we do not recognize this parameter.
-        {
-            std::cout << "Unrecognized var: " << parts[0] << std::endl;
-        }
+    // Only the event engine can write or continue from checkpoints. Replicates
+    // and sweeps always run on the event engine.
+    if (engine != "Event" && replicates == 0 && sweep.empty() &&
+            (!checkpoint.empty() || !restore.empty()))
+        throw("Checkpoint and Restore need Engine:Event.");
+    // The event engine moves the workers one by one, without a planner.
+    if (engine == "Event" && replicates == 0 && sweep.empty() &&
+            (planner != "None" || moves != "Sequential"))
+        throw("Engine:Event supports neither a Planner nor Moves:TwoPhase.");
+    // Replicates have no view to stop them, so they need a number of ticks.
+    if (replicates > 0 && sweep.empty() && ticks <= 0)
+        throw("Replicates need Ticks to be set.");
+    if (!sweep.empty() && ticks <= 0)
+        throw("Sweeps need Ticks to be set.");
+}
+
+/**
+ * Sets a config parameter, as if its line had been read from the config
+ * file.
+ *
+ * @param key The name of the parameter.
+ * @param value The value of the parameter.
+ */
+void ConfigParser::set(std::string key, std::string value)
+{
+    if (key == "Length")
+    {
+        sim_length = std::stoi(value);
+    }
+    else if (key == "Warehouse")
+    {
+        warehouse = value;
+    }
+    else if (key == "Seed")
+    {
+        // We use stol because seed is an unsigned int, so we need the
+        // extra space.
+        seed = std::stol(value);
+    }
+    else if (key == "Log")
+    {
+        log_dir = value;
+    }
+    else if (key == "View")
+    {
+        view = value;
+    }
+    else if (key == "Wait")
+    {
+        wait_time = std::stoi(value);
+    }
+    else if (key == "Dispatch")
+    {
+        dispatch = value;
+    }
+    else if (key == "Routing")
+    {
+        routing = value;
+    }
+    else if (key == "Path")
+    {
+        path_algo = value;
+    }
+    else if (key == "Decay")
+    {
+        decay_factor = strtod(value.c_str(), nullptr);
+    }
+    else if (key == "Order")
+    {
+        order_algo = value;
+    }
+    else if (key == "Contention")
+    {
+        contention_algo = value;
+    }
+    else if (key == "DropWeight")
+    {
+        drop_weight = strtod(value.c_str(), nullptr);
+    }
+    else if (key == "Planner")
+    {
+        planner = value;
+    }
+    else if (key == "PlannerBudget")
+    {
+        planner_budget = std::stoi(value);
+    }
+    else if (key == "Moves")
+    {
+        moves = value;
+    }
+    else if (key == "Engine")
+    {
+        engine = value;
+    }
+    else if (key == "Ticks")
+    {
+        ticks = std::stol(value);
+    }
+    else if (key == "OrderRate")
+    {
+        order_rate = strtod(value.c_str(), nullptr);
+    }
+    else if (key == "Pipeline")
+    {
+        pipeline = std::stoi(value);
+    }
+    else if (key == "Threads")
+    {
+        threads = std::stoi(value);
+    }
+    else if (key == "Replicates")
+    {
+        replicates = std::stoi(value);
+    }
+    else if (key == "Sweep")
+    {
+        sweep = value;
+    }
+    else if (key == "Checkpoint")
+    {
+        checkpoint = value;
+    }
+    else if (key == "CheckpointEvery")
+    {
+        checkpoint_every = std::stol(value);
+    }
+    else if (key == "Restore")
+    {
+        restore = value;
+    }
+    else if (key == "ForkAt")
+    {
+        fork_at = std::stol(value);
+    }
+    else if (key == "Record")
+    {
+        record = value;
+    }
+    else if (key == "Replay")
+    {
+        replay = value;
+    }
+    else if (key == "FPS")
+    {
+        fps = std::stoi(value);
+    }
+    else if (key == "Frames")
+    {
+        frames = value;
+    }
+    else if (key == "FrameEvery")
+    {
+        frame_every = std::stol(value);
+    }
+    else if (key == "Socket")
+    {
+        socket = value;
+    }
+    else // Print a simple error if we do not recognize this parameter.
+    {
+        std::cout << "Unrecognized var: " << key << std::endl;
     }
 }
 
@@ -198,3 +308,179 @@ double ConfigParser::get_decay_factor()
 {
     return decay_factor;
 }
+
+/**
+ * Returns the weight given to drop location congestion.
+ */
+double ConfigParser::get_drop_weight()
+{
+    return drop_weight;
+}
+
+/**
+ * Returns the planning algorithm.
+ */
+std::string ConfigParser::get_planner()
+{
+    return planner;
+}
+
+/**
+ * Returns the planning time budget per step in milliseconds.
+ */
+int ConfigParser::get_planner_budget()
+{
+    return planner_budget;
+}
+
+/**
+ * Returns how the scheduler makes moves.
+ */
+std::string ConfigParser::get_moves()
+{
+    return moves;
+}
+
+/**
+ * Returns the simulation engine.
+ */
+std::string ConfigParser::get_engine()
+{
+    return engine;
+}
+
+/**
+ * Returns the number of ticks to simulate, or 0 if there is no limit.
+ */
+long ConfigParser::get_ticks()
+{
+    return ticks;
+}
+
+/**
+ * Returns the probability that an order arrives each tick.
+ */
+double ConfigParser::get_order_rate()
+{
+    return order_rate;
+}
+
+/**
+ * Returns how many ticks the pipeline stages may run ahead.
+ */
+int ConfigParser::get_pipeline()
+{
+    return pipeline;
+}
+
+/**
+ * Returns the number of threads in the thread pool, or 0 for one per hardware
+ * thread.
+ */
+int ConfigParser::get_threads()
+{
+    return threads;
+}
+
+/**
+ * Returns the number of replicates to run, or 0 to run a single simulation.
+ */
+int ConfigParser::get_replicates()
+{
+    return replicates;
+}
+
+/**
+ * Returns the sweep file, or an empty string if this is not a sweep.
+ */
+std::string ConfigParser::get_sweep()
+{
+    return sweep;
+}
+
+/**
+ * Returns the file the event engine writes checkpoints to, or an empty string
+ * if it writes none.
+ */
+std::string ConfigParser::get_checkpoint()
+{
+    return checkpoint;
+}
+
+/**
+ * Returns the number of ticks between checkpoints, or 0 to only write one
+ * when the simulation stops.
+ */
+long ConfigParser::get_checkpoint_every()
+{
+    return checkpoint_every;
+}
+
+/**
+ * Returns the checkpoint to continue from, or an empty string to start a new
+ * simulation.
+ */
+std::string ConfigParser::get_restore()
+{
+    return restore;
+}
+
+/**
+ * Returns the number of ticks to simulate before sweeps and replicates fork
+ * from the simulation, or 0 to not fork.
+ */
+long ConfigParser::get_fork_at()
+{
+    return fork_at;
+}
+
+/**
+ * Returns the replay log to record the run in, or an empty string to not
+ * record.
+ */
+std::string ConfigParser::get_record()
+{
+    return record;
+}
+
+/**
+ * Returns the replay log to replay, or an empty string to run a new
+ * simulation.
+ */
+std::string ConfigParser::get_replay()
+{
+    return replay;
+}
+
+/**
+ * Returns the number of frames the view renders each second, or 0 to render
+ * as many as possible.
+ */
+int ConfigParser::get_fps()
+{
+    return fps;
+}
+
+/**
+ * Returns the directory the 'Software' view writes its frames to.
+ */
+std::string ConfigParser::get_frames()
+{
+    return frames;
+}
+
+/**
+ * Returns the number of ticks between the frames of the 'Software' view.
+ */
+long ConfigParser::get_frame_every()
+{
+    return frame_every;
+}
+
+/**
+ * Returns the path of the socket the 'Stream' view streams to.
+ */
+std::string ConfigParser::get_socket()
+{
+    return socket;
+}
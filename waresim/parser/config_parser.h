@@ -16,6 +16,8 @@ class ConfigParser : public Parser
 
         // Parse the config file.
         void parse() override;
+        // Set a config parameter.
+        void set(std::string, std::string);
 
         // Returns the length of the simulation.
         int get_sim_length();
@@ -41,6 +43,48 @@ class ConfigParser : public Parser
         std::string get_contention_algo();
         // Returns the decay factor.
         double get_decay_factor();
+        // Returns the weight given to drop location congestion.
+        double get_drop_weight();
+        // Returns the planning algorithm.
+        std::string get_planner();
+        // Returns the planning time budget.
+        int get_planner_budget();
+        // Returns how the scheduler makes moves.
+        std::string get_moves();
+        // Returns the simulation engine.
+        std::string get_engine();
+        // Returns the number of ticks to simulate.
+        long get_ticks();
+        // Returns the order arrival rate.
+        double get_order_rate();
+        // Returns how many ticks the pipeline stages may run ahead.
+        int get_pipeline();
+        // Returns the number of threads in the thread pool.
+        int get_threads();
+        // Returns the number of replicates to run.
+        int get_replicates();
+        // Returns the sweep file.
+        std::string get_sweep();
+        // Returns the checkpoint file.
+        std::string get_checkpoint();
+        // Returns the number of ticks between checkpoints.
+        long get_checkpoint_every();
+        // Returns the checkpoint to continue from.
+        std::string get_restore();
+        // Returns the tick sweeps and replicates fork at.
+        long get_fork_at();
+        // Returns the replay log to record in.
+        std::string get_record();
+        // Returns the replay log to replay.
+        std::string get_replay();
+        // Returns the number of frames the view renders each second.
+        int get_fps();
+        // Returns the directory the software view writes frames to.
+        std::string get_frames();
+        // Returns the number of ticks between the software view's frames.
+        long get_frame_every();
+        // Returns the path of the socket the stream view streams to.
+        std::string get_socket();
     private:
         // The configuration file to parse.
         std::string config{"config"};
@@ -69,6 +113,59 @@ class ConfigParser : public Parser
         std::string contention_algo = "Backoff";
         // The decay factor to use for the heat window.
         double decay_factor = 0.9;
+        // The weight given to congestion when choosing a drop location. The
+        // default only considers distance.
+        double drop_weight = 0.0;
+        // The planning algorithm. The default is no planning.
+        std::string planner = "None";
+        // The planning time budget per step in milliseconds.
+        int planner_budget = 5;
+        // How the scheduler makes moves. The default moves the workers one by
+        // one.
+        std::string moves = "Sequential";
+        // The simulation engine. The default steps every component each tick.
+        std::string engine = "Tick";
+        // The number of ticks to simulate in the event engine. The default
+        // is no limit other than the simulation length.
+        long ticks = 0;
+        // The probability that an order arrives each tick.
+        double order_rate = 0.5;
+        // How many ticks the order generator and dispatcher may run ahead of
+        // the scheduler. The default runs them in lockstep.
+        int pipeline = 0;
+        // The number of threads in the thread pool. The default uses one per
+        // hardware thread.
+        int threads = 0;
+        // The number of independent simulations to run at once. The default
+        // runs a single simulation with the view.
+        int replicates = 0;
+        // The file listing the values to sweep over. The default is no sweep.
+        std::string sweep = "";
+        // The file the event engine writes checkpoints to. The default writes
+        // none.
+        std::string checkpoint = "";
+        // The number of ticks between checkpoints. The default only writes
+        // one when the simulation stops.
+        long checkpoint_every = 0;
+        // The checkpoint to continue from. The default starts a new
+        // simulation.
+        std::string restore = "";
+        // The number of ticks to simulate before sweeps and replicates fork
+        // from the simulation. The default does not fork.
+        long fork_at = 0;
+        // The replay log to record the run in. The default does not record.
+        std::string record = "";
+        // The replay log to replay. The default runs a new simulation.
+        std::string replay = "";
+        // The number of frames the view renders each second. 0 renders as
+        // many as possible.
+        int fps = 60;
+        // The directory the software view writes its frames to.
+        std::string frames = "frames";
+        // The number of ticks between the frames of the software view.
+        long frame_every = 1;
+        // The path of the socket the stream view streams to.
+        std::string socket = "waresim.sock";
 };
 
 #endif
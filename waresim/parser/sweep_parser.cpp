@@ -0,0 +1,144 @@
+#include "sweep_parser.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/**
+ * Constructor.
+ *
+ * @param sweep The location of the sweep file to parse.
+ */
+SweepParser::SweepParser(std::string sweep)
+{
+    this->sweep = sweep;
+}
+
+/**
+ * Destructor.
+ */
+SweepParser::~SweepParser()
+{
+
+}
+
+/**
+ * Parse the sweep file.
+ */
+void SweepParser::parse()
+{
+    auto lines = read_file(sweep);
+    for (auto& line : lines)
+    {
+        // Only the first ':' separates the parameter from its values, since
+        // ranges use ':' before the step.
+        std::size_t split = line.find(':');
+        if (split == std::string::npos)
+        {
+            std::cout << "Invalid format for: " << line << std::endl;
+            continue;
+        }
+
+        std::vector<std::string> key_values;
+        for (auto& value : split_string(line.substr(split + 1), ','))
+        {
+            if (value.find("..") == std::string::npos)
+            {
+                key_values.push_back(value);
+                continue;
+            }
+
+            for (auto& v : expand_range(value))
+                key_values.push_back(v);
+        }
+
+        if (key_values.empty())
+            throw("Sweep parameter has no values.");
+
+        keys.push_back(line.substr(0, split));
+        values.push_back(key_values);
+    }
+}
+
+/**
+ * Expands a range written as start..end:step into its values, from start up
+ * to and including end. If the start, end and step are all integers, so are
+ * the values.
+ *
+ * @param range The range to expand.
+ *
+ * @return The values in the range.
+ */
+std::vector<std::string> SweepParser::expand_range(std::string range)
+{
+    std::size_t dots = range.find("..");
+    std::size_t colon = range.find(':', dots);
+    if (colon == std::string::npos)
+        throw("Sweep range has no step.");
+
+    std::string start_text = range.substr(0, dots);
+    std::string end_text = range.substr(dots + 2, colon - dots - 2);
+    std::string step_text = range.substr(colon + 1);
+
+    double start = strtod(start_text.c_str(), nullptr);
+    double end = strtod(end_text.c_str(), nullptr);
+    double step = strtod(step_text.c_str(), nullptr);
+    if (step <= 0.0 || end < start)
+        throw("Invalid sweep range.");
+
+    bool integral = (range.find_first_of(".eE", dots + 2) == std::string::npos)
+        && (start_text.find_first_of(".eE") == std::string::npos);
+
+    // Allow for rounding in the division, so that the end is included.
+    long count = std::floor((end - start) / step + 1e-9) + 1;
+
+    std::vector<std::string> range_values;
+    for (long i = 0; i < count; i++)
+    {
+        std::ostringstream out;
+        if (integral)
+            out << std::llround(start + i * step);
+        else
+            out << std::setprecision(10) << start + i * step;
+        range_values.push_back(out.str());
+    }
+
+    return range_values;
+}
+
+/**
+ * Returns the swept parameters, in the order they appear in the sweep file.
+ */
+std::vector<std::string> SweepParser::get_keys()
+{
+    return keys;
+}
+
+/**
+ * Returns every combination of the parameters' values. Each point holds a
+ * value for every parameter, in the order of get_keys(). The last parameter
+ * changes fastest.
+ */
+std::vector<std::vector<std::pair<std::string,std::string>>>
+    SweepParser::get_points()
+{
+    std::vector<std::vector<std::pair<std::string,std::string>>> points{{}};
+
+    for (std::size_t k = 0; k < keys.size(); k++)
+    {
+        std::vector<std::vector<std::pair<std::string,std::string>>> next;
+        for (auto& point : points)
+        {
+            for (auto& value : values[k])
+            {
+                next.push_back(point);
+                next.back().push_back({keys[k], value});
+            }
+        }
+        points = next;
+    }
+
+    return points;
+}
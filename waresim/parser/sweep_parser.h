@@ -0,0 +1,47 @@
+#ifndef PARSER_SWEEP_PARSER_H
+#define PARSER_SWEEP_PARSER_H
+
+#include "parser.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Parses a sweep file, which lists the values to try for some config
+ * parameters. Each line holds a parameter and its values, separated by the
+ * first ':'. The values are separated by commas, and each one is either a
+ * single value or a range written as start..end:step, which includes both
+ * ends. For example:
+ *
+ *     Dispatch:Rand,Nearest
+ *     Decay:0.9..0.99:0.01
+ *
+ * The points of the sweep are every combination of the values.
+ */
+class SweepParser : public Parser
+{
+    public:
+        SweepParser(std::string);
+        ~SweepParser();
+
+        // Parse the sweep file.
+        void parse() override;
+
+        // Returns the swept parameters, in the order they appear in the file.
+        std::vector<std::string> get_keys();
+        // Returns every combination of the parameters' values.
+        std::vector<std::vector<std::pair<std::string,std::string>>> get_points();
+    private:
+        // Expands a range into its values.
+        std::vector<std::string> expand_range(std::string);
+
+        // The sweep file to parse.
+        std::string sweep;
+        // The swept parameters.
+        std::vector<std::string> keys{};
+        // The values of each parameter.
+        std::vector<std::vector<std::string>> values{};
+};
+
+#endif
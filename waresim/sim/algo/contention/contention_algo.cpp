@@ -16,3 +16,36 @@ ContentionAlgo::~ContentionAlgo()
 {
 
 }
+
+/**
+ * Called before the workers are scheduled in each iteration. Algorithms that
+ * keep track of state across contentions can reset it here. Does nothing by
+ * default.
+ */
+void ContentionAlgo::new_iteration(Warehouse *)
+{
+
+}
+
+/**
+ * Writes the state of the algorithm to a checkpoint, so that a restored
+ * simulation continues the same way. Does nothing by default, which is right
+ * for algorithms without any state. Algorithms with state, such as a random
+ * number generator, should override this and load().
+ *
+ * @param writer The checkpoint to write to.
+ */
+void ContentionAlgo::save(CheckpointWriter&)
+{
+
+}
+
+/**
+ * Restores the state written by save(). Does nothing by default.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void ContentionAlgo::load(CheckpointReader&)
+{
+
+}
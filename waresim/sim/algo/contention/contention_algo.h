@@ -21,6 +21,12 @@ class ContentionAlgo
         // Called when a contention must be handle.
         virtual void handle(Worker&, Worker&, Warehouse *,
                 bool, bool, bool, bool, Logger *) = 0;
+        // Called before the workers are scheduled in each iteration.
+        virtual void new_iteration(Warehouse *);
+        // Writes the state of the algorithm to a checkpoint.
+        virtual void save(CheckpointWriter&);
+        // Restores the state of the algorithm from a checkpoint.
+        virtual void load(CheckpointReader&);
     private:
 };
 
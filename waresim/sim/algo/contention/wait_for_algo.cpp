@@ -0,0 +1,297 @@
+// Implementation of wait_for_algo.h
+#include "wait_for_algo.h"
+
+#include <string>
+
+#include "../../constants.h"
+
+/**
+ * Constructor.
+ */
+WaitForAlgo::WaitForAlgo()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+WaitForAlgo::~WaitForAlgo()
+{
+
+}
+
+/**
+ * Starts a new iteration. Every worker is processed once per iteration, so the
+ * wait-for edges from the last iteration are out of date and are cleared.
+ *
+ * @param warehouse The warehouse for the simulation.
+ */
+void WaitForAlgo::new_iteration(Warehouse *warehouse)
+{
+    std::size_t num_workers = warehouse->get_workers().size();
+    if (waits.size() != num_workers)
+    {
+        waits = std::vector<int>(num_workers, -1);
+        blocked_for = std::vector<int>(num_workers, 0);
+    }
+
+    last_waits = waits;
+    waits.assign(num_workers, -1);
+}
+
+/**
+ * Returns true if the first worker has a lower priority than the second.
+ * Workers carrying more picked orders are closer to a drop and have a higher
+ * priority, and ties are broken by the worker ID like BackoffAlgo.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param a The index of the first worker.
+ * @param b The index of the second worker.
+ */
+bool WaitForAlgo::lower_priority(Warehouse *warehouse, int a, int b)
+{
+    auto& workers = warehouse->get_workers();
+    std::size_t load_a = workers[a].get_ready_orders().size();
+    std::size_t load_b = workers[b].get_ready_orders().size();
+
+    if (load_a != load_b)
+        return load_a < load_b;
+    return workers[a].get_id() < workers[b].get_id();
+}
+
+/**
+ * Returns a free position next to a worker. The worker tries left, right,
+ * back and up, in that order, like BackoffAlgo.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param pos The position of the worker.
+ *
+ * @return A free empty location next to the worker, or -1 if there is none.
+ */
+int WaitForAlgo::find_side_step(Warehouse *warehouse, int pos)
+{
+    const std::vector<int>& layout = warehouse->get_layout();
+    auto& index = warehouse->get_worker_index();
+    int width = warehouse->get_width();
+    int height = warehouse->get_height();
+
+    std::vector<int> neighbors{};
+    // Left neighbor.
+    if ((pos % width) != 0)
+        neighbors.push_back(pos - 1);
+    // Right neighbor.
+    if (((pos+1) % width) != 0)
+        neighbors.push_back(pos + 1);
+    // Bottom neighbor.
+    if (pos >= width)
+        neighbors.push_back(pos - width);
+    // Top neighbor.
+    if ((pos / width) != (height-1))
+        neighbors.push_back(pos + width);
+
+    for (auto& neigh : neighbors)
+    {
+        if (layout[neigh] == EMPTY_LOC && index.get_worker(neigh) == -1)
+            return neigh;
+    }
+
+    return -1;
+}
+
+/**
+ * Resolves a cycle in the wait-for graph. Workers in the cycle are tried from
+ * the lowest priority up, and the first one with a free neighbor steps aside.
+ * The worker being scheduled moves straight away. Any other worker in the
+ * cycle has already been scheduled this iteration, so it is given a detour
+ * that it will take in the next iteration.
+ *
+ * @param worker The worker being scheduled.
+ * @param warehouse The warehouse for the simulation.
+ * @param cycle The indexes of the workers in the cycle.
+ * @param logger The logger to use.
+ *
+ * @return True if a worker stepped aside.
+ */
+bool WaitForAlgo::resolve_cycle(Worker& worker, Warehouse *warehouse,
+        std::vector<int>& cycle, Logger *logger)
+{
+    auto& workers = warehouse->get_workers();
+
+    // Order the workers in the cycle from the lowest priority up.
+    std::vector<int> order = cycle;
+    for (std::size_t i = 1; i < order.size(); i++)
+    {
+        for (std::size_t j = i; j > 0 && lower_priority(warehouse, order[j], order[j-1]); j--)
+            std::swap(order[j], order[j-1]);
+    }
+
+    for (auto& victim : order)
+    {
+        Worker& v = workers[victim];
+        int curr_pos = v.get_pos();
+        int side_pos = find_side_step(warehouse, curr_pos);
+        if (side_pos == -1)
+            continue;
+
+        // Step aside, then return to the current position and carry on.
+        auto path = v.get_path();
+        path.insert(path.begin(), curr_pos);
+
+        if (v.get_id() == worker.get_id())
+        {
+            v.set_pos(side_pos);
+            warehouse->move_worker(curr_pos, side_pos);
+        }
+        else
+        {
+            path.insert(path.begin(), side_pos);
+        }
+        v.set_path(path);
+
+        // The victim no longer waits for anyone, which breaks the cycle.
+        waits[victim] = -1;
+        blocked_for[victim] = 0;
+
+        log_msg = std::string{"Wait-for cycle of length "};
+        log_msg.append(std::to_string(cycle.size()));
+        log_msg.append(" resolved, worker # ");
+        log_msg.append(std::to_string(v.get_id()));
+        log_msg.append(" steps aside to position: ");
+        log_msg.append(std::to_string(side_pos));
+        logger->log(log_msg);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Handles the contention. The worker waits for the worker in its way, unless
+ * this closes a cycle of waiting workers or it has been waiting for too long.
+ * Free neighbors are looked up in the worker index, so the flags passed in by
+ * the scheduler are not needed.
+ */
+void WaitForAlgo::handle(Worker& worker, Worker& next_pos_worker,
+        Warehouse *warehouse, bool, bool, bool, bool, Logger * logger)
+{
+    // Make sure the graph has been set up even if no iteration has started.
+    if (waits.size() != warehouse->get_workers().size())
+        new_iteration(warehouse);
+
+    auto& index = warehouse->get_worker_index();
+    // Get the path for the worker we are scheduling.
+    auto path = worker.get_path();
+    // Get the next position.
+    int next_pos = path[0];
+    // Get the old position.
+    int curr_pos = worker.get_pos();
+
+    int w = index.get_worker(curr_pos);
+    int b = index.get_worker(next_pos);
+    if (w == -1 || b == -1)
+    {
+        warehouse->move_worker(curr_pos, curr_pos);
+        return;
+    }
+
+    // Add the wait-for edge. A worker that has been waiting for the same
+    // worker since the last iteration is still blocked.
+    waits[w] = b;
+    if (!last_waits.empty() && last_waits[w] == b)
+        blocked_for[w]++;
+    else
+        blocked_for[w] = 1;
+
+    // Each worker waits for at most one other, so any new cycle must go
+    // through this worker. Follow the waits from the blocking worker to see
+    // if they lead back here.
+    std::vector<int> cycle{w};
+    int curr = b;
+    while (curr != -1 && curr != w && cycle.size() <= waits.size())
+    {
+        cycle.push_back(curr);
+        curr = waits[curr];
+    }
+
+    if (curr == w)
+    {
+        if (resolve_cycle(worker, warehouse, cycle, logger))
+        {
+            cycles_resolved++;
+
+            log_msg = std::string{"Wait-for cycles resolved: "};
+            log_msg.append(std::to_string(cycles_resolved));
+            logger->log(log_msg);
+
+            // The scheduled worker may have been the one to step aside.
+            if (worker.get_pos() != curr_pos)
+                return;
+        }
+        else
+        {
+            // Nobody in the cycle can move.
+            log_msg = std::string{"Deadlock found!"};
+            logger->log(log_msg, LogLevel::Warning);
+            warehouse->mark_deadlock(curr_pos);
+        }
+    }
+    else if (blocked_for[w] > PATIENCE)
+    {
+        // The worker in the way is not going anywhere, so step around it.
+        int side_pos = find_side_step(warehouse, curr_pos);
+        if (side_pos != -1)
+        {
+            worker.set_pos(side_pos);
+            path.insert(path.begin(), curr_pos);
+            worker.set_path(path);
+            warehouse->move_worker(curr_pos, side_pos);
+            waits[w] = -1;
+            blocked_for[w] = 0;
+
+            log_msg = std::string{"Worker # "};
+            log_msg.append(std::to_string(worker.get_id()));
+            log_msg.append(" gave up waiting, moving to position: ");
+            log_msg.append(std::to_string(side_pos));
+            logger->log(log_msg);
+            return;
+        }
+    }
+
+    // Wait for this iteration.
+    log_msg = std::string{"Worker # "};
+    log_msg.append(std::to_string(worker.get_id()));
+    log_msg.append(" waits for worker # ");
+    log_msg.append(std::to_string(next_pos_worker.get_id()));
+    logger->log(log_msg);
+
+    warehouse->move_worker(curr_pos, curr_pos);
+    warehouse->mark_contention(next_pos);
+}
+
+/**
+ * Writes the wait-for graph and how long each worker has been blocked to a
+ * checkpoint.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void WaitForAlgo::save(CheckpointWriter& writer)
+{
+    writer.write_ints(waits);
+    writer.write_ints(last_waits);
+    writer.write_ints(blocked_for);
+    writer.write_int(cycles_resolved);
+}
+
+/**
+ * Restores the wait-for graph from a checkpoint.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void WaitForAlgo::load(CheckpointReader& reader)
+{
+    waits = reader.read_ints();
+    last_waits = reader.read_ints();
+    blocked_for = reader.read_ints();
+    cycles_resolved = reader.read_int();
+}
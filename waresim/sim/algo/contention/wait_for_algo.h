@@ -0,0 +1,58 @@
+#ifndef WARESIM_SIM_ALGO_CONTENTION_WAIT_FOR_ALGO_H
+#define WARESIM_SIM_ALGO_CONTENTION_WAIT_FOR_ALGO_H
+
+/*
+ * A contention algorithm that keeps a wait-for graph of the blocked workers.
+ * A blocked worker normally waits for the worker in front of it to move on.
+ * When the waits form a cycle none of the workers can ever move, so the
+ * worker in the cycle with the lowest priority steps aside and lets the others
+ * through. Workers that have been blocked by the same worker for too long
+ * (for example by an idle worker) also step aside.
+ */
+#include "contention_algo.h"
+
+#include <vector>
+
+class WaitForAlgo : public ContentionAlgo
+{
+    public:
+        WaitForAlgo();
+        ~WaitForAlgo();
+
+        // Handles the contention.
+        void handle(Worker&, Worker&, Warehouse*,
+                bool, bool, bool, bool, Logger *) override;
+        // Resets the wait-for graph for a new iteration.
+        void new_iteration(Warehouse *) override;
+        // Writes the state of the algorithm to a checkpoint.
+        void save(CheckpointWriter&) override;
+        // Restores the state of the algorithm from a checkpoint.
+        void load(CheckpointReader&) override;
+
+    private:
+        // Returns the lower priority of two workers.
+        bool lower_priority(Warehouse *, int, int);
+        // Returns a free position next to a worker, or -1.
+        int find_side_step(Warehouse *, int);
+        // Resolves a cycle in the wait-for graph.
+        bool resolve_cycle(Worker&, Warehouse *, std::vector<int>&, Logger *);
+
+        // The worker each worker is waiting for this iteration, or -1.
+        std::vector<int> waits{};
+        // The worker each worker waited for in the last iteration, or -1.
+        std::vector<int> last_waits{};
+        // The number of consecutive iterations each worker has waited for the
+        // same worker.
+        std::vector<int> blocked_for{};
+        // The number of cycles resolved so far.
+        int cycles_resolved = 0;
+
+        // The number of iterations a worker waits for the same worker before
+        // stepping aside.
+        const int PATIENCE = 4;
+
+        // Used for logging.
+        std::string log_msg;
+};
+
+#endif
@@ -7,3 +7,50 @@ DispatchAlgo::~DispatchAlgo()
 {
 
 }
+
+/**
+ * Assigns a batch of orders to the workers in the warehouse. The default
+ * implementation assigns the orders one at a time, in the order they were
+ * generated. Algorithms that can optimize over the whole batch should override
+ * this method.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param orders The orders to assign.
+ *
+ * @return The ids of the workers that were assigned each order, in the same
+ * order as the orders.
+ */
+std::vector<int> DispatchAlgo::assign_orders(Warehouse *warehouse,
+        std::vector<Order>& orders)
+{
+    std::vector<int> ids{};
+    ids.reserve(orders.size());
+
+    for (auto& order : orders)
+        ids.push_back(assign_order(warehouse, order));
+
+    return ids;
+}
+
+/**
+ * Writes the state of the algorithm to a checkpoint, so that a restored
+ * simulation continues the same way. Does nothing by default, which is right
+ * for algorithms without any state. Algorithms with state, such as a random
+ * number generator, should override this and load().
+ *
+ * @param writer The checkpoint to write to.
+ */
+void DispatchAlgo::save(CheckpointWriter&)
+{
+
+}
+
+/**
+ * Restores the state written by save(). Does nothing by default.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void DispatchAlgo::load(CheckpointReader&)
+{
+
+}
@@ -1,6 +1,8 @@
 #ifndef SIM_ALGO_DISPATCH_DISPATCH_ALGO_H
 #define SIM_ALGO_DISPATCH_DISPATCH_ALGO_H
 
+#include <vector>
+
 #include "../../order.h"
 #include "../../warehouse.h"
 #include "../../../logger/logger.h"
@@ -14,6 +16,12 @@ class DispatchAlgo
         virtual ~DispatchAlgo();
         // Assigns the order to one of the workers in the warehouse.
         virtual int assign_order(Warehouse *, Order) = 0;
+        // Assigns a batch of orders to the workers in the warehouse.
+        virtual std::vector<int> assign_orders(Warehouse *, std::vector<Order>&);
+        // Writes the state of the algorithm to a checkpoint.
+        virtual void save(CheckpointWriter&);
+        // Restores the state of the algorithm from a checkpoint.
+        virtual void load(CheckpointReader&);
     private:
 
 };
@@ -0,0 +1,477 @@
+#include "matching_dispatch_algo.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+/**
+ * Constructor. Bids are computed on the calling thread.
+ */
+MatchingDispatchAlgo::MatchingDispatchAlgo()
+{
+
+}
+
+/**
+ * Constructor.
+ *
+ * @param pool The thread pool used to compute bids.
+ */
+MatchingDispatchAlgo::MatchingDispatchAlgo(ThreadPool *pool)
+{
+    this->pool = pool;
+    if (pool != nullptr)
+        this->num_threads = pool->size();
+}
+
+/**
+ * Destructor.
+ */
+MatchingDispatchAlgo::~MatchingDispatchAlgo()
+{
+
+}
+
+/**
+ * Returns the position a worker starts from when it goes to a new order. This
+ * is the bin of its newest order if it has one, since it will fulfill that
+ * order first, and its current position otherwise.
+ *
+ * @param worker The worker.
+ */
+int MatchingDispatchAlgo::start_pos(Worker& worker)
+{
+    auto orders = worker.get_orders();
+    return orders.empty() ? worker.get_pos() : orders.back().get_pos();
+}
+
+/**
+ * Returns the cost of assigning an order to a worker.
+ *
+ * @param field The distance field of the order's bin.
+ * @param start The position the worker starts from.
+ * @param load The number of orders the worker already has.
+ * @param unreachable_cost The cost used if the worker cannot reach the order.
+ */
+long long MatchingDispatchAlgo::cost(const DistanceField& field, int start,
+        int load, long long unreachable_cost)
+{
+    int dist = field.get_dist(start);
+    long long c = (dist == DistanceField::UNREACHABLE) ? unreachable_cost : dist;
+
+    return c + LOAD_PENALTY * load;
+}
+
+/**
+ * Assigns the order to the worker with the lowest cost.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param order The order to assign.
+ *
+ * @return The id of the worker that was assigned the order.
+ */
+int MatchingDispatchAlgo::assign_order(Warehouse *warehouse, Order order)
+{
+    std::vector<Worker>& workers = warehouse->get_workers();
+
+    const DistanceField& field = distances->get_field(warehouse, order.get_pos());
+    // No path is longer than the number of positions in the warehouse.
+    long long unreachable_cost = warehouse->get_width() * warehouse->get_height();
+
+    int best = 0;
+    long long best_cost = std::numeric_limits<long long>::max();
+    for (std::size_t j = 0; j < workers.size(); j++)
+    {
+        long long c = cost(field, start_pos(workers[j]), workers[j].get_load(),
+                unreachable_cost);
+        if (c < best_cost)
+        {
+            best = j;
+            best_cost = c;
+        }
+    }
+
+    workers[best].assign(order);
+    return workers[best].get_id();
+}
+
+/**
+ * Assigns the batch of orders so that the total cost is minimized. Batches
+ * larger than the number of workers are split into chunks, and each chunk is
+ * assigned after the previous one so that the loads are up to date.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param orders The orders to assign.
+ *
+ * @return The ids of the workers that were assigned each order, in the same
+ * order as the orders.
+ */
+std::vector<int> MatchingDispatchAlgo::assign_orders(Warehouse *warehouse,
+        std::vector<Order>& orders)
+{
+    std::vector<Worker>& workers = warehouse->get_workers();
+    std::vector<int> ids{};
+    ids.reserve(orders.size());
+
+    for (std::size_t start = 0; start < orders.size(); start += workers.size())
+    {
+        std::size_t end = std::min(orders.size(), start + workers.size());
+        std::vector<Order> chunk(orders.begin() + start, orders.begin() + end);
+
+        // A single order does not need an auction.
+        if (chunk.size() == 1)
+        {
+            ids.push_back(assign_order(warehouse, chunk[0]));
+            continue;
+        }
+
+        std::vector<int> chosen = solve(warehouse, chunk);
+        for (std::size_t i = 0; i < chunk.size(); i++)
+        {
+            workers[chosen[i]].assign(chunk[i]);
+            ids.push_back(workers[chosen[i]].get_id());
+        }
+    }
+
+    return ids;
+}
+
+/**
+ * Solves the assignment problem for a batch that is no larger than the number
+ * of workers.
+ *
+ * To keep the auction small, only the workers that are among the m cheapest
+ * for some order are considered, where m is the size of the batch. An optimal
+ * assignment never needs any other worker, since each order is competing with
+ * at most m-1 others. The problem is then made square by adding dummy orders
+ * that value every worker equally.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param orders The orders to assign.
+ *
+ * @return The index of the worker chosen for each order.
+ */
+std::vector<int> MatchingDispatchAlgo::solve(Warehouse *warehouse,
+        std::vector<Order>& orders)
+{
+    std::vector<Worker>& workers = warehouse->get_workers();
+    int m = orders.size();
+    int n = workers.size();
+
+    if ((int) prices.size() != n)
+        prices.assign(n, 0);
+
+    // Look up the state of the workers once, rather than once per order.
+    std::vector<int> starts(n);
+    std::vector<int> loads(n);
+    for (int j = 0; j < n; j++)
+    {
+        starts[j] = start_pos(workers[j]);
+        loads[j] = workers[j].get_load();
+    }
+
+    // Look up the distance fields before the rows are computed in parallel,
+    // so the threads do not serialize on the cache.
+    std::vector<const DistanceField *> fields(m);
+    for (int i = 0; i < m; i++)
+        fields[i] = &distances->get_field(warehouse, orders[i].get_pos());
+
+    // No path is longer than the number of positions in the warehouse.
+    long long unreachable_cost = warehouse->get_width() * warehouse->get_height();
+
+    // Build the cost matrix, one row per order.
+    std::vector<long long> costs(m * n);
+    auto fill_rows = [&](int row_begin, int row_end)
+    {
+        for (int i = row_begin; i < row_end; i++)
+            for (int j = 0; j < n; j++)
+                costs[i*n + j] = cost(*fields[i], starts[j], loads[j],
+                        unreachable_cost);
+    };
+    if (num_threads > 1 && m > 1 && (long long) m * n >= PARALLEL_THRESHOLD)
+    {
+        pool->parallel_for(0, m, 1, fill_rows);
+    }
+    else
+    {
+        fill_rows(0, m);
+    }
+
+    // Select the candidate workers.
+    std::vector<int> cols{};
+    if (m < n)
+    {
+        std::vector<bool> is_candidate(n, false);
+        std::vector<int> order(n);
+        for (int i = 0; i < m; i++)
+        {
+            for (int j = 0; j < n; j++)
+                order[j] = j;
+            std::nth_element(order.begin(), order.begin() + (m-1), order.end(),
+                    [&](int a, int b) { return costs[i*n + a] < costs[i*n + b]; });
+            for (int k = 0; k < m; k++)
+                is_candidate[order[k]] = true;
+        }
+        for (int j = 0; j < n; j++)
+            if (is_candidate[j])
+                cols.push_back(j);
+    }
+    else
+    {
+        for (int j = 0; j < n; j++)
+            cols.push_back(j);
+    }
+    int u = cols.size();
+
+    // Benefits are scaled so that the auction finishes with epsilon = 1 and
+    // is still optimal: any assignment within u*epsilon of the optimum is the
+    // optimum when all benefits are multiples of u+1.
+    long long scale = u + 1;
+    std::vector<long long> benefit(u * u, 0);
+    for (int i = 0; i < m; i++)
+        for (int k = 0; k < u; k++)
+            benefit[i*u + k] = -costs[i*n + cols[k]] * scale;
+
+    // Warm start from the prices of the last auction.
+    std::vector<long long> price(u);
+    for (int k = 0; k < u; k++)
+        price[k] = std::llround(prices[cols[k]] * scale);
+
+    std::vector<int> col_of_row = auction(benefit, u, price);
+
+    // Remember the prices for the next batch.
+    for (int k = 0; k < u; k++)
+        prices[cols[k]] = 1.0 * price[k] / scale;
+
+    // Prices only ever rise during an auction, so shift them down to keep
+    // the lowest at zero. Only the differences between prices matter to the
+    // bids, so this changes no assignment.
+    double min_price = *std::min_element(prices.begin(), prices.end());
+    for (auto& p : prices)
+        p -= min_price;
+
+    std::vector<int> chosen(m);
+    for (int i = 0; i < m; i++)
+        chosen[i] = cols[col_of_row[i]];
+
+    return chosen;
+}
+
+/**
+ * Computes the bids of the given bidders. Each bidder bids for the object with
+ * the highest value (benefit minus price), raising its price by the
+ * difference to the second best value plus epsilon.
+ *
+ * @param benefit The u*u benefit matrix.
+ * @param u The number of bidders and objects.
+ * @param price The object prices.
+ * @param bidders The bidders that need to bid.
+ * @param targets Filled with the object each bidder bids for.
+ * @param amounts Filled with the amount each bidder bids.
+ * @param eps The current epsilon.
+ */
+void MatchingDispatchAlgo::bid(const std::vector<long long>& benefit, int u,
+        const std::vector<long long>& price, const std::vector<int>& bidders,
+        std::vector<int>& targets, std::vector<long long>& amounts, long long eps)
+{
+    auto bid_range = [&](int begin, int end)
+    {
+        for (int b = begin; b < end; b++)
+        {
+            int row = bidders[b];
+            long long best = std::numeric_limits<long long>::min();
+            long long second = std::numeric_limits<long long>::min();
+            int best_col = 0;
+
+            for (int k = 0; k < u; k++)
+            {
+                long long value = benefit[row*u + k] - price[k];
+                if (value > best)
+                {
+                    second = best;
+                    best = value;
+                    best_col = k;
+                }
+                else if (value > second)
+                {
+                    second = value;
+                }
+            }
+
+            // With a single object there is no competition.
+            if (u == 1)
+                second = best;
+
+            targets[b] = best_col;
+            amounts[b] = price[best_col] + (best - second) + eps;
+        }
+    };
+
+    int count = bidders.size();
+    if (num_threads > 1 && count > 1 && (long long) count * u >= PARALLEL_THRESHOLD)
+    {
+        pool->parallel_for(0, count, 1, bid_range);
+    }
+    else
+    {
+        bid_range(0, count);
+    }
+}
+
+/**
+ * Runs an epsilon-scaling auction on a square benefit matrix and returns the
+ * object assigned to each bidder. Each scaling phase starts from the prices
+ * of the previous phase with every bidder unassigned, and epsilon is divided
+ * by four between phases until it reaches one. Because the final phase runs
+ * with epsilon = 1 on benefits scaled by u+1, the result is optimal for any
+ * starting prices, which is what allows the warm start.
+ *
+ * @param benefit The u*u benefit matrix.
+ * @param u The number of bidders and objects.
+ * @param price The object prices. Used as the starting prices and updated
+ * with the final prices.
+ *
+ * @return The object assigned to each bidder.
+ */
+std::vector<int> MatchingDispatchAlgo::auction(const std::vector<long long>& benefit,
+        int u, std::vector<long long>& price)
+{
+    long long max_benefit = 0;
+    for (auto& b : benefit)
+        max_benefit = std::max(max_benefit, std::abs(b));
+
+    long long eps = std::max(1LL, max_benefit / 4);
+
+    std::vector<int> col_of_row(u, -1);
+    std::vector<int> row_of_col(u, -1);
+
+    for (;;)
+    {
+        std::fill(col_of_row.begin(), col_of_row.end(), -1);
+        std::fill(row_of_col.begin(), row_of_col.end(), -1);
+
+        std::vector<int> unassigned(u);
+        for (int i = 0; i < u; i++)
+            unassigned[i] = i;
+
+        std::vector<int> targets{};
+        std::vector<long long> amounts{};
+        // The best bid and bidder for each object in the current round.
+        std::vector<long long> best_bid(u);
+        std::vector<int> best_bidder(u, -1);
+
+        while (!unassigned.empty())
+        {
+            // Without enough threads to go around, a Jacobi round wastes most
+            // of its bids on objects that another bidder also wants, so we
+            // let one bidder at a time bid instead (Gauss-Seidel).
+            if (num_threads < JACOBI_MIN_THREADS || 
+                    (long long) unassigned.size() * u < PARALLEL_THRESHOLD)
+            {
+                int row = unassigned.back();
+                unassigned.pop_back();
+
+                std::vector<int> bidder{row};
+                targets.assign(1, 0);
+                amounts.assign(1, 0);
+                bid(benefit, u, price, bidder, targets, amounts, eps);
+
+                int col = targets[0];
+                int prev = row_of_col[col];
+                if (prev >= 0)
+                {
+                    col_of_row[prev] = -1;
+                    unassigned.push_back(prev);
+                }
+                row_of_col[col] = row;
+                col_of_row[row] = col;
+                price[col] = amounts[0];
+                continue;
+            }
+
+            // Every unassigned bidder bids at once (Jacobi).
+            targets.assign(unassigned.size(), 0);
+            amounts.assign(unassigned.size(), 0);
+            bid(benefit, u, price, unassigned, targets, amounts, eps);
+
+            // Each object goes to its highest bidder.
+            std::vector<int> touched{};
+            for (std::size_t b = 0; b < unassigned.size(); b++)
+            {
+                int col = targets[b];
+                if (best_bidder[col] < 0)
+                {
+                    touched.push_back(col);
+                    best_bidder[col] = unassigned[b];
+                    best_bid[col] = amounts[b];
+                }
+                else if (amounts[b] > best_bid[col])
+                {
+                    best_bidder[col] = unassigned[b];
+                    best_bid[col] = amounts[b];
+                }
+            }
+
+            std::vector<int> next{};
+            for (std::size_t b = 0; b < unassigned.size(); b++)
+                if (best_bidder[targets[b]] != unassigned[b])
+                    next.push_back(unassigned[b]);
+
+            for (auto& col : touched)
+            {
+                int row = best_bidder[col];
+                int prev = row_of_col[col];
+                if (prev >= 0)
+                {
+                    col_of_row[prev] = -1;
+                    next.push_back(prev);
+                }
+                row_of_col[col] = row;
+                col_of_row[row] = col;
+                price[col] = best_bid[col];
+                best_bidder[col] = -1;
+            }
+
+            unassigned.swap(next);
+        }
+
+        if (eps == 1)
+            break;
+        eps = std::max(1LL, eps / 4);
+    }
+
+    return col_of_row;
+}
+
+/**
+ * Set the distance cache to use instead of this algorithm's own, so that the
+ * distances are shared with other simulations of the same warehouse.
+ *
+ * @param cache The distance cache to use.
+ */
+void MatchingDispatchAlgo::set_distance_cache(DistanceCache *cache)
+{
+    this->distances = cache;
+}
+
+/**
+ * Writes the worker prices kept from the last auction to a checkpoint, since
+ * they warm start the next one.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void MatchingDispatchAlgo::save(CheckpointWriter& writer)
+{
+    writer.write_doubles(prices);
+}
+
+/**
+ * Restores the worker prices from a checkpoint.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void MatchingDispatchAlgo::load(CheckpointReader& reader)
+{
+    prices = reader.read_doubles();
+}
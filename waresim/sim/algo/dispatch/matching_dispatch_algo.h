@@ -0,0 +1,74 @@
+#ifndef SIM_ALGO_DISPATCH_MATCHING_DISPATCH_ALGO_H
+#define SIM_ALGO_DISPATCH_MATCHING_DISPATCH_ALGO_H
+
+#include <vector>
+
+#include "dispatch_algo.h"
+#include "../../concurrent/thread_pool.h"
+#include "../path/distance_cache.h"
+
+/**
+ * Encapsulates an algorithm that assigns a batch of orders to workers so that
+ * the total cost is minimized, where the cost of giving an order to a worker
+ * is the travel distance to the order's bin plus a penalty for every order
+ * the worker already has. Each worker receives at most one order per batch.
+ *
+ * The assignment problem is solved with an epsilon-scaling auction algorithm.
+ * With a large enough thread pool the orders bid for the workers in parallel
+ * (Jacobi bidding), and the worker prices are kept between batches to warm
+ * start the next auction.
+ */
+class MatchingDispatchAlgo : public DispatchAlgo
+{
+    public:
+        MatchingDispatchAlgo();
+        MatchingDispatchAlgo(ThreadPool *);
+        ~MatchingDispatchAlgo();
+
+        // Assigns an order to one of the workers in the warehouse.
+        int assign_order(Warehouse *, Order) override;
+        // Assigns a batch of orders to the workers in the warehouse.
+        std::vector<int> assign_orders(Warehouse *, std::vector<Order>&) override;
+        // Set the distance cache to use.
+        void set_distance_cache(DistanceCache *);
+        // Writes the state of the algorithm to a checkpoint.
+        void save(CheckpointWriter&) override;
+        // Restores the state of the algorithm from a checkpoint.
+        void load(CheckpointReader&) override;
+    private:
+        // Returns the position a worker starts from to reach a new order.
+        int start_pos(Worker&);
+        // Returns the cost of assigning an order to a worker.
+        long long cost(const DistanceField&, int, int, long long);
+        // Solves the assignment for a batch no larger than the worker count.
+        std::vector<int> solve(Warehouse *, std::vector<Order>&);
+        // Runs the auction on a square benefit matrix.
+        std::vector<int> auction(const std::vector<long long>&, int,
+                std::vector<long long>&);
+        // Computes the bids of the unassigned bidders.
+        void bid(const std::vector<long long>&, int,
+                const std::vector<long long>&, const std::vector<int>&,
+                std::vector<int>&, std::vector<long long>&, long long);
+
+        // Cached distances between positions in the warehouse.
+        DistanceCache own_distances;
+        // The cache in use, which may be shared with other algorithms.
+        DistanceCache *distances = &own_distances;
+        // The prices of the workers from the last auction, in units of cost.
+        std::vector<double> prices{};
+        // The thread pool used to compute bids, if any.
+        ThreadPool *pool = nullptr;
+        // The number of threads used to compute bids.
+        int num_threads = 1;
+
+        // The cost added for every order a worker already has.
+        const long long LOAD_PENALTY = 10;
+        // The minimum number of benefit entries scanned in a round before the
+        // bidding is split between threads.
+        const long long PARALLEL_THRESHOLD = 1 << 16;
+        // The minimum number of threads for which bidding in parallel beats
+        // bidding one at a time.
+        const int JACOBI_MIN_THREADS = 8;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "nearest_dispatch_algo.h"
+
+#include <cstdlib>
+
+#include "../../util/util.h"
+
+/**
+ * Constructor.
+ */
+NearestDispatchAlgo::NearestDispatchAlgo()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+NearestDispatchAlgo::~NearestDispatchAlgo()
+{
+
+}
+
+/**
+ * Assigns the order to one of the workers in the warehouse. This
+ * implementation looks up the workers closest to the order's bin and assigns
+ * the order to the one with the fewest outstanding orders. Ties are broken by
+ * the distance to the bin. If the index finds no workers, every worker is
+ * considered instead.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param order The order to assign.
+ *
+ * @return The id of the worker that was assigned the order.
+ */
+int NearestDispatchAlgo::assign_order(Warehouse *warehouse, Order order)
+{
+    std::vector<Worker>& workers = warehouse->get_workers();
+    int width = warehouse->get_width();
+
+    // The position of the order.
+    int order_x, order_y;
+    pos_to_coord(&order_x, &order_y, order.get_pos(), width);
+
+    auto candidates = 
+        warehouse->get_worker_index().get_nearby(order.get_pos(), NUM_CANDIDATES);
+
+    // The index can come back empty while the scheduler is moving a worker
+    // in it, so fall back to considering every worker.
+    if (candidates.empty())
+    {
+        for (std::size_t i = 0; i < workers.size(); i++)
+            candidates.push_back(i);
+    }
+    if (candidates.empty())
+        throw("There are no workers to assign orders to.");
+
+    // Select the least loaded candidate, then the closest one.
+    int best = -1;
+    int best_load = 0;
+    int best_dist = 0;
+    for (auto& index : candidates)
+    {
+        int x, y;
+        pos_to_coord(&x, &y, workers[index].get_pos(), width);
+
+        int load = workers[index].get_load();
+        int dist = std::abs(x - order_x) + std::abs(y - order_y);
+
+        if (best < 0 || load < best_load || 
+                (load == best_load && dist < best_dist))
+        {
+            best = index;
+            best_load = load;
+            best_dist = dist;
+        }
+    }
+
+    // Assign job to the worker.
+    Worker& worker = workers[best];
+    worker.assign(order);
+
+    return worker.get_id();
+}
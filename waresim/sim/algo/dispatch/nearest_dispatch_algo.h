@@ -0,0 +1,24 @@
+#ifndef SIM_ALGO_DISPATCH_NEAREST_DISPATCH_ALGO_H
+#define SIM_ALGO_DISPATCH_NEAREST_DISPATCH_ALGO_H
+
+#include "dispatch_algo.h"
+
+/**
+ * Encapsulates an algorithm that assigns each order to the least loaded of the
+ * workers closest to the order. Nearby workers are found using the warehouse's
+ * spatial index of the workers.
+ */
+class NearestDispatchAlgo : public DispatchAlgo
+{
+    public:
+        NearestDispatchAlgo();
+        ~NearestDispatchAlgo();
+
+        // Assigns an order to one of the workers in the warehouse.
+        int assign_order(Warehouse *, Order) override;
+    private:
+        // The number of nearby workers to consider for each order.
+        const std::size_t NUM_CANDIDATES = 8;
+};
+
+#endif
@@ -51,3 +51,23 @@ int RandDispatchAlgo::assign_order(Warehouse *warehouse, Order order)
 
     return worker.get_id();
 }
+
+/**
+ * Writes the state of the random number generator to a checkpoint.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void RandDispatchAlgo::save(CheckpointWriter& writer)
+{
+    rand.save(writer);
+}
+
+/**
+ * Restores the state of the random number generator from a checkpoint.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void RandDispatchAlgo::load(CheckpointReader& reader)
+{
+    rand.load(reader);
+}
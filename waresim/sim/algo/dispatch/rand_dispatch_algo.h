@@ -17,6 +17,10 @@ class RandDispatchAlgo : public DispatchAlgo
 
         // Assignes an order to one of the workers in the warehouse.
         int assign_order(Warehouse *, Order) override;
+        // Writes the state of the algorithm to a checkpoint.
+        void save(CheckpointWriter&) override;
+        // Restores the state of the algorithm from a checkpoint.
+        void load(CheckpointReader&) override;
     private:
         Rand rand;
 };
@@ -18,3 +18,41 @@ OrderAlgo::~OrderAlgo()
 {
 
 }
+
+/**
+ * Returns the number of ticks until the next order is ready, counting the
+ * current tick as one. The default asks order_ready() once per tick, which is
+ * the same as stepping through the ticks. Implementations that know their
+ * arrival distribution should override this.
+ */
+long OrderAlgo::next_arrival()
+{
+    long ticks = 1;
+    while (!order_ready())
+        ticks++;
+
+    return ticks;
+}
+
+/**
+ * Writes the state of the algorithm to a checkpoint, so that a restored
+ * simulation continues the same way. Does nothing by default, which is right
+ * for algorithms without any state. Algorithms with state, such as a random
+ * number generator, should override this and load().
+ *
+ * @param writer The checkpoint to write to.
+ */
+void OrderAlgo::save(CheckpointWriter&)
+{
+
+}
+
+/**
+ * Restores the state written by save(). Does nothing by default.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void OrderAlgo::load(CheckpointReader&)
+{
+
+}
@@ -9,7 +9,8 @@
  * The idea is that there are two steps to generating an order: deciding
  * whether or not an order should be generated, and then generating the actual
  * order. In client code, it is expected that order_ready() will be called
- * before get_new_order().
+ * before get_new_order(). Event driven clients call next_arrival() instead of
+ * order_ready() to skip the ticks without an order.
  */
 class OrderAlgo
 {
@@ -21,6 +22,12 @@ class OrderAlgo
         virtual bool order_ready() = 0;
         // Returns the new order to be fulfilled.
         virtual Order get_new_order(Warehouse *) = 0;
+        // Returns the number of ticks until the next order is ready.
+        virtual long next_arrival();
+        // Writes the state of the algorithm to a checkpoint.
+        virtual void save(CheckpointWriter&);
+        // Restores the state of the algorithm from a checkpoint.
+        virtual void load(CheckpointReader&);
 
     private:
 };
@@ -3,6 +3,9 @@
  */
 #include "rand_order_algo.h"
 
+#include <cmath>
+#include <limits>
+
 /**
  * Constructor.
  *
@@ -13,6 +16,18 @@ RandOrderAlgo::RandOrderAlgo(Rand rand)
     this->rand = rand;
 }
 
+/**
+ * Constructor.
+ *
+ * @param rand The random number generator to use.
+ * @param rate The chance of generating an order each iteration.
+ */
+RandOrderAlgo::RandOrderAlgo(Rand rand, double rate)
+{
+    this->rand = rand;
+    this->rate = rate;
+}
+
 /**
  * Destructor.
  */
@@ -28,7 +43,7 @@ bool RandOrderAlgo::order_ready()
 {
         double d = rand.rand();
         
-        if (d < 0.50)
+        if (d < rate)
             return true;
         else
             return false;
@@ -50,3 +65,46 @@ Order RandOrderAlgo::get_new_order(Warehouse *w)
     return Order(bins[index]);
 }
 
+
+/**
+ * Returns the number of ticks until the next order is ready. The gaps between
+ * orders are geometrically distributed, so a single draw replaces calling
+ * order_ready() once per tick.
+ */
+long RandOrderAlgo::next_arrival()
+{
+    long never = std::numeric_limits<long>::max();
+
+    if (rate >= 1.0)
+        return 1;
+    if (rate <= 0.0)
+        return never;
+
+    // A draw in (0,1] so that the logarithm is defined.
+    double u = 1.0 - rand.rand();
+    double ticks = 1 + std::floor(std::log(u) / std::log(1.0 - rate));
+
+    if (ticks >= never)
+        return never;
+    return (long) ticks;
+}
+
+/**
+ * Writes the state of the random number generator to a checkpoint.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void RandOrderAlgo::save(CheckpointWriter& writer)
+{
+    rand.save(writer);
+}
+
+/**
+ * Restores the state of the random number generator from a checkpoint.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void RandOrderAlgo::load(CheckpointReader& reader)
+{
+    rand.load(reader);
+}
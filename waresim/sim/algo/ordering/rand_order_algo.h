@@ -6,24 +6,33 @@
 #include "../../rand/rand.h"
 
 /**
- * An implementation of OrderAlgo that has a 50% chance of generating a new
- * order each iteration and that selects a random bin if the order is
- * generated.
+ * An implementation of OrderAlgo that has a fixed chance (50% by default) of
+ * generating a new order each iteration and that selects a random bin if the
+ * order is generated.
  */
 class RandOrderAlgo : public OrderAlgo
 {
     public:
         RandOrderAlgo(Rand);
+        RandOrderAlgo(Rand, double);
         ~RandOrderAlgo();
 
         // Returns true if there is an order ready to be fulfilled.
         bool order_ready() override;
         // Returns the new order to be fulfilled.
         Order get_new_order(Warehouse *) override;
+        // Returns the number of ticks until the next order is ready.
+        long next_arrival() override;
+        // Writes the state of the algorithm to a checkpoint.
+        void save(CheckpointWriter&) override;
+        // Restores the state of the algorithm from a checkpoint.
+        void load(CheckpointReader&) override;
 
     private:
         // The random number generator to use.
         Rand rand;
+        // The chance of generating an order each iteration.
+        double rate = 0.5;
 };
 
 #endif
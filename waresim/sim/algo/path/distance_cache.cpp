@@ -0,0 +1,88 @@
+#include <utility>
+#include <vector>
+
+#include "distance_cache.h"
+
+/**
+ * Constructor.
+ */
+DistanceCache::DistanceCache()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+DistanceCache::~DistanceCache()
+{
+
+}
+
+/**
+ * Returns the distance field for the target, computing it if this is the
+ * first time the target was requested. The returned reference stays valid for
+ * the lifetime of the cache.
+ *
+ * @param warehouse The warehouse to use.
+ * @param target The target position.
+ *
+ * @return The distance field for the target.
+ */
+const DistanceField& DistanceCache::get_field(Warehouse *warehouse, int target)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        auto it = fields.find(target);
+        if (it != fields.end())
+            return it->second;
+    }
+
+    // Build the field without holding the lock, so that threads sharing the
+    // cache are not held up. If two threads build the same field, the first
+    // one stored is kept.
+    DistanceField field(warehouse, target);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    return fields.emplace(target, std::move(field)).first->second;
+}
+
+/**
+ * Computes the distance fields for several targets ahead of time, in
+ * parallel if a thread pool is given. Targets already in the cache are
+ * skipped.
+ *
+ * @param warehouse The warehouse to use.
+ * @param targets The target positions.
+ * @param pool The thread pool to use, or nullptr.
+ */
+void DistanceCache::precompute(Warehouse *warehouse,
+        const std::vector<int>& targets, ThreadPool *pool)
+{
+    auto build = [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+            get_field(warehouse, targets[i]);
+    };
+
+    if (pool == nullptr)
+        build(0, targets.size());
+    else
+        pool->parallel_for(0, targets.size(), 1, build);
+}
+
+/**
+ * Returns the distance between two positions.
+ *
+ * @param warehouse The warehouse to use.
+ * @param start The starting position.
+ * @param end The ending position.
+ *
+ * @return The number of moves needed to travel from start to end, or
+ * DistanceField::UNREACHABLE.
+ */
+int DistanceCache::get_dist(Warehouse *warehouse, int start, int end)
+{
+    return get_field(warehouse, end).get_dist(start);
+}
@@ -0,0 +1,37 @@
+#ifndef WARESIM_SIM_ALGO_PATH_DISTANCE_CACHE_H
+#define WARESIM_SIM_ALGO_PATH_DISTANCE_CACHE_H
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "distance_field.h"
+#include "../../concurrent/thread_pool.h"
+
+/**
+ * Lazily computes and caches a distance field for each target position, so
+ * that the distance between any two positions can be looked up in constant
+ * time after the first query to the same target. The fields only depend on the
+ * layout, so one cache can be shared between threads and between simulations
+ * of the same warehouse.
+ */
+class DistanceCache
+{
+    public:
+        DistanceCache();
+        ~DistanceCache();
+
+        // Returns the distance field for a target.
+        const DistanceField& get_field(Warehouse *, int);
+        // Returns the distance between two positions.
+        int get_dist(Warehouse *, int, int);
+        // Computes the distance fields for several targets ahead of time.
+        void precompute(Warehouse *, const std::vector<int>&, ThreadPool *);
+    private:
+        // The distance fields, keyed by target.
+        std::unordered_map<int, DistanceField> fields{};
+        // Guards the fields.
+        std::mutex mutex;
+};
+
+#endif
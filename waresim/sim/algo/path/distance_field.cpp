@@ -0,0 +1,150 @@
+#include "distance_field.h"
+
+#include <queue>
+
+#include "../../constants.h"
+
+const int DistanceField::UNREACHABLE;
+
+/**
+ * Default constructor. Creates an empty distance field.
+ */
+DistanceField::DistanceField()
+{
+
+}
+
+/**
+ * Constructor. Computes the distance from every position in the warehouse to
+ * the target.
+ *
+ * @param warehouse The warehouse to use.
+ * @param target The target position.
+ */
+DistanceField::DistanceField(Warehouse *warehouse, int target)
+    : DistanceField(warehouse, std::vector<int>{target})
+{
+
+}
+
+/**
+ * Constructor. Computes the distance from every position in the warehouse to
+ * the closest of the targets using a breadth-first search that starts at all
+ * targets at once. Since every move has the same cost this gives the same
+ * distances as Dijkstra's algorithm in linear time, no matter how many
+ * targets there are.
+ *
+ * @param warehouse The warehouse to use.
+ * @param targets The target positions.
+ */
+DistanceField::DistanceField(Warehouse *warehouse, std::vector<int> targets)
+{
+    const std::vector<int>& layout = warehouse->get_layout();
+    int width = warehouse->get_width();
+    int height = warehouse->get_height();
+
+    dists = std::vector<int>(layout.size(), UNREACHABLE);
+
+    // The closest target only needs to be tracked when there is more than
+    // one. This keeps single target fields, which are cached in bulk, small.
+    if (targets.size() == 1)
+        this->target = targets[0];
+    else
+        sources = std::vector<int>(layout.size(), UNREACHABLE);
+
+    std::queue<int> frontier{};
+    for (auto& t : targets)
+    {
+        dists[t] = 0;
+        if (!sources.empty())
+            sources[t] = t;
+        frontier.push(t);
+    }
+
+    while (!frontier.empty())
+    {
+        int curr = frontier.front();
+        frontier.pop();
+
+        // Determine this node's neighbors.
+        std::vector<int> neighbors{};
+        // Top neighbor.
+        if ((curr / width) != (height-1))
+            neighbors.push_back(curr + width);
+        // Bottom neighbor.
+        if (curr >= width)
+            neighbors.push_back(curr - width);
+        // Left neighbor.
+        if ((curr % width) != 0)
+            neighbors.push_back(curr - 1);
+        // Right neighbor.
+        if (((curr+1) % width) != 0)
+            neighbors.push_back(curr + 1);
+
+        for (auto& neigh : neighbors)
+        {
+            // We are searching backwards, so the move is from the neighbor
+            // to the current node. Workers cannot start inside walls and we
+            // do not allow bin-to-bin or drop-to-drop travel.
+            if (dists[neigh] != UNREACHABLE || layout[neigh] == WALL_LOC)
+                continue;
+            if (layout[neigh] == BIN_LOC && layout[curr] == BIN_LOC)
+                continue;
+            if (layout[neigh] == DROP_LOC && layout[curr] == DROP_LOC)
+                continue;
+
+            dists[neigh] = dists[curr] + 1;
+            if (!sources.empty())
+                sources[neigh] = sources[curr];
+
+            // Only empty locations can be passed through. Other locations
+            // can only be the start of a path.
+            if (layout[neigh] == EMPTY_LOC)
+                frontier.push(neigh);
+        }
+    }
+}
+
+/**
+ * Destructor.
+ */
+DistanceField::~DistanceField()
+{
+
+}
+
+/**
+ * Returns the distance from the position to the target.
+ *
+ * @param pos The position to start from.
+ *
+ * @return The number of moves needed to reach the target, or UNREACHABLE.
+ */
+int DistanceField::get_dist(int pos) const
+{
+    return dists[pos];
+}
+
+/**
+ * Returns the target of this distance field.
+ *
+ * @return The target position, or -1 if the field has several targets.
+ */
+int DistanceField::get_target() const
+{
+    return target;
+}
+
+/**
+ * Returns the closest target to the position.
+ *
+ * @param pos The position to start from.
+ *
+ * @return The closest target, or UNREACHABLE if no target can be reached.
+ */
+int DistanceField::get_source(int pos) const
+{
+    if (sources.empty())
+        return dists[pos] == UNREACHABLE ? UNREACHABLE : target;
+    return sources[pos];
+}
@@ -0,0 +1,44 @@
+#ifndef WARESIM_SIM_ALGO_PATH_DISTANCE_FIELD_H
+#define WARESIM_SIM_ALGO_PATH_DISTANCE_FIELD_H
+
+#include <vector>
+
+#include "../../warehouse.h"
+
+/**
+ * The travel distance from every position in the warehouse to a target
+ * position, computed with a single breadth-first search outwards from the
+ * target. Movement follows the same rules as the pathfinding algorithms:
+ * workers travel through empty locations and may only enter a non-empty
+ * location if it is the target.
+ *
+ * A field can also be built for several targets at once, in which case it
+ * holds the distance to the closest target along with which target that is.
+ */
+class DistanceField
+{
+    public:
+        DistanceField();
+        DistanceField(Warehouse *, int);
+        DistanceField(Warehouse *, std::vector<int>);
+        ~DistanceField();
+
+        // Returns the distance from a position to the target, or UNREACHABLE.
+        int get_dist(int) const;
+        // Returns the target of this distance field.
+        int get_target() const;
+        // Returns the closest target to a position, or UNREACHABLE.
+        int get_source(int) const;
+
+        // Marks positions that cannot reach the target.
+        static const int UNREACHABLE = -1;
+    private:
+        // The target position.
+        int target = -1;
+        // The distance from each position to the target.
+        std::vector<int> dists{};
+        // The closest target to each position, if there are several targets.
+        std::vector<int> sources{};
+};
+
+#endif
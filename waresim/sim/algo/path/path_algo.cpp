@@ -15,3 +15,50 @@ PathAlgo::~PathAlgo()
 {
 
 }
+
+/**
+ * Finds the paths between several pairs of start and end points. The default
+ * implementation calls find() for each pair in turn, since find() is not
+ * assumed to be safe to call from several threads. Algorithms that can find
+ * paths in parallel should override this method.
+ *
+ * @param warehouse The warehouse to use.
+ * @param queries The start and end point of each path.
+ * @param pool The thread pool that may be used, or nullptr.
+ *
+ * @return The path for each query, in the same order as the queries.
+ */
+std::vector<std::vector<int>> PathAlgo::find_all(Warehouse *warehouse,
+        const std::vector<std::pair<int,int>>& queries, ThreadPool *)
+{
+    std::vector<std::vector<int>> paths{};
+    paths.reserve(queries.size());
+
+    for (auto& query : queries)
+        paths.push_back(find(warehouse, query.first, query.second));
+
+    return paths;
+}
+
+/**
+ * Writes the state of the algorithm to a checkpoint, so that a restored
+ * simulation continues the same way. Does nothing by default, which is right
+ * for algorithms without any state. Algorithms with state, such as a random
+ * number generator, should override this and load().
+ *
+ * @param writer The checkpoint to write to.
+ */
+void PathAlgo::save(CheckpointWriter&)
+{
+
+}
+
+/**
+ * Restores the state written by save(). Does nothing by default.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void PathAlgo::load(CheckpointReader&)
+{
+
+}
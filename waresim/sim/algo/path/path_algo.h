@@ -1,8 +1,10 @@
 #ifndef WARESIM_WARESIM_ALGO_PATH_PATH_ALGO
 #define WARESIM_WARESIM_ALGO_PATH_PATH_ALGO
 
+#include <utility>
 #include <vector>
 
+#include "../../concurrent/thread_pool.h"
 #include "../../constants.h"
 #include "../../warehouse.h"
 
@@ -17,6 +19,13 @@ class PathAlgo
 
         // Finds a path from the start to end point in the given warehouse.
         virtual std::vector<int> find(Warehouse*, int, int) = 0;
+        // Finds the paths between several pairs of start and end points.
+        virtual std::vector<std::vector<int>> find_all(Warehouse*,
+                const std::vector<std::pair<int,int>>&, ThreadPool*);
+        // Writes the state of the algorithm to a checkpoint.
+        virtual void save(CheckpointWriter&);
+        // Restores the state of the algorithm from a checkpoint.
+        virtual void load(CheckpointReader&);
 
     private:
 
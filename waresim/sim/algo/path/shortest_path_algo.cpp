@@ -20,6 +20,57 @@ ShortestPathAlgo::~ShortestPathAlgo()
 
 }
 
+/**
+ * Computes the shortest path between the start and end positions. See
+ * shortest().
+ *
+ * @param warehouse The warehouse to use.
+ * @param start The starting position.
+ * @param end The ending position.
+ */
+std::vector<int> ShortestPathAlgo::find(Warehouse* warehouse, int start, int end)
+{
+    return shortest(warehouse, start, end, rand);
+}
+
+/**
+ * Computes the shortest paths for several pairs of positions on the threads
+ * of the pool. Each query is given its own random number generator, seeded
+ * from this algorithm's generator in the order of the queries, so the paths
+ * do not depend on the number of threads or on which thread runs which
+ * query.
+ *
+ * @param warehouse The warehouse to use.
+ * @param queries The start and end position of each path.
+ * @param pool The thread pool to use, or nullptr to use the calling thread.
+ *
+ * @return The path for each query, in the same order as the queries.
+ */
+std::vector<std::vector<int>> ShortestPathAlgo::find_all(Warehouse *warehouse,
+        const std::vector<std::pair<int,int>>& queries, ThreadPool *pool)
+{
+    std::vector<std::vector<int>> paths(queries.size());
+
+    std::vector<Rand> rands{};
+    rands.reserve(queries.size());
+    for (std::size_t i = 0; i < queries.size(); i++)
+        rands.push_back(Rand(rand.rand() * std::numeric_limits<unsigned int>::max()));
+
+    auto find_range = [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+            paths[i] = shortest(warehouse, queries[i].first,
+                    queries[i].second, rands[i]);
+    };
+
+    if (pool != nullptr)
+        pool->parallel_for(0, queries.size(), 1, find_range);
+    else
+        find_range(0, queries.size());
+
+    return paths;
+}
+
 /**
  * Computes the shortest path between the start and end positions using
  * Dijsktra's algorithm. Assumes all points are reachable within the warehouse.
@@ -31,8 +82,10 @@ ShortestPathAlgo::~ShortestPathAlgo()
  * @param warehouse The warehouse to use.
  * @param start The starting position.
  * @param end The ending position.
+ * @param rand The random number generator used to break ties.
  */
-std::vector<int> ShortestPathAlgo::find(Warehouse* warehouse, int start, int end)
+std::vector<int> ShortestPathAlgo::shortest(Warehouse* warehouse, int start,
+        int end, Rand& rand)
 {
     // The path we are going to return.
     std::vector<int> path{};
@@ -44,7 +97,7 @@ std::vector<int> ShortestPathAlgo::find(Warehouse* warehouse, int start, int end
     int UNDEFINED = -1;
 
     // Create a copy of the layout to work with.
-    auto layout = warehouse->get_layout();
+    const std::vector<int>& layout = warehouse->get_layout();
 
     // The vertices we have checked.
     std::vector<bool> checked(layout.size(), false);
@@ -102,7 +155,7 @@ std::vector<int> ShortestPathAlgo::find(Warehouse* warehouse, int start, int end
         // Determine this node's valid neighbors.
 
         // Top neighbor.
-        if ((min_index / height) != (height-1))
+        if ((min_index / width) != (height-1))
             neighbors.push_back(min_index + width);
         // Bottom neighbor.
         if (min_index >= width)
@@ -168,3 +221,23 @@ std::vector<int> ShortestPathAlgo::find(Warehouse* warehouse, int start, int end
     return path;
 }
 
+
+/**
+ * Writes the state of the random number generator to a checkpoint.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void ShortestPathAlgo::save(CheckpointWriter& writer)
+{
+    rand.save(writer);
+}
+
+/**
+ * Restores the state of the random number generator from a checkpoint.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void ShortestPathAlgo::load(CheckpointReader& reader)
+{
+    rand.load(reader);
+}
@@ -14,8 +14,19 @@ class ShortestPathAlgo : public PathAlgo
         // Finds the shortest path between the start and end point using the
         // shortest path algorithm.
         std::vector<int> find(Warehouse*, int, int) override;
+        // Finds the shortest paths between several pairs of points in
+        // parallel.
+        std::vector<std::vector<int>> find_all(Warehouse*,
+                const std::vector<std::pair<int,int>>&, ThreadPool*) override;
+        // Writes the state of the algorithm to a checkpoint.
+        void save(CheckpointWriter&) override;
+        // Restores the state of the algorithm from a checkpoint.
+        void load(CheckpointReader&) override;
 
     private:
+        // Finds a shortest path using the given random number generator.
+        std::vector<int> shortest(Warehouse*, int, int, Rand&);
+
         Rand rand;
 };
 
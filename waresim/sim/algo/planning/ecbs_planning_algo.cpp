@@ -0,0 +1,697 @@
+// Implementation for ecbs_planning_algo.h
+#include "ecbs_planning_algo.h"
+
+#include <algorithm>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <utility>
+
+#include "../../constants.h"
+
+/**
+ * Constructor. Uses a time budget of 5 milliseconds per iteration.
+ */
+ECBSPlanningAlgo::ECBSPlanningAlgo() : ECBSPlanningAlgo(5)
+{
+
+}
+
+/**
+ * Constructor.
+ *
+ * @param budget The time budget for planning in each iteration, in
+ * milliseconds.
+ */
+ECBSPlanningAlgo::ECBSPlanningAlgo(int budget)
+    : budget(std::chrono::milliseconds(budget))
+{
+
+}
+
+/**
+ * Destructor.
+ */
+ECBSPlanningAlgo::~ECBSPlanningAlgo()
+{
+
+}
+
+/**
+ * Returns true if the time budget for this iteration has been used up.
+ */
+bool ECBSPlanningAlgo::out_of_time()
+{
+    return std::chrono::steady_clock::now() >= deadline;
+}
+
+/**
+ * Returns true if the position lies inside the window.
+ *
+ * @param window The window.
+ * @param pos The position in the warehouse.
+ */
+bool ECBSPlanningAlgo::in_window(Window& window, int pos)
+{
+    int x = pos % window.stride;
+    int y = pos / window.stride;
+    return x >= window.x && x < window.x + window.width &&
+        y >= window.y && y < window.y + window.height;
+}
+
+/**
+ * Converts a position in the warehouse to a position local to the window.
+ *
+ * @param window The window.
+ * @param pos The position in the warehouse. Must be inside the window.
+ */
+int ECBSPlanningAlgo::to_local(Window& window, int pos)
+{
+    int x = pos % window.stride - window.x;
+    int y = pos / window.stride - window.y;
+    return y * window.width + x;
+}
+
+/**
+ * Converts a position local to the window to a position in the warehouse.
+ *
+ * @param window The window.
+ * @param local The local position.
+ */
+int ECBSPlanningAlgo::to_global(Window& window, int local)
+{
+    int x = local % window.width + window.x;
+    int y = local / window.width + window.y;
+    return y * window.stride + x;
+}
+
+/**
+ * Returns the neighbors of a local position that lie inside the window.
+ *
+ * @param window The window.
+ * @param local The local position.
+ */
+std::vector<int> ECBSPlanningAlgo::neighbors(Window& window, int local)
+{
+    std::vector<int> result{};
+    // Top neighbor.
+    if ((local / window.width) != (window.height-1))
+        result.push_back(local + window.width);
+    // Bottom neighbor.
+    if (local >= window.width)
+        result.push_back(local - window.width);
+    // Left neighbor.
+    if ((local % window.width) != 0)
+        result.push_back(local - 1);
+    // Right neighbor.
+    if (((local+1) % window.width) != 0)
+        result.push_back(local + 1);
+    return result;
+}
+
+/**
+ * Computes the distance from each position in the window to the agent's
+ * goal, without leaving the window and ignoring the other workers. This is
+ * the heuristic for the agent's low-level search.
+ *
+ * @param window The window.
+ * @param agent The agent.
+ */
+void ECBSPlanningAlgo::compute_dists(Window& window, Agent& agent)
+{
+    agent.dists = std::vector<int>(window.layout.size(), -1);
+    agent.dists[agent.goal] = 0;
+
+    std::queue<int> frontier{};
+    frontier.push(agent.goal);
+
+    while (!frontier.empty())
+    {
+        int curr = frontier.front();
+        frontier.pop();
+
+        for (auto& neigh : neighbors(window, curr))
+        {
+            // We are searching backwards, so the move is from the neighbor
+            // to the current node, using the same rules as DistanceField.
+            if (agent.dists[neigh] != -1 || window.layout[neigh] == WALL_LOC)
+                continue;
+            if (window.layout[neigh] == BIN_LOC && window.layout[curr] == BIN_LOC)
+                continue;
+            if (window.layout[neigh] == DROP_LOC && window.layout[curr] == DROP_LOC)
+                continue;
+
+            agent.dists[neigh] = agent.dists[curr] + 1;
+            if (window.layout[neigh] == EMPTY_LOC)
+                frontier.push(neigh);
+        }
+    }
+}
+
+/**
+ * Builds a window around the position. The moving workers inside the window
+ * that can reach the end of their path within the window become agents, and
+ * all other workers inside the window reserve the positions along their
+ * current path.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param center The center of the window.
+ * @param window The window to build.
+ *
+ * @return True if the window has enough agents to be worth planning.
+ */
+bool ECBSPlanningAlgo::build_window(Warehouse *warehouse, int center,
+        Window& window)
+{
+    int width = warehouse->get_width();
+    int height = warehouse->get_height();
+    const std::vector<int>& layout = warehouse->get_layout();
+    auto& workers = warehouse->get_workers();
+
+    int cx = center % width;
+    int cy = center / width;
+    window.stride = width;
+    window.x = std::max(0, cx - WINDOW_RADIUS);
+    window.y = std::max(0, cy - WINDOW_RADIUS);
+    window.width = std::min(width - 1, cx + WINDOW_RADIUS) - window.x + 1;
+    window.height = std::min(height - 1, cy + WINDOW_RADIUS) - window.y + 1;
+    window.horizon = 2 * (window.width + window.height);
+
+    int cells = window.width * window.height;
+    window.layout = std::vector<int>(cells);
+    for (int local = 0; local < cells; local++)
+        window.layout[local] = layout[to_global(window, local)];
+
+    // The positions each worker in the window is expected to hold, from now
+    // on. Workers that leave the window are no longer tracked.
+    std::vector<int> candidates{};
+    std::vector<int> obstacles{};
+    for (std::size_t i = 0; i < workers.size(); i++)
+    {
+        int pos = workers[i].get_pos();
+        if (!in_window(window, pos))
+            continue;
+
+        auto path = workers[i].get_path();
+        if (tick >= planned_until[i] && !path.empty() && path[0] != pos &&
+                in_window(window, path[0]))
+            candidates.push_back(i);
+        else
+            obstacles.push_back(i);
+    }
+
+    // Turn the candidates into agents. Agents whose goal is held by an
+    // obstacle forever cannot be planned, so they become obstacles instead,
+    // which may in turn block other agents.
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        window.reserved = std::vector<char>((window.horizon + 1) * cells, 0);
+        for (auto& i : obstacles)
+        {
+            std::vector<int> predicted{workers[i].get_pos()};
+            for (auto& pos : workers[i].get_path())
+                predicted.push_back(pos);
+
+            for (int t = 0; t <= window.horizon; t++)
+            {
+                // Workers are expected to stay at the end of their path.
+                int pos = pos_at(predicted, t);
+                if (!in_window(window, pos))
+                    break;
+                window.reserved[t * cells + to_local(window, pos)] = 1;
+            }
+        }
+
+        window.agents.clear();
+        for (auto it = candidates.begin(); it != candidates.end(); ++it)
+        {
+            auto path = workers[*it].get_path();
+
+            // The goal is the last position before the path leaves the window.
+            std::size_t k = 0;
+            while (k + 1 < path.size() && in_window(window, path[k+1]))
+                k++;
+
+            Agent agent;
+            agent.worker = *it;
+            agent.start = to_local(window, workers[*it].get_pos());
+            agent.goal = to_local(window, path[k]);
+            agent.suffix = std::vector<int>(path.begin() + k + 1, path.end());
+            compute_dists(window, agent);
+
+            if (agent.dists[agent.start] == -1 ||
+                    window.reserved[window.horizon * cells + agent.goal])
+            {
+                obstacles.push_back(*it);
+                candidates.erase(it);
+                changed = true;
+                break;
+            }
+
+            window.agents.push_back(agent);
+        }
+    }
+
+    return window.agents.size() >= MIN_AGENTS;
+}
+
+/**
+ * Returns the position on a path at a time. Agents stay at the end of their
+ * path once they reach it.
+ *
+ * @param path The path.
+ * @param t The time.
+ */
+int ECBSPlanningAlgo::pos_at(std::vector<int>& path, int t)
+{
+    if (t < static_cast<int>(path.size()))
+        return path[t];
+    return path.back();
+}
+
+/**
+ * Returns the position of an agent at a time. Agents that leave the window
+ * are gone after they reach their goal, while the others stay at their goal.
+ *
+ * @param window The window.
+ * @param paths The paths of the agents, as local positions.
+ * @param a The index of the agent.
+ * @param t The time.
+ *
+ * @return The local position of the agent, or -1 if it has left the window.
+ */
+int ECBSPlanningAlgo::agent_at(Window& window,
+        std::vector<std::vector<int>>& paths, int a, int t)
+{
+    if (paths[a].empty())
+        return -1;
+    if (t >= static_cast<int>(paths[a].size()) && !window.agents[a].suffix.empty())
+        return -1;
+    return pos_at(paths[a], t);
+}
+
+/**
+ * Counts the conflicts between the agents' paths. Two agents conflict if they
+ * are in the same position at the same time, or if one moves into a position
+ * that the other held in the previous step.
+ *
+ * @param window The window.
+ * @param paths The paths of the agents, as local positions.
+ * @param first Set to the first conflict found.
+ *
+ * @return The number of conflicts.
+ */
+int ECBSPlanningAlgo::find_conflicts(Window& window,
+        std::vector<std::vector<int>>& paths, Conflict& first)
+{
+    int cells = window.layout.size();
+    int length = 0;
+    for (auto& path : paths)
+        length = std::max(length, static_cast<int>(path.size()));
+
+    int count = 0;
+    std::vector<int> prev(cells, -1);
+    std::vector<int> curr(cells, -1);
+    for (int t = 0; t <= length; t++)
+    {
+        for (int a = 0; a < static_cast<int>(paths.size()); a++)
+        {
+            int cell = agent_at(window, paths, a, t);
+            if (cell == -1)
+                continue;
+
+            if (curr[cell] != -1)
+            {
+                if (count++ == 0)
+                    first = Conflict{a, t, curr[cell], t, cell};
+            }
+            else
+            {
+                curr[cell] = a;
+            }
+
+            if (t > 0 && cell != agent_at(window, paths, a, t-1) &&
+                    prev[cell] != -1 && prev[cell] != a)
+            {
+                if (count++ == 0)
+                    first = Conflict{a, t, prev[cell], t-1, cell};
+            }
+        }
+
+        // Move on to the next step.
+        std::fill(prev.begin(), prev.end(), -1);
+        std::swap(prev, curr);
+    }
+
+    return count;
+}
+
+/**
+ * Plans a path for a single agent using focal search in space and time. The
+ * search only expands nodes whose cost is within SUBOPTIMALITY of the lowest
+ * cost in the open list, and among those prefers the node that conflicts with
+ * the other agents' paths the least.
+ *
+ * @param window The window.
+ * @param a The index of the agent.
+ * @param node The constraint tree node, holding the constraints and the other
+ * agents' paths. The agent's path and lower bound are updated.
+ *
+ * @return True if a path was found.
+ */
+bool ECBSPlanningAlgo::plan_agent(Window& window, int a, Node& node)
+{
+    Agent& agent = window.agents[a];
+    int cells = window.layout.size();
+    int horizon = window.horizon;
+
+    // The positions this agent may not be in.
+    std::vector<char> forbidden((horizon + 1) * cells, 0);
+    for (auto& c : node.constraints)
+    {
+        if (c.agent == a && c.t <= horizon)
+            forbidden[c.t * cells + c.cell] = 1;
+    }
+
+    // An agent that stays at its goal can only stop there once nothing else
+    // needs it. Agents that leave the window can stop there at any time.
+    int last_blocked = -1;
+    for (int t = 0; agent.suffix.empty() && t <= horizon; t++)
+    {
+        int index = t * cells + agent.goal;
+        if (forbidden[index] || window.reserved[index])
+            last_blocked = t;
+    }
+    if (last_blocked == horizon)
+        return false;
+
+    // The number of other agents in each position at each time.
+    std::vector<int> occupied((horizon + 1) * cells, 0);
+    for (int b = 0; b < static_cast<int>(node.paths.size()); b++)
+    {
+        if (b == a)
+            continue;
+        for (int t = 0; t <= horizon; t++)
+        {
+            int cell = agent_at(window, node.paths, b, t);
+            if (cell != -1)
+                occupied[t * cells + cell]++;
+        }
+    }
+
+    // Search nodes, each holding a position, time, conflict count and parent.
+    std::vector<std::tuple<int,int,int,int>> nodes{};
+    std::vector<char> seen((horizon + 1) * cells, 0);
+    // Ordered by cost.
+    std::set<std::pair<int,int>> open{};
+    // Ordered by conflicts, then cost.
+    std::set<std::tuple<int,int,int>> focal{};
+
+    nodes.push_back(std::make_tuple(agent.start, 0, 0, -1));
+    seen[agent.start] = 1;
+    open.insert(std::make_pair(agent.dists[agent.start], 0));
+    focal.insert(std::make_tuple(0, agent.dists[agent.start], 0));
+    int limit = agent.dists[agent.start] * SUBOPTIMALITY;
+
+    int expanded = 0;
+    while (!open.empty())
+    {
+        if ((++expanded % 64) == 0 && out_of_time())
+            return false;
+
+        // Widen the focal list if the lowest cost has gone up.
+        int f_min = open.begin()->first;
+        int new_limit = f_min * SUBOPTIMALITY;
+        if (new_limit > limit)
+        {
+            for (auto it = open.lower_bound(std::make_pair(limit + 1, -1));
+                    it != open.end() && it->first <= new_limit; ++it)
+            {
+                int conflicts = std::get<2>(nodes[it->second]);
+                focal.insert(std::make_tuple(conflicts, it->first, it->second));
+            }
+            limit = new_limit;
+        }
+
+        int id = std::get<2>(*focal.begin());
+        int f = std::get<1>(*focal.begin());
+        focal.erase(focal.begin());
+        open.erase(std::make_pair(f, id));
+
+        int cell = std::get<0>(nodes[id]);
+        int t = std::get<1>(nodes[id]);
+        int conflicts = std::get<2>(nodes[id]);
+
+        if (cell == agent.goal && t > last_blocked)
+        {
+            std::vector<int> path{};
+            for (int curr = id; curr != -1; curr = std::get<3>(nodes[curr]))
+                path.push_back(std::get<0>(nodes[curr]));
+            std::reverse(path.begin(), path.end());
+
+            node.paths[a] = path;
+            node.bounds[a] = f_min;
+            return true;
+        }
+
+        if (t == horizon)
+            continue;
+
+        // Moving to a neighbor or waiting in place.
+        std::vector<int> moves = neighbors(window, cell);
+        moves.push_back(cell);
+        for (auto& next : moves)
+        {
+            if (next != cell)
+            {
+                // Only the goal may be a non-empty location, and we do not
+                // allow bin-to-bin or drop-to-drop travel.
+                if (window.layout[next] != EMPTY_LOC && next != agent.goal)
+                    continue;
+                if (window.layout[next] == BIN_LOC && window.layout[cell] == BIN_LOC)
+                    continue;
+                if (window.layout[next] == DROP_LOC && window.layout[cell] == DROP_LOC)
+                    continue;
+                // Other workers must have left the position before we enter.
+                if (window.reserved[t * cells + next])
+                    continue;
+            }
+            if (agent.dists[next] == -1)
+                continue;
+
+            int index = (t + 1) * cells + next;
+            if (seen[index] || forbidden[index] || window.reserved[index])
+                continue;
+            seen[index] = 1;
+
+            int next_conflicts = conflicts + occupied[index];
+            if (next != cell)
+                next_conflicts += occupied[t * cells + next];
+
+            int next_f = t + 1 + agent.dists[next];
+            int next_id = nodes.size();
+            nodes.push_back(std::make_tuple(next, t + 1, next_conflicts, id));
+            open.insert(std::make_pair(next_f, next_id));
+            if (next_f <= limit)
+                focal.insert(std::make_tuple(next_conflicts, next_f, next_id));
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Solves a window with ECBS. The high-level search expands the constraint
+ * tree node with the fewest conflicts among those whose cost is within
+ * SUBOPTIMALITY of the lowest lower bound. Each conflict is split into two
+ * children, each forbidding one of the agents from the conflicting position.
+ *
+ * @param window The window.
+ * @param solution Set to the conflict-free solution.
+ * @param expanded Set to the number of constraint tree nodes expanded.
+ *
+ * @return True if a solution was found in time.
+ */
+bool ECBSPlanningAlgo::solve(Window& window, Node& solution, int& expanded)
+{
+    std::size_t num_agents = window.agents.size();
+
+    Node root;
+    root.paths = std::vector<std::vector<int>>(num_agents);
+    root.bounds = std::vector<int>(num_agents, 0);
+    for (std::size_t a = 0; a < num_agents; a++)
+    {
+        if (!plan_agent(window, a, root))
+            return false;
+    }
+
+    Conflict conflict;
+    std::vector<Node> open{};
+    for (std::size_t a = 0; a < num_agents; a++)
+    {
+        root.cost += root.paths[a].size() - 1;
+        root.bound += root.bounds[a];
+    }
+    root.conflicts = find_conflicts(window, root.paths, conflict);
+    open.push_back(root);
+
+    expanded = 0;
+    while (!open.empty() && expanded < MAX_NODES && !out_of_time())
+    {
+        // Find the best node in the focal list.
+        int bound = open[0].bound;
+        for (auto& node : open)
+            bound = std::min(bound, node.bound);
+
+        std::size_t best = 0;
+        bool found = false;
+        for (std::size_t i = 0; i < open.size(); i++)
+        {
+            if (open[i].cost > bound * SUBOPTIMALITY)
+                continue;
+            if (!found || open[i].conflicts < open[best].conflicts ||
+                    (open[i].conflicts == open[best].conflicts &&
+                     open[i].cost < open[best].cost))
+            {
+                best = i;
+                found = true;
+            }
+        }
+        // Fall back to the node with the lowest bound.
+        if (!found)
+        {
+            for (std::size_t i = 0; i < open.size(); i++)
+                if (open[i].bound == bound)
+                    best = i;
+        }
+
+        Node node = open[best];
+        open.erase(open.begin() + best);
+        expanded++;
+
+        if (find_conflicts(window, node.paths, conflict) == 0)
+        {
+            solution = node;
+            return true;
+        }
+
+        // Split the conflict between its two agents.
+        Constraint branches[2] = {
+            Constraint{conflict.a, conflict.cell, conflict.t},
+            Constraint{conflict.b, conflict.cell, conflict.t_b}
+        };
+        for (auto& constraint : branches)
+        {
+            Node child = node;
+            child.constraints.push_back(constraint);
+            if (!plan_agent(window, constraint.agent, child))
+                continue;
+
+            child.cost = 0;
+            child.bound = 0;
+            for (std::size_t a = 0; a < num_agents; a++)
+            {
+                child.cost += child.paths[a].size() - 1;
+                child.bound += child.bounds[a];
+            }
+            child.conflicts = find_conflicts(window, child.paths, conflict);
+            open.push_back(child);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Plans the workers in the congested parts of the warehouse. A window is
+ * centered on each position that saw a new contention in the last iteration,
+ * unless it is already covered by a window, until the time budget runs out.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param logger The logger to use.
+ */
+void ECBSPlanningAlgo::plan(Warehouse *warehouse, Logger *logger)
+{
+    deadline = std::chrono::steady_clock::now() + budget;
+    tick++;
+
+    auto& workers = warehouse->get_workers();
+    planned_until.resize(workers.size(), 0);
+
+    // Find the positions with new contentions, the busiest first.
+    auto contention = warehouse->get_contention_spots();
+    std::vector<std::pair<int,int>> hot{};
+    for (auto& spot : contention)
+    {
+        int increase = spot.second - last_contention[spot.first];
+        if (increase > 0)
+            hot.push_back(std::make_pair(-increase, spot.first));
+    }
+    last_contention = contention;
+    std::sort(hot.begin(), hot.end());
+
+    std::vector<Window> windows{};
+    for (auto& spot : hot)
+    {
+        if (out_of_time())
+            break;
+
+        // Skip positions already covered by a window.
+        bool covered = false;
+        for (auto& w : windows)
+            covered = covered || in_window(w, spot.second);
+        if (covered)
+            continue;
+
+        Window window;
+        if (!build_window(warehouse, spot.second, window))
+            continue;
+        windows.push_back(window);
+
+        Node solution;
+        int expanded = 0;
+        if (!solve(window, solution, expanded))
+        {
+            windows_failed++;
+
+            log_msg = std::string{"ECBS could not plan around position: "};
+            log_msg.append(std::to_string(spot.second));
+            log_msg.append(" (windows planned: ");
+            log_msg.append(std::to_string(windows_solved));
+            log_msg.append(", abandoned: ");
+            log_msg.append(std::to_string(windows_failed));
+            log_msg.append(")");
+            logger->log(log_msg);
+            continue;
+        }
+
+        // Give each agent its plan, followed by the rest of its old path.
+        for (std::size_t a = 0; a < window.agents.size(); a++)
+        {
+            Agent& agent = window.agents[a];
+            std::vector<int> path{};
+            for (std::size_t t = 1; t < solution.paths[a].size(); t++)
+                path.push_back(to_global(window, solution.paths[a][t]));
+            path.insert(path.end(), agent.suffix.begin(), agent.suffix.end());
+
+            workers[agent.worker].set_path(path);
+            planned_until[agent.worker] = tick + solution.paths[a].size() - 1;
+        }
+        windows_solved++;
+
+        log_msg = std::string{"ECBS planned "};
+        log_msg.append(std::to_string(window.agents.size()));
+        log_msg.append(" workers around position: ");
+        log_msg.append(std::to_string(spot.second));
+        log_msg.append(" (nodes: ");
+        log_msg.append(std::to_string(expanded));
+        log_msg.append(", windows planned: ");
+        log_msg.append(std::to_string(windows_solved));
+        log_msg.append(", abandoned: ");
+        log_msg.append(std::to_string(windows_failed));
+        log_msg.append(")");
+        logger->log(log_msg);
+    }
+}
@@ -0,0 +1,169 @@
+#ifndef WARESIM_SIM_ALGO_PLANNING_ECBS_PLANNING_ALGO_H
+#define WARESIM_SIM_ALGO_PLANNING_ECBS_PLANNING_ALGO_H
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "planning_algo.h"
+
+/**
+ * Plans conflict-free paths for the workers in congested parts of the
+ * warehouse using Enhanced Conflict-Based Search (ECBS).
+ *
+ * Every iteration, the positions that saw a contention in the last iteration
+ * are used as the centers of small square windows. The moving workers in a
+ * window whose paths start inside it are planned together, each towards the
+ * last position of its path before the path leaves the window. Other workers
+ * in the window are obstacles that are expected to follow their current path.
+ *
+ * ECBS is bounded-suboptimal: both the high-level search over conflicts and
+ * the low-level space-time search for each worker only consider nodes whose
+ * cost is within SUBOPTIMALITY of the best lower bound, and among those
+ * prefer the ones with the fewest conflicts. Besides two workers in the same
+ * position, a worker may not move into a position another worker held in the
+ * previous step, so the plans work no matter in which order the scheduler
+ * processes the workers.
+ *
+ * Planning stops once the time budget for the iteration is used up, and
+ * windows that could not be solved in time are left unchanged.
+ */
+class ECBSPlanningAlgo : public PlanningAlgo
+{
+    public:
+        ECBSPlanningAlgo();
+        ECBSPlanningAlgo(int);
+        ~ECBSPlanningAlgo();
+
+        // Plans the paths of the workers in congested windows.
+        void plan(Warehouse *, Logger *) override;
+
+    private:
+        // Forbids an agent from being in a position at a time.
+        struct Constraint
+        {
+            int agent;
+            int cell;
+            int t;
+        };
+
+        // A worker being planned.
+        struct Agent
+        {
+            // The index of the worker.
+            int worker;
+            // The start and goal positions, local to the window.
+            int start;
+            int goal;
+            // The rest of the worker's path after the goal. If it is not empty
+            // the agent leaves the window once it reaches the goal, otherwise
+            // it stays at the goal.
+            std::vector<int> suffix{};
+            // The distance from each position in the window to the goal.
+            std::vector<int> dists{};
+        };
+
+        // A node in the high-level constraint tree.
+        struct Node
+        {
+            std::vector<Constraint> constraints{};
+            // The planned path of each agent, as local positions.
+            std::vector<std::vector<int>> paths{};
+            // The lower bound on the cost of each agent's path.
+            std::vector<int> bounds{};
+            // The sum of the path costs.
+            int cost = 0;
+            // The sum of the lower bounds.
+            int bound = 0;
+            // The number of conflicts between the paths.
+            int conflicts = 0;
+        };
+
+        // A conflict between two agents.
+        struct Conflict
+        {
+            // Agent a is in the cell at time t.
+            int a;
+            int t;
+            // Agent b is in the cell at time t_b.
+            int b;
+            int t_b;
+            int cell;
+        };
+
+        // A square part of the warehouse being planned.
+        struct Window
+        {
+            // The width of the warehouse.
+            int stride = 0;
+            // The bottom left corner and dimensions.
+            int x = 0;
+            int y = 0;
+            int width = 0;
+            int height = 0;
+            // The number of time steps planned.
+            int horizon = 0;
+            // The warehouse layout for each local position.
+            std::vector<int> layout{};
+            // The agents being planned.
+            std::vector<Agent> agents{};
+            // Positions held by other workers at each time step.
+            std::vector<char> reserved{};
+        };
+
+        // Returns true if a position lies inside the window.
+        bool in_window(Window&, int);
+        // Converts a position to a local position in the window.
+        int to_local(Window&, int);
+        // Converts a local position in the window to a position.
+        int to_global(Window&, int);
+        // Returns the local neighbors of a local position.
+        std::vector<int> neighbors(Window&, int);
+
+        // Builds a window around a position.
+        bool build_window(Warehouse *, int, Window&);
+        // Computes the distance from each local position to an agent's goal.
+        void compute_dists(Window&, Agent&);
+        // Returns the position of a path at a time.
+        int pos_at(std::vector<int>&, int);
+        // Returns the position of an agent at a time, or -1 if it has left.
+        int agent_at(Window&, std::vector<std::vector<int>>&, int, int);
+        // Counts the conflicts between the paths and finds the first one.
+        int find_conflicts(Window&, std::vector<std::vector<int>>&, Conflict&);
+        // Plans a single agent with focal search.
+        bool plan_agent(Window&, int, Node&);
+        // Solves a window with ECBS.
+        bool solve(Window&, Node&, int&);
+
+        // Returns true if the time budget has been used up.
+        bool out_of_time();
+
+        // The time budget for each iteration.
+        std::chrono::microseconds budget;
+        // When planning for this iteration must stop.
+        std::chrono::steady_clock::time_point deadline;
+        // The iteration number.
+        int tick = 0;
+        // The iteration until which each worker is following a plan.
+        std::vector<int> planned_until{};
+        // The contention counts seen in the last iteration.
+        std::unordered_map<int,int> last_contention{};
+        // Statistics.
+        int windows_solved = 0;
+        int windows_failed = 0;
+
+        // Used for logging.
+        std::string log_msg;
+
+        // The suboptimality bound.
+        const double SUBOPTIMALITY = 1.5;
+        // How far a window extends from its center.
+        const int WINDOW_RADIUS = 4;
+        // The most constraint tree nodes expanded for a window.
+        const int MAX_NODES = 256;
+        // The fewest agents a window must have to be planned.
+        const std::size_t MIN_AGENTS = 2;
+};
+
+#endif
@@ -0,0 +1,18 @@
+// Implementation for planning_algo.h
+#include "planning_algo.h"
+
+/**
+ * Constructor.
+ */
+PlanningAlgo::PlanningAlgo()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+PlanningAlgo::~PlanningAlgo()
+{
+
+}
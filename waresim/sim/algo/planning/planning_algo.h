@@ -0,0 +1,23 @@
+#ifndef WARESIM_SIM_ALGO_PLANNING_PLANNING_ALGO_H
+#define WARESIM_SIM_ALGO_PLANNING_PLANNING_ALGO_H
+
+#include "../../warehouse.h"
+#include "../../../logger/logger.h"
+
+/**
+ * Interface for planning algorithms. A planning algorithm is run by the
+ * scheduler at the start of every iteration, and may replace the paths of
+ * some workers with coordinated plans. A plan may contain wait steps, which
+ * repeat the worker's current position.
+ */
+class PlanningAlgo
+{
+    public:
+        PlanningAlgo();
+        virtual ~PlanningAlgo();
+
+        // Plans the paths of some of the workers.
+        virtual void plan(Warehouse *, Logger *) = 0;
+};
+
+#endif
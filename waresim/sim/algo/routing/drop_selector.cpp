@@ -0,0 +1,147 @@
+#include "drop_selector.h"
+
+/**
+ * Default constructor. Always chooses the closest drop location.
+ */
+DropSelector::DropSelector()
+{
+
+}
+
+/**
+ * Constructor.
+ *
+ * @param weight The weight given to congestion when choosing a drop location.
+ * A weight of zero always chooses the closest drop location.
+ */
+DropSelector::DropSelector(double weight)
+{
+    this->weight = weight;
+}
+
+/**
+ * Destructor.
+ */
+DropSelector::~DropSelector()
+{
+
+}
+
+/**
+ * Builds the distance field over all drop locations. The layout does not
+ * change during a simulation, so this is only done once.
+ *
+ * @param warehouse The warehouse for the simulation.
+ */
+void DropSelector::build(Warehouse *warehouse)
+{
+    if (built)
+        return;
+
+    field = DistanceField(warehouse, warehouse->get_drops());
+    built = true;
+}
+
+/**
+ * Returns the recent heat in and around a drop location. Workers waiting to
+ * use a drop queue up in the locations next to it, so these are included.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param drop The drop location.
+ */
+double DropSelector::congestion(Warehouse *warehouse, int drop)
+{
+    int width = warehouse->get_width();
+    int height = warehouse->get_height();
+
+    double heat = warehouse->get_heat(drop);
+    // Top neighbor.
+    if ((drop / width) != (height-1))
+        heat += warehouse->get_heat(drop + width);
+    // Bottom neighbor.
+    if (drop >= width)
+        heat += warehouse->get_heat(drop - width);
+    // Left neighbor.
+    if ((drop % width) != 0)
+        heat += warehouse->get_heat(drop - 1);
+    // Right neighbor.
+    if (((drop+1) % width) != 0)
+        heat += warehouse->get_heat(drop + 1);
+
+    return heat;
+}
+
+/**
+ * Returns the closest drop location to the position.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param pos The position to start from.
+ *
+ * @return The closest drop location, or the first drop location if none can
+ * be reached.
+ */
+int DropSelector::closest(Warehouse *warehouse, int pos)
+{
+    build(warehouse);
+
+    int drop = field.get_source(pos);
+    if (drop == DistanceField::UNREACHABLE)
+        return warehouse->get_drops()[0];
+    return drop;
+}
+
+/**
+ * Returns the distance from the position to the closest drop location.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param pos The position to start from.
+ *
+ * @return The distance, or UNREACHABLE if no drop location can be reached.
+ */
+int DropSelector::closest_dist(Warehouse *warehouse, int pos)
+{
+    build(warehouse);
+    return field.get_dist(pos);
+}
+
+/**
+ * Returns the drop location a worker at the position should use.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param pos The position of the worker.
+ */
+int DropSelector::choose(Warehouse *warehouse, int pos)
+{
+    if (weight <= 0.0)
+        return closest(warehouse, pos);
+
+    int best = -1;
+    double best_cost = 0.0;
+    for (auto& drop : warehouse->get_drops())
+    {
+        int d = distances->get_dist(warehouse, pos, drop);
+        if (d == DistanceField::UNREACHABLE)
+            continue;
+
+        double cost = d + weight * congestion(warehouse, drop);
+        if (best == -1 || cost < best_cost)
+        {
+            best = drop;
+            best_cost = cost;
+        }
+    }
+
+    if (best == -1)
+        return warehouse->get_drops()[0];
+    return best;
+}
+
+/**
+ * Set the distance cache to use instead of this selector's own.
+ *
+ * @param cache The distance cache to use.
+ */
+void DropSelector::set_distance_cache(DistanceCache *cache)
+{
+    this->distances = cache;
+}
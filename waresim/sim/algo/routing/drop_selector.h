@@ -0,0 +1,49 @@
+#ifndef SIM_ALGO_ROUTING_DROP_SELECTOR_H
+#define SIM_ALGO_ROUTING_DROP_SELECTOR_H
+
+#include "../../warehouse.h"
+#include "../path/distance_cache.h"
+#include "../path/distance_field.h"
+
+/**
+ * Chooses the drop location a worker should deliver its orders to. A single
+ * distance field over all drop locations is built the first time it is
+ * needed, so the closest drop to any position can be found in constant time.
+ * If a congestion weight is given, the drop locations are instead compared by
+ * distance plus the weighted recent heat around each drop, which spreads
+ * workers away from busy drops.
+ */
+class DropSelector
+{
+    public:
+        DropSelector();
+        DropSelector(double);
+        ~DropSelector();
+
+        // Returns the drop location to use from a position.
+        int choose(Warehouse *, int);
+        // Returns the closest drop location to a position.
+        int closest(Warehouse *, int);
+        // Returns the distance from a position to the closest drop location.
+        int closest_dist(Warehouse *, int);
+        // Set the distance cache to use.
+        void set_distance_cache(DistanceCache *);
+    private:
+        // Builds the drop distance field if it has not been built yet.
+        void build(Warehouse *);
+        // Returns the recent heat in and around a drop location.
+        double congestion(Warehouse *, int);
+
+        // The weight given to congestion when choosing a drop location.
+        double weight = 0.0;
+        // Whether the drop distance field has been built.
+        bool built = false;
+        // The distance from each position to the closest drop location.
+        DistanceField field{};
+        // Distances to each individual drop location.
+        DistanceCache own_distances;
+        // The cache in use, which may be shared with other algorithms.
+        DistanceCache *distances = &own_distances;
+};
+
+#endif
@@ -3,6 +3,25 @@
 // TODO Delete later, used for debug.
 #include <iostream>
 
+/**
+ * Constructor. Workers deliver to the closest drop location.
+ */
+FCFSRoutingAlgo::FCFSRoutingAlgo()
+{
+
+}
+
+/**
+ * Constructor.
+ *
+ * @param drop_weight The weight given to the recent congestion around a drop
+ * location when choosing where to deliver orders.
+ */
+FCFSRoutingAlgo::FCFSRoutingAlgo(double drop_weight) : drops(drop_weight)
+{
+
+}
+
 /**
  * Routes the specified worker.
  *
@@ -23,9 +42,9 @@ void FCFSRoutingAlgo::route_worker(Warehouse *warehouse, Worker& worker)
     if (orders_ready.size() > 2 || (orders.empty() && orders_ready.size() > 0))
     {
         // This is the logic for determining which location a worker will drop
-        // off its fulfilled orders to. We will simply choose the first one for
-        // ease.
-        int drop_loc = warehouse->get_drops()[0];
+        // off its fulfilled orders to. This is the closest one, unless
+        // congestion is being taken into account.
+        int drop_loc = drops.choose(warehouse, worker.get_pos());
         worker.set_routed(true);
         worker.set_current_dest(drop_loc);
         //std::cout << "Routing to drop at: " << drop_loc << std::endl;
@@ -56,3 +75,14 @@ void FCFSRoutingAlgo::route_worker(Warehouse *warehouse, Worker& worker)
     return;
     
 }
+
+/**
+ * Set the distance cache to use instead of this algorithm's own, so that the
+ * distances are shared with other simulations of the same warehouse.
+ *
+ * @param cache The distance cache to use.
+ */
+void FCFSRoutingAlgo::set_distance_cache(DistanceCache *cache)
+{
+    drops.set_distance_cache(cache);
+}
@@ -2,6 +2,7 @@
 #define SIM_ALGO_ROUTING_FCFS_ROUTING_ALGO_H
 
 #include "routing_algo.h"
+#include "drop_selector.h"
 
 /**
  * Encapsulates a first-come-first-serve routing algorithm for routing a worker
@@ -10,9 +11,16 @@
 class FCFSRoutingAlgo : public RoutingAlgo
 {
     public:
+        FCFSRoutingAlgo();
+        FCFSRoutingAlgo(double);
+
         // Route the worker.
         void route_worker(Warehouse *, Worker&) override;
+        // Set the distance cache to use.
+        void set_distance_cache(DistanceCache *);
     private:
+        // Chooses the drop location to deliver orders to.
+        DropSelector drops{};
 };
 
 #endif
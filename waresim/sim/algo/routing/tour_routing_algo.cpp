@@ -0,0 +1,189 @@
+#include "tour_routing_algo.h"
+
+#include <algorithm>
+
+/**
+ * Constructor.
+ */
+TourRoutingAlgo::TourRoutingAlgo()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+TourRoutingAlgo::~TourRoutingAlgo()
+{
+
+}
+
+/**
+ * Returns the distance between two positions. Unreachable positions are
+ * treated as being further away than any reachable one.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param start The starting position.
+ * @param end The ending position.
+ */
+int TourRoutingAlgo::dist(Warehouse *warehouse, int start, int end)
+{
+    int d = distances->get_dist(warehouse, start, end);
+    if (d == DistanceField::UNREACHABLE)
+        return warehouse->get_width() * warehouse->get_height();
+    return d;
+}
+
+/**
+ * Returns the length of the tour that starts at the position, visits the
+ * bins in order, and ends at the closest drop location to the last bin.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param start The position the tour starts from.
+ * @param tour The orders to visit, in order.
+ */
+int TourRoutingAlgo::tour_length(Warehouse *warehouse, int start,
+        std::vector<Order>& tour)
+{
+    int length = 0;
+    int curr = start;
+    for (auto& order : tour)
+    {
+        length += dist(warehouse, curr, order.get_pos());
+        curr = order.get_pos();
+    }
+
+    int drop_dist = drops.closest_dist(warehouse, curr);
+    if (drop_dist == DistanceField::UNREACHABLE)
+        drop_dist = warehouse->get_width() * warehouse->get_height();
+
+    return length + drop_dist;
+}
+
+/**
+ * Plans the next trip for a worker. The orders are chosen greedily by always
+ * going to the closest remaining bin, and the resulting tour is then improved
+ * with 2-opt moves (reversing a section of the tour) until no move makes it
+ * shorter.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param start The position of the worker.
+ * @param orders The orders the worker has not picked up yet.
+ * @param slots The number of orders the worker can pick on this trip.
+ *
+ * @return The orders to pick on this trip, in the order they should be
+ * picked.
+ */
+std::vector<Order> TourRoutingAlgo::plan_tour(Warehouse *warehouse, int start,
+        std::vector<Order> orders, std::size_t slots)
+{
+    // Build the nearest-neighbour tour.
+    std::vector<Order> tour{};
+    int curr = start;
+    while (tour.size() < slots && !orders.empty())
+    {
+        auto closest = orders.begin();
+        int closest_dist = dist(warehouse, curr, closest->get_pos());
+        for (auto it = orders.begin(); it != orders.end(); ++it)
+        {
+            int d = dist(warehouse, curr, it->get_pos());
+            if (d < closest_dist)
+            {
+                closest = it;
+                closest_dist = d;
+            }
+        }
+
+        curr = closest->get_pos();
+        tour.push_back(*closest);
+        orders.erase(closest);
+    }
+
+    // Refine the tour with 2-opt.
+    int best_length = tour_length(warehouse, start, tour);
+    bool improved = true;
+    while (improved)
+    {
+        improved = false;
+        for (std::size_t i = 0; i + 1 < tour.size(); i++)
+        {
+            for (std::size_t j = i + 1; j < tour.size(); j++)
+            {
+                std::reverse(tour.begin() + i, tour.begin() + j + 1);
+                int length = tour_length(warehouse, start, tour);
+                if (length < best_length)
+                {
+                    best_length = length;
+                    improved = true;
+                }
+                else
+                {
+                    // Undo the move.
+                    std::reverse(tour.begin() + i, tour.begin() + j + 1);
+                }
+            }
+        }
+    }
+
+    return tour;
+}
+
+/**
+ * Routes the specified worker.
+ *
+ * @param warehouse The warehouse for the simulation.
+ * @param worker A reference to the worker to route.
+ */
+void TourRoutingAlgo::route_worker(Warehouse *warehouse, Worker& worker)
+{
+    // Get the orders this worker has fulfilled.
+    std::vector<Order> orders_ready = worker.get_ready_orders();
+
+    // Get the orders for this worker.
+    std::vector<Order> orders = worker.get_orders();
+
+    // Go to the closest drop location once the worker is full, or once it has
+    // nothing left to pick up.
+    if (orders_ready.size() >= CAPACITY || (orders.empty() && orders_ready.size() > 0))
+    {
+        worker.set_routed(true);
+        worker.set_current_dest(drops.closest(warehouse, worker.get_pos()));
+        return;
+    }
+
+    // If there are orders to fulfill, we will route this worker towards the
+    // first bin of its planned tour.
+    if (!orders.empty())
+    {
+        auto tour = plan_tour(warehouse, worker.get_pos(), orders, 
+                CAPACITY - orders_ready.size());
+        Order next = tour[0];
+
+        // Set the current order for the worker.
+        worker.set_current_order(next);
+        // Set the current destination for the worker.
+        worker.set_current_dest(next.get_pos());
+        // Remove the order from the worker since we are going to fulfill it.
+        worker.remove_order(next);
+        // This worker has been routed.
+        worker.set_routed(true);
+        return;
+    }
+
+    // At this point the worker has nothing to do, so we will route it back to
+    // its initial location.
+    worker.set_current_dest(worker.get_initial_pos());
+    worker.set_routed(true);
+}
+
+/**
+ * Set the distance cache to use instead of this algorithm's own, so that the
+ * distances are shared with other simulations of the same warehouse.
+ *
+ * @param cache The distance cache to use.
+ */
+void TourRoutingAlgo::set_distance_cache(DistanceCache *cache)
+{
+    this->distances = cache;
+    drops.set_distance_cache(cache);
+}
@@ -0,0 +1,48 @@
+#ifndef SIM_ALGO_ROUTING_TOUR_ROUTING_ALGO_H
+#define SIM_ALGO_ROUTING_TOUR_ROUTING_ALGO_H
+
+#include <vector>
+
+#include "routing_algo.h"
+#include "drop_selector.h"
+#include "../path/distance_cache.h"
+
+/**
+ * Encapsulates a routing algorithm that plans a short pick tour for each
+ * worker. The bins for the worker's next trip are chosen with a
+ * nearest-neighbour tour, which is then refined with 2-opt, and the trip ends
+ * at the drop location that makes the whole tour shortest. The worker is
+ * routed to the first bin of the tour, and the tour is planned again when it
+ * gets there so that newly assigned orders are taken into account.
+ */
+class TourRoutingAlgo : public RoutingAlgo
+{
+    public:
+        TourRoutingAlgo();
+        ~TourRoutingAlgo();
+
+        // Route the worker.
+        void route_worker(Warehouse *, Worker&) override;
+        // Set the distance cache to use.
+        void set_distance_cache(DistanceCache *);
+    private:
+        // Returns the distance between two positions.
+        int dist(Warehouse *, int, int);
+        // Returns the length of a tour.
+        int tour_length(Warehouse *, int, std::vector<Order>&);
+        // Plans the next trip for a worker.
+        std::vector<Order> plan_tour(Warehouse *, int, std::vector<Order>, 
+                std::size_t);
+
+        // Cached distances between positions in the warehouse.
+        DistanceCache own_distances;
+        // The cache in use, which may be shared with other algorithms.
+        DistanceCache *distances = &own_distances;
+        // Finds the closest drop location.
+        DropSelector drops{};
+
+        // The number of orders a worker picks before going to a drop location.
+        const std::size_t CAPACITY = 3;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "checkpoint_reader.h"
+#include "checkpoint_writer.h"
+
+/**
+ * Constructor.
+ *
+ * @param data The data to read, as returned by load() or
+ * CheckpointWriter::get_data().
+ */
+CheckpointReader::CheckpointReader(std::string data)
+{
+    this->data = data;
+}
+
+/**
+ * Destructor.
+ */
+CheckpointReader::~CheckpointReader()
+{
+
+}
+
+/**
+ * Reads a checkpoint file and returns its data, without the header. Throws if
+ * the file is not a checkpoint or was written with another format version.
+ *
+ * @param file The checkpoint file.
+ */
+std::string CheckpointReader::load(std::string file)
+{
+    std::ifstream in(file, std::ios_base::binary);
+    if (!in.good())
+        throw("Cannot open checkpoint file.");
+
+    std::string contents{std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>()};
+
+    const std::string& magic = CheckpointWriter::MAGIC;
+    if (contents.compare(0, magic.size(), magic) != 0)
+        throw("Not a checkpoint file.");
+
+    CheckpointReader reader(contents.substr(magic.size()));
+    if (reader.read_int() != CheckpointWriter::VERSION)
+        throw("Unsupported checkpoint version.");
+
+    return reader.data.substr(reader.pos);
+}
+
+/**
+ * Returns the next byte of the data.
+ */
+unsigned char CheckpointReader::next()
+{
+    if (pos >= data.size())
+        throw("Checkpoint is truncated.");
+
+    return data[pos++];
+}
+
+/**
+ * Reads an integer written by CheckpointWriter::write_int().
+ */
+long long CheckpointReader::read_int()
+{
+    uint64_t bits = 0;
+    for (int shift = 0; ; shift += 7)
+    {
+        if (shift >= 64)
+            throw("Checkpoint is corrupt.");
+
+        unsigned char byte = next();
+        bits |= (uint64_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            break;
+    }
+
+    return (long long) (bits >> 1) ^ -(long long) (bits & 1);
+}
+
+/**
+ * Reads a double written by CheckpointWriter::write_double().
+ */
+double CheckpointReader::read_double()
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++)
+        bits |= (uint64_t) next() << (8 * i);
+
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Reads a boolean written by CheckpointWriter::write_bool().
+ */
+bool CheckpointReader::read_bool()
+{
+    return next() != 0;
+}
+
+/**
+ * Reads a string written by CheckpointWriter::write_string().
+ */
+std::string CheckpointReader::read_string()
+{
+    long long size = read_int();
+    if (size < 0 || (std::size_t) size > data.size() - pos)
+        throw("Checkpoint is truncated.");
+
+    std::string value = data.substr(pos, size);
+    pos += size;
+    return value;
+}
+
+/**
+ * Reads a vector of integers written by CheckpointWriter::write_ints().
+ */
+std::vector<int> CheckpointReader::read_ints()
+{
+    long long size = read_int();
+    if (size < 0 || (std::size_t) size > data.size() - pos)
+        throw("Checkpoint is truncated.");
+
+    std::vector<int> values;
+    values.reserve(size);
+    for (long long i = 0; i < size; i++)
+        values.push_back(read_int());
+    return values;
+}
+
+/**
+ * Reads a vector of doubles written by CheckpointWriter::write_doubles().
+ */
+std::vector<double> CheckpointReader::read_doubles()
+{
+    long long size = read_int();
+    if (size < 0 || (std::size_t) size > (data.size() - pos) / 8)
+        throw("Checkpoint is truncated.");
+
+    std::vector<double> values;
+    values.reserve(size);
+    for (long long i = 0; i < size; i++)
+        values.push_back(read_double());
+    return values;
+}
@@ -0,0 +1,43 @@
+#ifndef SIM_CHECKPOINT_CHECKPOINT_READER_H
+#define SIM_CHECKPOINT_CHECKPOINT_READER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Reads back the values written by a CheckpointWriter, in the same order.
+ * Reading past the end of the data throws.
+ */
+class CheckpointReader
+{
+    public:
+        CheckpointReader(std::string);
+        ~CheckpointReader();
+
+        // Returns the data of a checkpoint file, after checking its header.
+        static std::string load(std::string);
+
+        // Reads an integer.
+        long long read_int();
+        // Reads a double.
+        double read_double();
+        // Reads a boolean.
+        bool read_bool();
+        // Reads a string.
+        std::string read_string();
+        // Reads a vector of integers.
+        std::vector<int> read_ints();
+        // Reads a vector of doubles.
+        std::vector<double> read_doubles();
+    private:
+        // Returns the next byte.
+        unsigned char next();
+
+        // The data to read.
+        std::string data;
+        // The position of the next byte to read.
+        std::size_t pos = 0;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "checkpoint_writer.h"
+
+const std::string CheckpointWriter::MAGIC = "WARESIMCKPT";
+const int CheckpointWriter::VERSION;
+
+/**
+ * Constructor.
+ */
+CheckpointWriter::CheckpointWriter()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+CheckpointWriter::~CheckpointWriter()
+{
+
+}
+
+/**
+ * Writes an integer as a zigzag varint: seven bits per byte, lowest bits
+ * first, with the sign folded into the lowest bit.
+ *
+ * @param value The integer to write.
+ */
+void CheckpointWriter::write_int(long long value)
+{
+    uint64_t bits = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+
+    while (bits >= 0x80)
+    {
+        data.push_back((char) ((bits & 0x7f) | 0x80));
+        bits >>= 7;
+    }
+    data.push_back((char) bits);
+}
+
+/**
+ * Writes the bits of a double, lowest byte first.
+ *
+ * @param value The double to write.
+ */
+void CheckpointWriter::write_double(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    for (int i = 0; i < 8; i++)
+        data.push_back((char) ((bits >> (8 * i)) & 0xff));
+}
+
+/**
+ * Writes a boolean.
+ *
+ * @param value The boolean to write.
+ */
+void CheckpointWriter::write_bool(bool value)
+{
+    data.push_back(value ? 1 : 0);
+}
+
+/**
+ * Writes a string as its length followed by its bytes.
+ *
+ * @param value The string to write.
+ */
+void CheckpointWriter::write_string(const std::string& value)
+{
+    write_int(value.size());
+    data.append(value);
+}
+
+/**
+ * Writes a vector of integers as its size followed by its elements.
+ *
+ * @param values The integers to write.
+ */
+void CheckpointWriter::write_ints(const std::vector<int>& values)
+{
+    write_int(values.size());
+    for (auto& value : values)
+        write_int(value);
+}
+
+/**
+ * Writes a vector of doubles as its size followed by its elements.
+ *
+ * @param values The doubles to write.
+ */
+void CheckpointWriter::write_doubles(const std::vector<double>& values)
+{
+    write_int(values.size());
+    for (auto& value : values)
+        write_double(value);
+}
+
+/**
+ * Returns the data written so far, without the file header. Used to nest one
+ * checkpoint inside another with write_string().
+ */
+std::string CheckpointWriter::get_data()
+{
+    return data;
+}
+
+/**
+ * Writes the header and the data to a file. The file is written under a
+ * temporary name first and then renamed, so a crash while saving leaves the
+ * previous checkpoint intact.
+ *
+ * @param file The checkpoint file.
+ */
+void CheckpointWriter::save(std::string file)
+{
+    std::string tmp_file = file + ".tmp";
+
+    {
+        std::ofstream out(tmp_file, std::ios_base::binary | std::ios_base::trunc);
+        if (!out.good())
+            throw("Cannot open checkpoint file.");
+
+        CheckpointWriter header;
+        header.write_int(VERSION);
+
+        out.write(MAGIC.data(), MAGIC.size());
+        out.write(header.data.data(), header.data.size());
+        out.write(data.data(), data.size());
+        if (!out.good())
+            throw("Error writing checkpoint file.");
+    }
+
+    if (std::rename(tmp_file.c_str(), file.c_str()) != 0)
+        throw("Error writing checkpoint file.");
+}
@@ -0,0 +1,49 @@
+#ifndef SIM_CHECKPOINT_CHECKPOINT_WRITER_H
+#define SIM_CHECKPOINT_CHECKPOINT_WRITER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Builds a binary checkpoint of the simulation state. Integers are written as
+ * variable-length zigzag varints, so small values such as positions and
+ * counts take one or two bytes, and doubles are written as their exact bits
+ * so that a restored simulation continues exactly as the original would have.
+ *
+ * A checkpoint file starts with a magic string and a format version, which
+ * CheckpointReader checks before reading anything else.
+ */
+class CheckpointWriter
+{
+    public:
+        CheckpointWriter();
+        ~CheckpointWriter();
+
+        // Writes an integer.
+        void write_int(long long);
+        // Writes a double exactly.
+        void write_double(double);
+        // Writes a boolean.
+        void write_bool(bool);
+        // Writes a string, which may hold binary data.
+        void write_string(const std::string&);
+        // Writes a vector of integers.
+        void write_ints(const std::vector<int>&);
+        // Writes a vector of doubles.
+        void write_doubles(const std::vector<double>&);
+
+        // Returns the data written so far, without the file header.
+        std::string get_data();
+        // Writes the header and the data to a file.
+        void save(std::string);
+
+        // Identifies checkpoint files.
+        static const std::string MAGIC;
+        // The version of the format. Increase it when the format changes.
+        static const int VERSION = 2;
+    private:
+        // The data written so far.
+        std::string data;
+};
+
+#endif
@@ -34,6 +34,27 @@ Barrier::~Barrier()
  * thread, it will notify all the other threads.
  */
 void Barrier::arrive()
+{
+    arrive(true);
+}
+
+/**
+ * Called when a thread reaches a point partway through an iteration that every
+ * thread must reach before any continues. Works like arrive(), but without the
+ * wait time, which is only spent once per iteration.
+ */
+void Barrier::pass()
+{
+    arrive(false);
+}
+
+/**
+ * Waits for the other threads, and releases them if this thread is the last
+ * to arrive.
+ *
+ * @param pause Whether to wait the wait time before releasing the threads.
+ */
+void Barrier::arrive(bool pause)
 {
     // Acquire the lock before modifying anything.
     std::unique_lock<std::mutex> lock(mutex);
@@ -46,7 +67,8 @@ void Barrier::arrive()
         // TODO Delete. Creates time between steps. This is not necessary for
         // the correctness of the algorithm. It is simply so the human eye can
         // perceive changes on the view.
-        std::this_thread::sleep_for(std::chrono::milliseconds(wait_time));
+        if (pause)
+            std::this_thread::sleep_for(std::chrono::milliseconds(wait_time));
 
         // Reset the number of arrived threads.
         arrived = 0;
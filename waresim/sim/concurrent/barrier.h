@@ -13,8 +13,14 @@ class Barrier
         Barrier(int, int);
         ~Barrier();
 
+        // Wait for the other threads at the end of an iteration.
         void arrive();
+        // Wait for the other threads partway through an iteration.
+        void pass();
     private:
+        // Wait for the other threads, pausing before the next iteration.
+        void arrive(bool);
+
         // The wait time (in milliseconds) before starting the next iteration.
         int wait_time;
         // Used when entering the barrier.
@@ -0,0 +1,115 @@
+#ifndef SIM_CONCURRENT_BOUNDED_QUEUE_H
+#define SIM_CONCURRENT_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * A blocking first-in first-out queue with a fixed capacity, used to connect
+ * the stages of a pipeline. Pushing blocks while the queue is full and popping
+ * blocks while it is empty. Once the queue is closed, pushes fail straight
+ * away and pops fail as soon as the queue is empty, so every stage blocked on
+ * the queue wakes up and can stop.
+ */
+template <typename T>
+class BoundedQueue
+{
+    public:
+        BoundedQueue(std::size_t);
+
+        // Adds an item, blocking while the queue is full. Returns false if
+        // the queue was closed.
+        bool push(T);
+        // Removes the oldest item, blocking while the queue is empty. Returns
+        // false if the queue was closed and is empty.
+        bool pop(T&);
+        // Closes the queue.
+        void close();
+    private:
+        // The maximum number of items in the queue.
+        std::size_t capacity;
+        // The items in the queue, oldest first.
+        std::deque<T> items{};
+        // Whether the queue was closed.
+        bool closed = false;
+        // Lock on this mutex.
+        std::mutex mutex;
+        // Signalled when an item is removed or the queue is closed.
+        std::condition_variable not_full;
+        // Signalled when an item is added or the queue is closed.
+        std::condition_variable not_empty;
+};
+
+/**
+ * Constructor.
+ *
+ * @param capacity The maximum number of items in the queue. Must be at least
+ * one.
+ */
+template <typename T>
+BoundedQueue<T>::BoundedQueue(std::size_t capacity)
+{
+    this->capacity = capacity;
+}
+
+/**
+ * Adds an item to the back of the queue, waiting for room if the queue is
+ * full.
+ *
+ * @param item The item to add.
+ *
+ * @return False if the queue was closed, in which case the item is dropped.
+ */
+template <typename T>
+bool BoundedQueue<T>::push(T item)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    not_full.wait(lock, [=]{ return closed || items.size() < capacity; });
+
+    if (closed)
+        return false;
+
+    items.push_back(std::move(item));
+    not_empty.notify_one();
+    return true;
+}
+
+/**
+ * Removes the item at the front of the queue, waiting for one if the queue is
+ * empty.
+ *
+ * @param item Set to the removed item.
+ *
+ * @return False if the queue was closed and is empty.
+ */
+template <typename T>
+bool BoundedQueue<T>::pop(T& item)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [=]{ return closed || !items.empty(); });
+
+    if (items.empty())
+        return false;
+
+    item = std::move(items.front());
+    items.pop_front();
+    not_full.notify_one();
+    return true;
+}
+
+/**
+ * Closes the queue and wakes up every thread waiting on it.
+ */
+template <typename T>
+void BoundedQueue<T>::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_full.notify_all();
+    not_empty.notify_all();
+}
+
+#endif
@@ -0,0 +1,227 @@
+#include <chrono>
+#include <utility>
+
+#include "snapshot_buffer.h"
+
+/**
+ * Implementation for snapshot_buffer.h
+ */
+
+const int SnapshotBuffer::NUM_STATS;
+
+/**
+ * Constructor.
+ */
+SnapshotBuffer::SnapshotBuffer()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+SnapshotBuffer::~SnapshotBuffer()
+{
+
+}
+
+/**
+ * Publishes the workers at the end of a tick. The latest snapshot becomes the
+ * previous one. The snapshot is also kept if it is the first in a new multiple
+ * of the capture interval, so ticks skipped by the event engine do not lose a
+ * capture. A kept snapshot gets the statistics asked for in set_capture(). Must
+ * only be called by the thread that moves the workers and updates the
+ * statistics.
+ *
+ * @param tick The tick that ended.
+ * @param warehouse The warehouse holding the workers.
+ */
+void SnapshotBuffer::publish(long tick, Warehouse *warehouse)
+{
+    // Decide whether to keep the snapshot first, so the statistics are only
+    // read for the snapshots kept. Only this thread adds to the snapshots
+    // kept, so there is still room for it after the lock is released.
+    bool keep = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (capture_every > 0 && (last_capture < 0 ||
+                    tick / capture_every > last_capture / capture_every))
+        {
+            last_capture = tick;
+            if (captures.size() < capture_capacity)
+                keep = true;
+            else
+                dropped_captures++;
+        }
+    }
+
+    // Build the snapshots without holding the lock.
+    Snapshot snapshot;
+    snapshot.tick = tick;
+    snapshot.time = now();
+    for (auto& worker : warehouse->get_workers())
+        snapshot.positions.push_back(worker.get_pos());
+
+    Snapshot kept;
+    if (keep)
+    {
+        kept = snapshot;
+        if (stat_capture == STAT_CHANGES)
+            capture_changes(warehouse, kept);
+        else if (stat_capture == STAT_VALUES)
+            capture_values(warehouse, kept);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (keep)
+        captures.push_back(std::move(kept));
+    std::swap(previous, latest);
+    std::swap(latest, snapshot);
+}
+
+/**
+ * Adds the factor of each statistic to a snapshot, with the positions whose
+ * stored value changed since the last snapshot kept. A dropped snapshot is
+ * not compared against, so its changes are in the next snapshot kept.
+ *
+ * @param warehouse The warehouse holding the statistics.
+ * @param snapshot The snapshot to add the changes to.
+ */
+void SnapshotBuffer::capture_changes(Warehouse *warehouse, Snapshot& snapshot)
+{
+    const StatPyramid *pyramids[NUM_STATS] = {
+        &warehouse->get_heat_window_pyramid(),
+        &warehouse->get_heat_total_pyramid(),
+        &warehouse->get_contention_pyramid(),
+        &warehouse->get_deadlock_pyramid(),
+    };
+
+    if (kept_stats.empty())
+        kept_stats.assign(NUM_STATS, std::vector<double>(
+                    warehouse->get_width() * warehouse->get_height(), 0));
+
+    snapshot.stats.assign(NUM_STATS, StatChanges());
+    for (int k = 0; k < NUM_STATS; k++)
+    {
+        StatChanges& changes = snapshot.stats[k];
+        std::vector<double>& stored = kept_stats[k];
+        changes.factor = pyramids[k]->get_factor();
+        for (std::size_t pos = 0; pos < stored.size(); pos++)
+        {
+            double value = pyramids[k]->get_stored(pos);
+            if (value != stored[pos])
+            {
+                stored[pos] = value;
+                changes.positions.push_back(pos);
+                changes.stored.push_back(value);
+            }
+        }
+    }
+}
+
+/**
+ * Adds the value of each statistic at each position to a snapshot.
+ *
+ * @param warehouse The warehouse holding the statistics.
+ * @param snapshot The snapshot to add the values to.
+ */
+void SnapshotBuffer::capture_values(Warehouse *warehouse, Snapshot& snapshot)
+{
+    snapshot.stat_values.assign(NUM_STATS, std::vector<float>());
+    warehouse->get_heat_window_pyramid().get_level_means(0,
+            snapshot.stat_values[0]);
+    warehouse->get_heat_total_pyramid().get_level_means(0,
+            snapshot.stat_values[1]);
+    warehouse->get_contention_pyramid().get_level_means(0,
+            snapshot.stat_values[2]);
+    warehouse->get_deadlock_pyramid().get_level_means(0,
+            snapshot.stat_values[3]);
+}
+
+/**
+ * Copies the last two snapshots. Before two ticks have been published the
+ * missing snapshots have a tick of -1 and no positions.
+ *
+ * @param prev Set to the snapshot before the latest one.
+ * @param last Set to the latest snapshot.
+ */
+void SnapshotBuffer::read(Snapshot& prev, Snapshot& last)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    prev = previous;
+    last = latest;
+}
+
+/**
+ * Marks that the simulation has finished, so the view can stop.
+ */
+void SnapshotBuffer::finish()
+{
+    finished = true;
+}
+
+/**
+ * Returns whether the simulation has finished.
+ */
+bool SnapshotBuffer::is_finished()
+{
+    return finished;
+}
+
+/**
+ * Keeps the snapshot of every nth tick until it is taken. Once the given
+ * number of snapshots are waiting to be taken, further ones are dropped rather
+ * than making the simulation wait. Must be called before the simulation
+ * starts.
+ *
+ * @param every The number of ticks between the snapshots kept, or 0 to keep
+ * none.
+ * @param capacity The most snapshots kept at once.
+ * @param stats What the snapshots kept hold of the statistics.
+ */
+void SnapshotBuffer::set_capture(long every, std::size_t capacity,
+        StatCapture stats)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    capture_every = every;
+    capture_capacity = capacity;
+    stat_capture = stats;
+}
+
+/**
+ * Takes the oldest of the snapshots kept.
+ *
+ * @param snapshot Set to the snapshot taken.
+ *
+ * @return False if no snapshot was waiting.
+ */
+bool SnapshotBuffer::take_capture(Snapshot& snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (captures.empty())
+        return false;
+
+    snapshot = std::move(captures.front());
+    captures.pop_front();
+    return true;
+}
+
+/**
+ * Returns the number of snapshots that were dropped because too many were
+ * waiting to be taken.
+ */
+long SnapshotBuffer::get_dropped_captures()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped_captures;
+}
+
+/**
+ * Returns the current time in seconds, on the steady clock the snapshots are
+ * stamped with.
+ */
+double SnapshotBuffer::now()
+{
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
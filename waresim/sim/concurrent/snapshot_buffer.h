@@ -0,0 +1,120 @@
+#ifndef SIM_CONCURRENT_SNAPSHOT_BUFFER_H
+#define SIM_CONCURRENT_SNAPSHOT_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "../warehouse.h"
+
+/**
+ * Holds the last two snapshots of the workers published by the simulation,
+ * so that a view can draw them in between without reading the live state.
+ * The simulation publishes a snapshot at the end of each tick and the view
+ * reads both whenever it draws a frame, each at its own pace. The lock is
+ * only held to swap in a new snapshot or to copy the two out, so a slow view
+ * never holds up the simulation. A view that needs particular ticks rather
+ * than the latest ones can also have every nth tick kept for it, up to a limit
+ * past which they are dropped instead of waiting for the view. The ticks kept
+ * can also hold the statistics, read on the simulation thread when the tick is
+ * published, so the view never reads them while they are being changed.
+ */
+class SnapshotBuffer
+{
+    public:
+        SnapshotBuffer();
+        ~SnapshotBuffer();
+
+        // What the snapshots kept hold of the statistics.
+        enum StatCapture
+        {
+            // Nothing.
+            NO_STATS,
+            // The stored values that changed since the last snapshot kept.
+            STAT_CHANGES,
+            // The value at every position.
+            STAT_VALUES
+        };
+
+        // The changes in a statistic since the last snapshot kept.
+        struct StatChanges
+        {
+            // The common factor of the statistic.
+            double factor = 1.0;
+            // The positions whose stored value changed, in order.
+            std::vector<int> positions{};
+            // The stored value at each of those positions.
+            std::vector<double> stored{};
+        };
+
+        // The workers at the end of a tick.
+        struct Snapshot
+        {
+            // The tick that ended.
+            long tick = -1;
+            // When the snapshot was published, in seconds.
+            double time = 0;
+            // The position of each worker.
+            std::vector<int> positions{};
+            // The changes in the heat window, total heat, contentions and
+            // deadlocks, if the snapshot was kept with them.
+            std::vector<StatChanges> stats{};
+            // The value of each of them at each position, if the snapshot was
+            // kept with them.
+            std::vector<std::vector<float>> stat_values{};
+        };
+
+        // The number of statistics a snapshot can hold.
+        static const int NUM_STATS = 4;
+
+        // Publish the workers at the end of a tick.
+        void publish(long, Warehouse *);
+        // Copy the last two snapshots.
+        void read(Snapshot&, Snapshot&);
+        // Mark that the simulation has finished.
+        void finish();
+        // Returns whether the simulation has finished.
+        bool is_finished();
+        // Keep the snapshot of every nth tick, up to a number of them.
+        void set_capture(long, std::size_t, StatCapture);
+        // Take the oldest snapshot kept.
+        bool take_capture(Snapshot&);
+        // Returns the number of snapshots dropped because too many were kept.
+        long get_dropped_captures();
+
+        // Returns the current time in seconds, on the clock snapshots use.
+        static double now();
+    private:
+        // Add the changes in the statistics since the last snapshot kept.
+        void capture_changes(Warehouse *, Snapshot&);
+        // Add the values of the statistics.
+        void capture_values(Warehouse *, Snapshot&);
+
+        // The snapshot before the latest one.
+        Snapshot previous;
+        // The latest snapshot.
+        Snapshot latest;
+        // The number of ticks between the snapshots kept, or 0 to keep none.
+        long capture_every = 0;
+        // The most snapshots kept at once.
+        std::size_t capture_capacity = 0;
+        // What the snapshots kept hold of the statistics.
+        StatCapture stat_capture = NO_STATS;
+        // The stored value of each statistic at each position in the last
+        // snapshot kept. Only used by the simulation thread.
+        std::vector<std::vector<double>> kept_stats{};
+        // The tick of the last snapshot kept, or dropped, or -1 if none.
+        long last_capture = -1;
+        // The snapshots kept, oldest first.
+        std::deque<Snapshot> captures{};
+        // The number of snapshots dropped.
+        long dropped_captures = 0;
+        // Whether the simulation has finished.
+        std::atomic<bool> finished{false};
+        // Lock on this mutex.
+        std::mutex mutex;
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "thread_pool.h"
+
+namespace
+{
+    // The pool the calling thread belongs to, if any.
+    thread_local ThreadPool *current_pool = nullptr;
+    // The index of the calling thread in its pool.
+    thread_local int current_index = -1;
+}
+
+/**
+ * Constructor. Starts the threads.
+ *
+ * @param num_threads The number of threads, including the threads that call
+ * parallel_for(). Zero or less uses one thread per hardware thread.
+ */
+ThreadPool::ThreadPool(int num_threads)
+{
+    if (num_threads <= 0)
+        num_threads = std::thread::hardware_concurrency();
+    num_threads = std::max(1, num_threads);
+
+    for (int i = 0; i < num_threads - 1; i++)
+        queues.emplace_back(new TaskQueue());
+    for (int i = 0; i < num_threads - 1; i++)
+        threads.push_back(std::thread(&ThreadPool::work, this, i));
+}
+
+/**
+ * Destructor. Lets the threads finish the tasks that are left, then joins
+ * them.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+/**
+ * Returns the number of threads in the pool, counting the thread that calls
+ * parallel_for().
+ */
+int ThreadPool::size()
+{
+    return threads.size() + 1;
+}
+
+/**
+ * Runs a task on one of the threads. A task submitted from a thread of the
+ * pool goes to that thread's own deque, where it is likely to stay warm in
+ * the cache. Without any threads the task runs straight away.
+ *
+ * @param task The task to run.
+ */
+void ThreadPool::submit(std::function<void()> task)
+{
+    if (queues.empty())
+    {
+        task();
+        return;
+    }
+
+    int index = self();
+    if (index == -1)
+        index = next++ % queues.size();
+
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+
+    // Count the task under the lock so a thread about to wait sees it.
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending++;
+    }
+    condition.notify_one();
+}
+
+/**
+ * Calls the body on chunks of the range [begin, end) using the threads of the
+ * pool, and returns when every chunk is done. The calling thread runs tasks
+ * while it waits. The chunks never overlap, so a body that only writes to the
+ * elements of its own chunk needs no locking.
+ *
+ * @param begin The start of the range.
+ * @param end The end of the range.
+ * @param grain The smallest chunk worth running on another thread. Ranges no
+ * larger than this run on the calling thread.
+ * @param body Called with the start and end of each chunk.
+ */
+void ThreadPool::parallel_for(int begin, int end, int grain,
+        const std::function<void(int,int)>& body)
+{
+    int length = end - begin;
+    if (length <= 0)
+        return;
+    if (queues.empty() || length <= grain)
+    {
+        body(begin, end);
+        return;
+    }
+
+    // A few chunks per thread, so that stealing can even out the load.
+    int chunks = std::min((length + grain - 1) / std::max(1, grain), 4 * size());
+    std::atomic<int> remaining(chunks);
+
+    for (int c = 0; c < chunks; c++)
+    {
+        int chunk_begin = begin + (long long) length * c / chunks;
+        int chunk_end = begin + (long long) length * (c+1) / chunks;
+        submit([&body, &remaining, chunk_begin, chunk_end]
+        {
+            body(chunk_begin, chunk_end);
+            remaining--;
+        });
+    }
+
+    // Help until our chunks are done. The chunks left may be running on
+    // other threads, in which case there is nothing to take.
+    int index = self();
+    while (remaining > 0)
+    {
+        if (!run_one(index))
+            std::this_thread::yield();
+    }
+}
+
+/**
+ * The loop run by each thread of the pool. The thread runs tasks until there
+ * are none left and then waits for more.
+ *
+ * @param index The index of the thread.
+ */
+void ThreadPool::work(int index)
+{
+    current_pool = this;
+    current_index = index;
+
+    while (true)
+    {
+        if (run_one(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [=]{ return stopping || pending > 0; });
+        if (stopping && pending == 0)
+            return;
+    }
+}
+
+/**
+ * Takes one task and runs it. The thread's own deque is tried first, from the
+ * back, and then the other deques, from the front.
+ *
+ * @param index The index of the calling thread, or -1 if it is not in the
+ * pool.
+ *
+ * @return True if a task was run.
+ */
+bool ThreadPool::run_one(int index)
+{
+    int count = queues.size();
+    int start = (index == -1) ? 0 : index;
+
+    for (int k = 0; k < count; k++)
+    {
+        TaskQueue& queue = *queues[(start + k) % count];
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+
+            if (k == 0 && index != -1)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+
+        pending--;
+        task();
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Returns the index of the calling thread in this pool, or -1 if the thread
+ * does not belong to it.
+ */
+int ThreadPool::self()
+{
+    return (current_pool == this) ? current_index : -1;
+}
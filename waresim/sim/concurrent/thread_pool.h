@@ -0,0 +1,63 @@
+#ifndef SIM_CONCURRENT_THREAD_POOL_H
+#define SIM_CONCURRENT_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A work-stealing pool of threads. Each thread has its own deque of tasks: it
+ * takes tasks from the back of its own deque and, when that is empty, steals
+ * from the front of the other threads' deques. A thread that calls
+ * parallel_for() runs tasks while it waits, so a pool of n threads starts
+ * n - 1 threads of its own, and a pool of one thread runs everything on the
+ * calling thread.
+ */
+class ThreadPool
+{
+    public:
+        ThreadPool(int);
+        ~ThreadPool();
+
+        // Returns the number of threads, including the calling thread.
+        int size();
+        // Runs a task on one of the threads.
+        void submit(std::function<void()>);
+        // Splits a range into chunks and runs them on the threads.
+        void parallel_for(int, int, int, const std::function<void(int,int)>&);
+    private:
+        // A thread's tasks.
+        struct TaskQueue
+        {
+            std::deque<std::function<void()>> tasks{};
+            std::mutex mutex;
+        };
+
+        // The loop run by each thread of the pool.
+        void work(int);
+        // Runs one task, trying the given thread's deque first.
+        bool run_one(int);
+        // Returns the index of the calling thread in this pool, or -1.
+        int self();
+
+        // The deque of each thread.
+        std::vector<std::unique_ptr<TaskQueue>> queues{};
+        // The threads of the pool.
+        std::vector<std::thread> threads{};
+        // The number of tasks waiting in the deques.
+        std::atomic<int> pending{0};
+        // Used to spread tasks submitted from outside the pool.
+        std::atomic<unsigned int> next{0};
+        // Set when the pool is destroyed.
+        bool stopping = false;
+        // Idle threads wait on this condition variable.
+        std::mutex mutex;
+        std::condition_variable condition;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include <mutex>
+#include <utility>
+
+#include "wake_queue.h"
+
+/**
+ * Constructor.
+ */
+WakeQueue::WakeQueue()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+WakeQueue::~WakeQueue()
+{
+
+}
+
+/**
+ * Adds a worker ID to the queue. The worker must already have been given its
+ * new work, so that the thread draining the queue sees it.
+ *
+ * @param id The ID of the worker to wake up.
+ */
+void WakeQueue::push(int id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ids.push_back(id);
+}
+
+/**
+ * Removes all the worker IDs from the queue.
+ *
+ * @return The IDs of the workers to wake up, in the order they were pushed.
+ */
+std::vector<int> WakeQueue::drain()
+{
+    std::vector<int> woken{};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::swap(woken, ids);
+
+    return woken;
+}
@@ -0,0 +1,29 @@
+#ifndef SIM_CONCURRENT_WAKE_QUEUE_H
+#define SIM_CONCURRENT_WAKE_QUEUE_H
+
+#include <mutex>
+#include <vector>
+
+/**
+ * A queue of worker IDs that need to be woken up. One thread pushes the IDs
+ * of workers that were given new work and another thread takes all of them
+ * at the start of each iteration.
+ */
+class WakeQueue
+{
+    public:
+        WakeQueue();
+        ~WakeQueue();
+
+        // Add a worker ID to the queue.
+        void push(int);
+        // Remove and return all the worker IDs in the queue.
+        std::vector<int> drain();
+    private:
+        // The worker IDs waiting to be woken up.
+        std::vector<int> ids{};
+        // Lock on this mutex.
+        std::mutex mutex;
+};
+
+#endif
@@ -19,4 +19,7 @@ const char DROP_MARKER      = 'D';
 const char WORKER_MARKER    = 'W';
 const char WALL_MARKER      = 'X';
 
+// The length of the side of a bucket in the worker spatial index.
+const int INDEX_BUCKET_SIZE = 8;
+
 #endif
@@ -1,4 +1,9 @@
 #include <ctime>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "dispatcher.h"
 
@@ -21,27 +26,176 @@ Dispatcher::Dispatcher(time_t start_time, int sim_length)
  */
 void Dispatcher::run()
 {
+    if (order_queue != nullptr)
+    {
+        run_pipelined();
+        return;
+    }
+
     // Will be used for logging message.
     std::string log_msg;
     std::string log_iter_end = std::string("=====");
 
+    // Queue depth statistics.
+    long total_depth = 0;
+    long iterations = 0;
+    std::size_t max_depth = 0;
+
+    // The number of ticks dispatched so far.
+    long tick = 0;
+
     // Continue simulation until sim_length seconds have elapsed.
     while (difftime(time(nullptr), start_time) < sim_length)
     {
-        if (order_gen->has_order())
+        // Drain every order generated so far so that the algorithm can
+        // optimize over the whole batch.
+        std::vector<Order> orders = order_gen->get_orders();
+
+        // Record the queue depth for this iteration.
+        log_msg = std::string{"Queue depth: "};
+        log_msg.append(std::to_string(orders.size()));
+        logger.log(log_msg);
+
+        total_depth += orders.size();
+        iterations++;
+        if (orders.size() > max_depth)
+            max_depth = orders.size();
+
+        if (!orders.empty())
         {
-            // Log that we have a new order.
-            log_msg = std::string{"Dispach has new order. Assigned to worker #: "};
+            std::vector<int> ids = algo->assign_orders(this->warehouse, orders);
+
+            // Log the worker each order was assigned to, and wake it up in
+            // case it was idle.
+            for (std::size_t i = 0; i < ids.size(); i++)
+            {
+                log_msg = std::string{"Dispach has new order. Assigned to worker #: "};
+                log_msg.append(std::to_string(ids[i]));
+                logger.log(log_msg);
 
-            int id = algo->assign_order(this->warehouse, order_gen->get_order());
+                if (recorder != nullptr)
+                    recorder->add_assignment(tick, ids[i], orders[i].get_pos());
 
-            log_msg.append(std::to_string(id));
-            logger.log(log_msg);
+                if (wake_queue != nullptr)
+                    wake_queue->push(ids[i]);
+            }
         }
         
         logger.log(log_iter_end);
 
+        // Let the scheduler simulate the tick with the workers woken up, and
+        // wait until it has finished before assigning the next orders.
+        barrier->pass();
         barrier->arrive();
+        tick++;
+    }
+
+    // Log the queue depth summary.
+    if (iterations > 0)
+    {
+        log_msg = std::string{"Max queue depth: "};
+        log_msg.append(std::to_string(max_depth));
+        log_msg.append(", average queue depth: ");
+        log_msg.append(std::to_string(1.0 * total_depth / iterations));
+        logger.log(log_msg);
+    }
+}
+
+/**
+ * Assigns the orders in the pipelined mode, where the dispatcher runs ahead of
+ * the scheduler. The orders of tick t are assigned using the snapshot of the
+ * workers taken after tick t - lag, which the scheduler may have finished
+ * long ago. The snapshot does not have the orders assigned in the ticks since
+ * then, so those are assigned to it again first. The assignments therefore
+ * only depend on the snapshots and the orders, and not on how far ahead of the
+ * scheduler the dispatcher happens to be.
+ */
+void Dispatcher::run_pipelined()
+{
+    // Will be used for logging message.
+    std::string log_msg;
+    std::string log_iter_end = std::string("=====");
+
+    // Queue depth statistics.
+    long total_depth = 0;
+    long iterations = 0;
+    std::size_t max_depth = 0;
+
+    // The warehouse the orders are assigned in. It shares the layout of the
+    // simulated warehouse and takes its workers from each snapshot.
+    Warehouse view = warehouse->copy_layout();
+    // The state of the workers in the last snapshot.
+    Warehouse::WorkerState snapshot;
+    // The assignments of the last lag - 1 ticks, oldest first.
+    std::deque<std::vector<std::pair<int,Order>>> recent{};
+    // Maps worker IDs to their indexes.
+    std::unordered_map<int,int> id_to_index{};
+
+    std::vector<Order> orders{};
+    while (order_queue->pop(orders) && snapshot_queue->pop(snapshot))
+    {
+        view.set_worker_state(snapshot);
+
+        std::vector<Worker>& workers = view.get_workers();
+        if (id_to_index.empty())
+        {
+            for (std::size_t i = 0; i < workers.size(); i++)
+                id_to_index[workers[i].get_id()] = i;
+        }
+
+        // Catch the snapshot up with the assignments it does not have yet.
+        for (auto& batch : recent)
+        {
+            for (auto& assignment : batch)
+                workers[id_to_index[assignment.first]].assign(assignment.second);
+        }
+
+        // Record the queue depth for this iteration.
+        log_msg = std::string{"Queue depth: "};
+        log_msg.append(std::to_string(orders.size()));
+        logger.log(log_msg);
+
+        total_depth += orders.size();
+        iterations++;
+        if (orders.size() > max_depth)
+            max_depth = orders.size();
+
+        std::vector<std::pair<int,Order>> assignments{};
+        if (!orders.empty())
+        {
+            std::vector<int> ids = algo->assign_orders(&view, orders);
+
+            for (std::size_t i = 0; i < ids.size(); i++)
+            {
+                log_msg = std::string{"Dispach has new order. Assigned to worker #: "};
+                log_msg.append(std::to_string(ids[i]));
+                logger.log(log_msg);
+
+                assignments.push_back(std::make_pair(ids[i], orders[i]));
+            }
+        }
+
+        logger.log(log_iter_end);
+
+        recent.push_back(assignments);
+        if ((int) recent.size() >= lag)
+            recent.pop_front();
+
+        if (!assignment_queue->push(assignments))
+            break;
+    }
+
+    // Stop the order generator.
+    order_queue->close();
+
+    // Log the queue depth summary.
+    if (iterations > 0)
+    {
+        log_msg = std::string{"Max queue depth: "};
+        log_msg.append(std::to_string(max_depth));
+        log_msg.append(", average queue depth: ");
+        log_msg.append(std::to_string(1.0 * total_depth / iterations));
+        logger.log(log_msg);
     }
 }
 
@@ -85,6 +239,61 @@ void Dispatcher::set_algo(DispatchAlgo* a)
     this->algo = a;
 }
 
+/**
+ * Sets the queue used to wake up the workers that are assigned orders.
+ *
+ * @param q The queue of workers to wake up.
+ */
+void Dispatcher::set_wake_queue(WakeQueue *q)
+{
+    this->wake_queue = q;
+}
+
+/**
+ * Sets the queue of order batches. When set, the dispatcher runs in the
+ * pipelined mode. It does not use the barrier, and it only reads the layout
+ * of the warehouse.
+ *
+ * @param q The queue to pop the batch of orders of each tick from.
+ */
+void Dispatcher::set_order_queue(BoundedQueue<std::vector<Order>> *q)
+{
+    this->order_queue = q;
+}
+
+/**
+ * Sets the queue the assignments are pushed to in the pipelined mode.
+ *
+ * @param q The queue to push the assignments of each tick to.
+ */
+void Dispatcher::set_assignment_queue(BoundedQueue<std::vector<std::pair<int,Order>>> *q)
+{
+    this->assignment_queue = q;
+}
+
+/**
+ * Sets the queue of worker snapshots used in the pipelined mode. It must
+ * start with lag snapshots of the initial workers, and the scheduler pushes
+ * a snapshot after every tick.
+ *
+ * @param q The queue of worker snapshots.
+ */
+void Dispatcher::set_snapshot_queue(BoundedQueue<Warehouse::WorkerState> *q)
+{
+    this->snapshot_queue = q;
+}
+
+/**
+ * Sets how many ticks the snapshots lag behind the orders being assigned in
+ * the pipelined mode.
+ *
+ * @param lag The lag, at least 1.
+ */
+void Dispatcher::set_lag(int lag)
+{
+    this->lag = lag;
+}
+
 /**
  * Set the log file directory.
  *
@@ -94,3 +303,13 @@ void Dispatcher::set_log_dir(std::string dir)
 {
     logger.set_up(dir);
 }
+
+/**
+ * Set the replay log the orders assigned in each tick are recorded in.
+ *
+ * @param log The replay log to record in.
+ */
+void Dispatcher::set_recorder(ReplayLog *log)
+{
+    this->recorder = log;
+}
@@ -2,11 +2,16 @@
 #define SIM_DISPATCHER_H
 
 #include <ctime>
+#include <utility>
+#include <vector>
 
 #include "algo/dispatch/dispatch_algo.h"
 #include "concurrent/barrier.h"
+#include "concurrent/bounded_queue.h"
+#include "concurrent/wake_queue.h"
 #include "warehouse.h"
 #include "order_generator.h"
+#include "replay/replay_log.h"
 #include "thread/thread.h"
 #include "../logger/logger.h"
 
@@ -28,11 +33,25 @@ class Dispatcher : public Thread
         void set_barrier(Barrier *);
         // Set the dispatch algorithm.
         void set_algo(DispatchAlgo *);
+        // Set the queue of workers to wake up.
+        void set_wake_queue(WakeQueue *);
+        // Set the queue of order batches for the pipelined mode.
+        void set_order_queue(BoundedQueue<std::vector<Order>> *);
+        // Set the queue of assignments for the pipelined mode.
+        void set_assignment_queue(BoundedQueue<std::vector<std::pair<int,Order>>> *);
+        // Set the queue of worker snapshots for the pipelined mode.
+        void set_snapshot_queue(BoundedQueue<Warehouse::WorkerState> *);
+        // Set how many ticks the snapshots lag behind the orders.
+        void set_lag(int);
+        // Set the replay log to record the assignments in.
+        void set_recorder(ReplayLog *);
         // Set the log file directory.
         void set_log_dir(std::string dir);
     private:
         // Override from Thread.
         void run() override;
+        // Assigns the orders of each tick ahead of the scheduler.
+        void run_pipelined();
 
         // The start time of the simulation.
         time_t start_time;
@@ -46,6 +65,20 @@ class Dispatcher : public Thread
         Barrier *barrier = nullptr;
         // Dispatching algorithm.
         DispatchAlgo *algo = nullptr;
+        // Workers given new orders are pushed here, if set.
+        WakeQueue *wake_queue = nullptr;
+        // The pipelined mode pops the orders of each tick from here.
+        BoundedQueue<std::vector<Order>> *order_queue = nullptr;
+        // The pipelined mode pushes the IDs of the workers assigned each
+        // tick's orders here, with the orders.
+        BoundedQueue<std::vector<std::pair<int,Order>>> *assignment_queue = nullptr;
+        // The pipelined mode assigns orders using the workers popped from
+        // here.
+        BoundedQueue<Warehouse::WorkerState> *snapshot_queue = nullptr;
+        // How many ticks the snapshots lag behind the orders being assigned.
+        int lag = 1;
+        // The assignments of each tick are recorded here, if set.
+        ReplayLog *recorder = nullptr;
         // The logger.
         Logger logger;
 };
@@ -0,0 +1,697 @@
+#include <chrono>
+#include <ctime>
+#include <limits>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include "constants.h"
+#include "event_engine.h"
+
+/**
+ * Constructor.
+ *
+ * @param start_time The start time of the simulation.
+ * @param sim_length The length of the simulation in seconds. The engine stops
+ * after this long even if it has not simulated all its ticks. Zero or less
+ * only stops at the last tick.
+ */
+EventEngine::EventEngine(time_t start_time, int sim_length)
+{
+    this->start_time = start_time;
+    this->sim_length = sim_length;
+}
+
+/**
+ * Orders events by tick, then by type so that orders are assigned before the
+ * workers move, then by the order they were added in.
+ *
+ * @param other The event to compare with.
+ */
+bool EventEngine::Event::operator>(const Event &other) const
+{
+    if (time != other.time)
+        return time > other.time;
+    if (type != other.type)
+        return type > other.type;
+    return seq > other.seq;
+}
+
+/**
+ * Private method that encapsulates the event loop so it can be run in a
+ * thread.
+ */
+void EventEngine::run()
+{
+    simulate();
+}
+
+/**
+ * Runs the event loop on the calling thread. Every worker starts with an
+ * event in the first tick, and an idle worker stops having events until the
+ * dispatcher assigns it an order.
+ */
+void EventEngine::simulate()
+{
+    auto started = std::chrono::steady_clock::now();
+
+    std::string log_iter_end = std::string("=====");
+
+    std::vector<Worker>& workers = warehouse->get_workers();
+
+    for (std::size_t i = 0; i < workers.size(); i++)
+        id_to_index[workers[i].get_id()] = i;
+
+    // The algorithms of a forked simulation continue from the state of the
+    // algorithms it was forked from.
+    if (!algo_state.empty())
+    {
+        CheckpointReader reader(algo_state);
+        load_algo(reader, order_algo, true);
+        load_algo(reader, dispatch_algo, true);
+        load_algo(reader, path_algo, true);
+        load_algo(reader, contention_algo, true);
+        algo_state.clear();
+    }
+
+    // A restored simulation already has its events, and stopped between two
+    // ticks.
+    if (!restored)
+    {
+        asleep.assign(workers.size(), false);
+        for (std::size_t i = 0; i < workers.size(); i++)
+            push(0, WORKER_ARRIVAL, i);
+        schedule_arrival(-1);
+
+        contention_algo->new_iteration(warehouse);
+    }
+
+    while (!events.empty())
+    {
+        Event event = events.top();
+
+        if (ticks > 0 && event.time >= ticks)
+            break;
+
+        // Finish the current tick before moving on to the next one with an
+        // event. Skipped ticks do not decay the heat window. Checkpoints are
+        // taken here, between two ticks, and restored simulations continue
+        // from here.
+        if (event.time != now)
+        {
+            if (checkpoint_every > 0 &&
+                    event.time / checkpoint_every > now / checkpoint_every)
+                save_checkpoint();
+            if (sim_length > 0 &&
+                    difftime(time(nullptr), start_time) >= sim_length)
+                break;
+
+            warehouse->update_iteration();
+            logger.log(log_iter_end);
+            if (view_snapshots != nullptr)
+                view_snapshots->publish(now, warehouse);
+
+            if (wait_time > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(wait_time));
+
+            now = event.time;
+            contention_algo->new_iteration(warehouse);
+        }
+
+        events.pop();
+        handled++;
+
+        switch (event.type)
+        {
+            case ORDER_ARRIVAL:
+                handle_order(now);
+                break;
+            case PICK_COMPLETE:
+                metrics.picked++;
+                workers[event.worker].reached_order();
+                workers[event.worker].set_drop_status(true);
+                step(event.worker, now);
+                break;
+            case DROP_COMPLETE:
+                metrics.delivered +=
+                    workers[event.worker].get_ready_orders().size();
+                workers[event.worker].drop_off();
+                workers[event.worker].set_drop_status(false);
+                step(event.worker, now);
+                break;
+            case WORKER_ARRIVAL:
+                step(event.worker, now);
+                break;
+        }
+    }
+
+    if (!checkpoint_file.empty())
+        save_checkpoint();
+    if (view_snapshots != nullptr)
+        view_snapshots->finish();
+
+    metrics.ticks = now + 1;
+    metrics.deadlocks = 0;
+    for (auto& spot : warehouse->get_deadlock_spots())
+        metrics.deadlocks += spot.second;
+    metrics.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - started).count();
+
+    std::string log_msg{"Simulated ticks: "};
+    log_msg.append(std::to_string(now + 1));
+    log_msg.append(", events handled: ");
+    log_msg.append(std::to_string(handled));
+    logger.log(log_msg);
+}
+
+/**
+ * Adds an event to the queue.
+ *
+ * @param time The tick the event happens in.
+ * @param type The kind of event.
+ * @param worker The index of the worker, or -1.
+ */
+void EventEngine::push(long time, EventType type, int worker)
+{
+    Event event;
+    event.time = time;
+    event.type = type;
+    event.seq = num_events++;
+    event.worker = worker;
+
+    events.push(event);
+}
+
+/**
+ * Draws the tick of the next order arrival. Arrivals after the last tick are
+ * still added, so that a simulation restored from the last checkpoint
+ * receives them.
+ *
+ * @param now The current tick, or -1 before the first tick.
+ */
+void EventEngine::schedule_arrival(long now)
+{
+    long gap = order_algo->next_arrival();
+
+    if (now >= 0 && gap > std::numeric_limits<long>::max() - now)
+        return;
+
+    push(now + gap, ORDER_ARRIVAL, -1);
+}
+
+/**
+ * Generates a new order, assigns it to a worker and wakes the worker up if it
+ * was idle.
+ *
+ * @param now The current tick.
+ */
+void EventEngine::handle_order(long now)
+{
+    std::string log_msg;
+
+    std::vector<Order> orders{order_algo->get_new_order(warehouse)};
+    metrics.orders += orders.size();
+
+    log_msg = std::string("A new order is ready at :");
+    log_msg.append(std::to_string(orders[0].get_pos()));
+    logger.log(log_msg);
+
+    std::vector<int> ids = dispatch_algo->assign_orders(warehouse, orders);
+    for (auto& id : ids)
+    {
+        log_msg = std::string{"Dispach has new order. Assigned to worker #: "};
+        log_msg.append(std::to_string(id));
+        logger.log(log_msg);
+
+        // The worker starts moving in the next tick.
+        int index = id_to_index[id];
+        if (asleep[index])
+        {
+            asleep[index] = false;
+            push(now + 1, WORKER_ARRIVAL, index);
+        }
+    }
+
+    schedule_arrival(now);
+}
+
+/**
+ * Moves a worker one step along its path, routing it and finding the path
+ * first if needed, and adds the worker's next event. A worker that reaches a
+ * bin or a drop off location gets a pick or drop event in the next tick, and
+ * a worker that is blocked is handed to the contention algorithm and tries
+ * again in the next tick.
+ *
+ * @param index The index of the worker.
+ * @param now The current tick.
+ */
+void EventEngine::step(int index, long now)
+{
+    std::string log_msg;
+
+    Worker& worker = warehouse->get_workers()[index];
+    WorkerIndex& occupancy = warehouse->get_worker_index();
+    const std::vector<int>& layout = warehouse->get_layout();
+    int height = warehouse->get_height();
+    int width = warehouse->get_width();
+
+    log_msg = std::string{"Scheduling worker: "};
+    log_msg.append(std::to_string(worker.get_id()));
+    logger.log(log_msg);
+
+    // If worker is not on a path, apply the routing policy.
+    if (!worker.is_routed())
+        routing_algo->route_worker(warehouse, worker);
+
+    // If worker does not have a path, calculate one.
+    if (worker.get_path().empty())
+    {
+        worker.set_path(
+                path_algo->find(warehouse, worker.get_pos(),
+                    worker.get_current_dest()));
+    }
+
+    auto path = worker.get_path();
+    int curr_pos = worker.get_pos();
+
+    // The worker is already at its destination.
+    if (path.empty())
+    {
+        worker.set_routed(false);
+        if (layout[curr_pos] == BIN_LOC)
+        {
+            push(now, PICK_COMPLETE, index);
+            return;
+        }
+        if (layout[curr_pos] == DROP_LOC)
+        {
+            push(now, DROP_COMPLETE, index);
+            return;
+        }
+
+        // Nothing to do until the dispatcher assigns an order.
+        if (is_idle(worker))
+        {
+            asleep[index] = true;
+            return;
+        }
+
+        push(now + 1, WORKER_ARRIVAL, index);
+        return;
+    }
+
+    int next_pos = path[0];
+
+    // The worker waits in place for this tick.
+    if (next_pos == curr_pos)
+    {
+        path.erase(path.begin());
+        worker.set_path(path);
+        warehouse->move_worker(curr_pos, curr_pos);
+        push(now + 1, WORKER_ARRIVAL, index);
+        return;
+    }
+
+    int other = occupancy.get_worker(next_pos);
+
+    // The next position is taken.
+    if (other != -1)
+    {
+        log_msg = std::string{"Worker # "};
+        log_msg.append(std::to_string(index));
+        log_msg.append("'s next position is taken.");
+        logger.log(log_msg);
+        metrics.blocked++;
+
+        // The neighbors the worker could back off into.
+        bool top_valid = ((curr_pos / width) != (height-1)) &&
+            (layout[curr_pos+width] == EMPTY_LOC) &&
+            (occupancy.get_worker(curr_pos+width) == -1);
+        bool bot_valid = (curr_pos >= width) &&
+            (layout[curr_pos-width] == EMPTY_LOC) &&
+            (occupancy.get_worker(curr_pos-width) == -1);
+        bool left_valid = ((curr_pos % width) != 0) &&
+            (layout[curr_pos-1] == EMPTY_LOC) &&
+            (occupancy.get_worker(curr_pos-1) == -1);
+        bool right_valid = (((curr_pos+1) % width) != 0) &&
+            (layout[curr_pos+1] == EMPTY_LOC) &&
+            (occupancy.get_worker(curr_pos+1) == -1);
+
+        contention_algo->handle(worker, warehouse->get_workers()[other],
+                warehouse, top_valid, bot_valid, left_valid, right_valid,
+                &logger);
+
+        push(now + 1, WORKER_ARRIVAL, index);
+        return;
+    }
+
+    // Move the worker.
+    path.erase(path.begin());
+    worker.set_path(path);
+    worker.set_pos(next_pos);
+    warehouse->move_worker(curr_pos, next_pos);
+    metrics.moves++;
+
+    log_msg = std::string{"Moving worker # "};
+    log_msg.append(std::to_string(index));
+    log_msg.append(" to position: ");
+    log_msg.append(std::to_string(next_pos));
+    logger.log(log_msg);
+
+    // The worker picks or drops off in the next tick if it has arrived.
+    if (path.empty() && layout[next_pos] == BIN_LOC)
+    {
+        worker.set_routed(false);
+        push(now + 1, PICK_COMPLETE, index);
+    }
+    else if (path.empty() && layout[next_pos] == DROP_LOC)
+    {
+        worker.set_routed(false);
+        push(now + 1, DROP_COMPLETE, index);
+    }
+    else
+    {
+        push(now + 1, WORKER_ARRIVAL, index);
+    }
+}
+
+/**
+ * Returns true if the worker has no orders, no path and is parked at its
+ * initial position.
+ *
+ * @param worker The worker.
+ */
+bool EventEngine::is_idle(Worker& worker)
+{
+    return !worker.is_routed() && worker.get_load() == 0 &&
+        worker.get_path().empty() &&
+        worker.get_pos() == worker.get_initial_pos();
+}
+
+/**
+ * Set the warehouse.
+ *
+ * @param warehouse The warehouse to use.
+ */
+void EventEngine::set_warehouse(Warehouse *warehouse)
+{
+    this->warehouse = warehouse;
+}
+
+/**
+ * Set the order generating algorithm.
+ *
+ * @param algo The order generating algorithm to use.
+ */
+void EventEngine::set_order_algo(OrderAlgo *algo)
+{
+    this->order_algo = algo;
+}
+
+/**
+ * Set the dispatch algorithm.
+ *
+ * @param algo The dispatch algorithm to use.
+ */
+void EventEngine::set_dispatch_algo(DispatchAlgo *algo)
+{
+    this->dispatch_algo = algo;
+}
+
+/**
+ * Set the routing algorithm.
+ *
+ * @param algo The routing algorithm to use.
+ */
+void EventEngine::set_routing_algo(RoutingAlgo *algo)
+{
+    this->routing_algo = algo;
+}
+
+/**
+ * Set the pathfinding algorithm.
+ *
+ * @param algo The pathfinding algorithm to use.
+ */
+void EventEngine::set_path_algo(PathAlgo *algo)
+{
+    this->path_algo = algo;
+}
+
+/**
+ * Set the contention algorithm.
+ *
+ * @param algo The contention algorithm to use.
+ */
+void EventEngine::set_contention_algo(ContentionAlgo *algo)
+{
+    this->contention_algo = algo;
+}
+
+/**
+ * Set the number of ticks to simulate. The engine also stops when the
+ * simulation length has elapsed.
+ *
+ * @param ticks The number of ticks, or 0 for no limit.
+ */
+void EventEngine::set_ticks(long ticks)
+{
+    this->ticks = ticks;
+}
+
+/**
+ * Set the wait time between ticks, so the view can show each one.
+ *
+ * @param wait_time The wait time in milliseconds.
+ */
+void EventEngine::set_wait_time(int wait_time)
+{
+    this->wait_time = wait_time;
+}
+
+/**
+ * Set the log file directory.
+ *
+ * @param dir The new log file directory.
+ */
+void EventEngine::set_log_dir(std::string dir)
+{
+    logger.set_up(dir);
+}
+
+/**
+ * Writes the state of the simulation to the checkpoint file: the warehouse,
+ * the events that have not happened yet, the counts so far and the state of
+ * every algorithm, including their random number generators. It is written
+ * between two ticks, before the heat window is decayed for the tick that has
+ * just finished.
+ */
+void EventEngine::save_checkpoint()
+{
+    CheckpointWriter writer;
+
+    // The warehouse comes first, so it can be read without the rest.
+    warehouse->save(writer);
+
+    writer.write_int(now);
+    writer.write_int(handled);
+    writer.write_int(num_events);
+
+    auto pending = events;
+    writer.write_int(pending.size());
+    while (!pending.empty())
+    {
+        const Event& event = pending.top();
+        writer.write_int(event.time);
+        writer.write_int(event.type);
+        writer.write_int(event.seq);
+        writer.write_int(event.worker);
+        pending.pop();
+    }
+
+    std::vector<int> sleeping(asleep.begin(), asleep.end());
+    writer.write_ints(sleeping);
+
+    writer.write_int(metrics.orders);
+    writer.write_int(metrics.picked);
+    writer.write_int(metrics.delivered);
+    writer.write_int(metrics.moves);
+    writer.write_int(metrics.blocked);
+
+    save_algo(writer, order_algo);
+    save_algo(writer, dispatch_algo);
+    save_algo(writer, path_algo);
+    save_algo(writer, contention_algo);
+
+    writer.save(checkpoint_file);
+
+    std::string log_msg{"Checkpoint written after tick: "};
+    log_msg.append(std::to_string(now));
+    logger.log(log_msg);
+}
+
+/**
+ * Writes the state of an algorithm to a checkpoint, along with the type of
+ * the algorithm so that it is only restored into the same kind.
+ *
+ * @param writer The checkpoint to write to.
+ * @param algo The algorithm.
+ */
+template <typename Algo>
+void EventEngine::save_algo(CheckpointWriter& writer, Algo *algo)
+{
+    CheckpointWriter state;
+    algo->save(state);
+
+    writer.write_string(typeid(*algo).name());
+    writer.write_string(state.get_data());
+}
+
+/**
+ * Restores the state of an algorithm written by save_algo(). The state is
+ * skipped if it was written by a different kind of algorithm, or if the
+ * algorithms should keep their own state.
+ *
+ * @param reader The checkpoint to read from.
+ * @param algo The algorithm.
+ * @param restore Whether to restore the state.
+ */
+template <typename Algo>
+void EventEngine::load_algo(CheckpointReader& reader, Algo *algo, bool restore)
+{
+    std::string type = reader.read_string();
+    std::string state = reader.read_string();
+
+    if (restore && type == typeid(*algo).name())
+    {
+        CheckpointReader state_reader(state);
+        algo->load(state_reader);
+    }
+}
+
+/**
+ * Continues from a checkpoint written by this engine instead of starting a
+ * new simulation. Replaces the warehouse's state with the checkpoint's, so the
+ * warehouse and the algorithms must be set first. The number of ticks to
+ * simulate still counts from the start of the original simulation.
+ *
+ * Restoring the algorithms as well continues the simulation exactly as it
+ * would have gone on. Without them the algorithms keep their own seeds, so
+ * several runs can go on differently from the same warmed up state.
+ *
+ * @param reader The checkpoint to read from.
+ * @param restore_algos Whether to restore the state of the algorithms.
+ */
+void EventEngine::restore(CheckpointReader& reader, bool restore_algos)
+{
+    *warehouse = Warehouse::load(reader);
+
+    now = reader.read_int();
+    handled = reader.read_int();
+    num_events = reader.read_int();
+
+    events = decltype(events)();
+    for (long long i = reader.read_int(); i > 0; i--)
+    {
+        Event event;
+        event.time = reader.read_int();
+        event.type = (EventType) reader.read_int();
+        event.seq = reader.read_int();
+        event.worker = reader.read_int();
+        events.push(event);
+    }
+
+    std::vector<int> sleeping = reader.read_ints();
+    if (sleeping.size() != warehouse->get_workers().size())
+        throw("Invalid checkpoint: the workers do not match.");
+    asleep.assign(sleeping.begin(), sleeping.end());
+
+    metrics = Metrics();
+    metrics.orders = reader.read_int();
+    metrics.picked = reader.read_int();
+    metrics.delivered = reader.read_int();
+    metrics.moves = reader.read_int();
+    metrics.blocked = reader.read_int();
+
+    load_algo(reader, order_algo, restore_algos);
+    load_algo(reader, dispatch_algo, restore_algos);
+    load_algo(reader, path_algo, restore_algos);
+    load_algo(reader, contention_algo, restore_algos);
+
+    restored = true;
+}
+
+/**
+ * Continues from where another engine stopped, which must not be running.
+ * The events, counts and current tick are copied, but not the warehouse,
+ * which the caller copies along with the engine. The other engine is left as
+ * it was.
+ *
+ * @param other The engine to continue from.
+ * @param copy_algos Whether the algorithms of this engine continue from the
+ * state of the other engine's algorithms, when they are of the same kind.
+ * Otherwise they keep their own state and seeds.
+ */
+void EventEngine::fork(const EventEngine& other, bool copy_algos)
+{
+    events = other.events;
+    num_events = other.num_events;
+    now = other.now;
+    handled = other.handled;
+    asleep = other.asleep;
+    metrics = other.metrics;
+    restored = true;
+
+    // An engine that was itself forked may not have any algorithms yet, in
+    // which case it passes on the state it was given.
+    algo_state.clear();
+    if (copy_algos && other.order_algo != nullptr)
+    {
+        CheckpointWriter writer;
+        save_algo(writer, other.order_algo);
+        save_algo(writer, other.dispatch_algo);
+        save_algo(writer, other.path_algo);
+        save_algo(writer, other.contention_algo);
+        algo_state = writer.get_data();
+    }
+    else if (copy_algos)
+    {
+        algo_state = other.algo_state;
+    }
+}
+
+/**
+ * Set the file checkpoints are written to. A checkpoint is written whenever
+ * the simulation passes a multiple of the given number of ticks, and once
+ * more when it stops. Each checkpoint replaces the last one.
+ *
+ * @param file The checkpoint file, or empty for no checkpoints.
+ * @param every The number of ticks between checkpoints, or 0 to only write
+ * one when the simulation stops.
+ */
+void EventEngine::set_checkpoint(std::string file, long every)
+{
+    this->checkpoint_file = file;
+    this->checkpoint_every = file.empty() ? 0 : every;
+}
+
+/**
+ * Set the buffer the workers are published to at the end of each tick, so
+ * that the view can draw them without reading the live warehouse.
+ *
+ * @param buffer The buffer to publish to.
+ */
+void EventEngine::set_view_snapshots(SnapshotBuffer *buffer)
+{
+    this->view_snapshots = buffer;
+}
+
+/**
+ * Returns what happened during the simulation. Only complete once the
+ * simulation has finished.
+ */
+Metrics EventEngine::get_metrics()
+{
+    return metrics;
+}
@@ -0,0 +1,170 @@
+#ifndef SIM_EVENT_ENGINE_H
+#define SIM_EVENT_ENGINE_H
+
+#include <ctime>
+#include <functional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "algo/contention/contention_algo.h"
+#include "algo/dispatch/dispatch_algo.h"
+#include "algo/ordering/order_algo.h"
+#include "algo/path/path_algo.h"
+#include "algo/routing/routing_algo.h"
+#include "checkpoint/checkpoint_reader.h"
+#include "checkpoint/checkpoint_writer.h"
+#include "concurrent/snapshot_buffer.h"
+#include "metrics.h"
+#include "warehouse.h"
+#include "thread/thread.h"
+#include "../logger/logger.h"
+
+/**
+ * Runs the simulation as a sequence of timestamped events instead of stepping
+ * every component each tick. Time is still measured in ticks, and a worker
+ * still moves at most one position per tick, but the ticks in which nothing
+ * happens are skipped: order arrivals are drawn ahead of time and idle workers
+ * have no events until they are assigned an order.
+ *
+ * The engine replaces the order generator, the dispatcher and the scheduler,
+ * and uses the same ordering, dispatch, routing, pathfinding and contention
+ * algorithms.
+ */
+class EventEngine : public Thread
+{
+    public:
+        EventEngine(time_t, int);
+
+        // Set the warehouse.
+        void set_warehouse(Warehouse *);
+        // Set the order generating algorithm.
+        void set_order_algo(OrderAlgo *);
+        // Set the dispatch algorithm.
+        void set_dispatch_algo(DispatchAlgo *);
+        // Set the routing algorithm.
+        void set_routing_algo(RoutingAlgo *);
+        // Set the pathfinding algorithm.
+        void set_path_algo(PathAlgo *);
+        // Set the contention algorithm.
+        void set_contention_algo(ContentionAlgo *);
+        // Set the number of ticks to simulate.
+        void set_ticks(long);
+        // Set the wait time between ticks.
+        void set_wait_time(int);
+        // Set the log file directory.
+        void set_log_dir(std::string dir);
+        // Set the checkpoint file and how often to write it.
+        void set_checkpoint(std::string, long);
+        // Set the buffer the view reads the workers from.
+        void set_view_snapshots(SnapshotBuffer *);
+
+        // Continues from a checkpoint instead of starting a new simulation.
+        void restore(CheckpointReader&, bool);
+        // Continues from where another engine stopped.
+        void fork(const EventEngine&, bool);
+
+        // Runs the simulation on the calling thread.
+        void simulate();
+        // Returns what happened during the simulation.
+        Metrics get_metrics();
+    private:
+        // The kinds of events, in the order they are handled within a tick.
+        enum EventType
+        {
+            ORDER_ARRIVAL,
+            WORKER_ARRIVAL,
+            PICK_COMPLETE,
+            DROP_COMPLETE
+        };
+
+        // An event in the queue.
+        struct Event
+        {
+            // The tick the event happens in.
+            long time;
+            // The kind of event.
+            EventType type;
+            // Breaks ties so that events are handled in the order they were
+            // added.
+            long seq;
+            // The index of the worker, or -1.
+            int worker;
+
+            bool operator>(const Event &) const;
+        };
+
+        // Override from Thread.
+        void run() override;
+        // Adds an event to the queue.
+        void push(long, EventType, int);
+        // Draws the next order arrival after the given tick.
+        void schedule_arrival(long);
+        // Generates an order and assigns it to a worker.
+        void handle_order(long);
+        // Moves a worker one step and schedules its next event.
+        void step(int, long);
+        // Returns true if the worker has nothing to do.
+        bool is_idle(Worker&);
+        // Writes the state of the simulation to the checkpoint file.
+        void save_checkpoint();
+        // Writes the state of an algorithm to a checkpoint.
+        template <typename Algo>
+        void save_algo(CheckpointWriter&, Algo *);
+        // Restores the state of an algorithm from a checkpoint.
+        template <typename Algo>
+        void load_algo(CheckpointReader&, Algo *, bool);
+
+        // The start time for the simulation.
+        time_t start_time;
+        // The length of the simulation in seconds, or 0 for no limit.
+        int sim_length;
+        // The number of ticks to simulate, or 0 for no limit.
+        long ticks = 0;
+        // The wait time (in milliseconds) between ticks.
+        int wait_time = 0;
+        // The warehouse.
+        Warehouse *warehouse = nullptr;
+        // The order generating algorithm.
+        OrderAlgo *order_algo = nullptr;
+        // The dispatch algorithm.
+        DispatchAlgo *dispatch_algo = nullptr;
+        // The routing algorithm.
+        RoutingAlgo *routing_algo = nullptr;
+        // The pathfinding algorithm.
+        PathAlgo *path_algo = nullptr;
+        // The contention algorithm.
+        ContentionAlgo *contention_algo = nullptr;
+        // The events that have not happened yet, earliest first.
+        std::priority_queue<Event,std::vector<Event>,std::greater<Event>> events{};
+        // The number of events added so far.
+        long num_events = 0;
+        // The tick being simulated.
+        long now = 0;
+        // The number of events handled.
+        long handled = 0;
+        // Whether the simulation continues from a checkpoint or another
+        // engine.
+        bool restored = false;
+        // The state of the algorithms to restore before simulating, or empty.
+        std::string algo_state;
+        // The file checkpoints are written to, or empty for none.
+        std::string checkpoint_file;
+        // The number of ticks between checkpoints, or 0 to only write one at
+        // the end.
+        long checkpoint_every = 0;
+        // The workers are published here at the end of each tick for the
+        // view, if any.
+        SnapshotBuffer *view_snapshots = nullptr;
+        // Whether each worker is waiting for an order without any events.
+        std::vector<bool> asleep{};
+        // Maps worker IDs to their indexes.
+        std::unordered_map<int,int> id_to_index{};
+        // What happened during the simulation.
+        Metrics metrics{};
+        // The logger.
+        Logger logger;
+};
+
+#endif
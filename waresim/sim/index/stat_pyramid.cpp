@@ -0,0 +1,267 @@
+#include <algorithm>
+
+#include "stat_pyramid.h"
+
+/**
+ * Implementation for stat_pyramid.h
+ */
+
+/**
+ * Default constructor. Creates an empty pyramid.
+ */
+StatPyramid::StatPyramid()
+{
+
+}
+
+/**
+ * Constructor. Every value starts at zero.
+ *
+ * @param width The width of the warehouse.
+ * @param height The height of the warehouse.
+ */
+StatPyramid::StatPyramid(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    // Halve the dimensions until a single value covers the warehouse.
+    int w = width, h = height;
+    while (true)
+    {
+        widths.push_back(w);
+        heights.push_back(h);
+        levels.push_back(std::vector<double>(w * h, 0));
+        if (w <= 1 && h <= 1)
+            break;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+}
+
+/**
+ * Destructor.
+ */
+StatPyramid::~StatPyramid()
+{
+
+}
+
+/**
+ * Adds to the value at a position, and to the values that cover it in every
+ * coarser level.
+ *
+ * @param pos The position in the warehouse.
+ * @param value The amount to add.
+ */
+void StatPyramid::add(int pos, double value)
+{
+    int x = pos % width;
+    int y = pos / width;
+    double stored = value / factor;
+
+    for (std::size_t k = 0; k < levels.size(); k++)
+        levels[k][(y >> k) * widths[k] + (x >> k)] += stored;
+}
+
+/**
+ * Multiplies every value by a factor. Only the common factor changes, unless
+ * it has become too small.
+ *
+ * @param f The factor, which must be positive.
+ * @param pool The thread pool to rescale the stored values with, if any.
+ */
+void StatPyramid::scale(double f, ThreadPool *pool)
+{
+    factor *= f;
+    if (factor < MIN_FACTOR)
+        rescale(pool);
+}
+
+/**
+ * Folds the common factor into the stored values, so that it is one again.
+ *
+ * @param pool The thread pool to use, if any.
+ */
+void StatPyramid::rescale(ThreadPool *pool)
+{
+    for (auto& level : levels)
+    {
+        auto rescale_range = [this, &level](int begin, int end)
+        {
+            for (int i = begin; i < end; i++)
+                level[i] *= factor;
+        };
+        if (pool != nullptr)
+            pool->parallel_for(0, level.size(), RESCALE_GRAIN, rescale_range);
+        else
+            rescale_range(0, level.size());
+    }
+
+    factor = 1.0;
+}
+
+/**
+ * Returns the value at a position.
+ *
+ * @param pos The position in the warehouse.
+ */
+double StatPyramid::get(int pos) const
+{
+    return levels[0][pos] * factor;
+}
+
+/**
+ * Returns the value at each position.
+ */
+std::vector<double> StatPyramid::get_values() const
+{
+    std::vector<double> values = levels[0];
+    for (auto& value : values)
+        value *= factor;
+
+    return values;
+}
+
+/**
+ * Returns the value stored at a position, which times the common factor is
+ * its value. Unlike the values, the stored values only change where something
+ * is added, or when they are all rescaled.
+ *
+ * @param pos The position in the warehouse.
+ */
+double StatPyramid::get_stored(int pos) const
+{
+    return levels[0][pos];
+}
+
+/**
+ * Returns the factor every stored value is multiplied by.
+ */
+double StatPyramid::get_factor() const
+{
+    return factor;
+}
+
+/**
+ * Returns the number of levels. Level 0 holds the positions and the last
+ * level holds a single value.
+ */
+int StatPyramid::num_levels() const
+{
+    return levels.size();
+}
+
+/**
+ * Returns the width of a level.
+ *
+ * @param level The level.
+ */
+int StatPyramid::get_level_width(int level) const
+{
+    return widths[level];
+}
+
+/**
+ * Returns the height of a level.
+ *
+ * @param level The level.
+ */
+int StatPyramid::get_level_height(int level) const
+{
+    return heights[level];
+}
+
+/**
+ * Returns the finest level that is no wider and no higher than the given
+ * dimensions, or the coarsest level if none is.
+ *
+ * @param w The largest width.
+ * @param h The largest height.
+ */
+int StatPyramid::fit_level(int w, int h) const
+{
+    int level = 0;
+    while (level + 1 < num_levels() &&
+            (widths[level] > w || heights[level] > h))
+        level++;
+
+    return level;
+}
+
+/**
+ * Returns the mean of the positions that each value of a level covers, in
+ * the same order as the positions. The squares on the right and bottom edges
+ * can cover fewer positions than the others. This takes time in the size of
+ * the level, not of the warehouse.
+ *
+ * @param level The level.
+ * @param means Set to the mean of each value.
+ */
+void StatPyramid::get_level_means(int level, std::vector<float>& means) const
+{
+    int side = 1 << level;
+    int w = widths[level];
+    int h = heights[level];
+    means.resize(w * h);
+
+    for (int y = 0; y < h; y++)
+    {
+        int cover_h = std::min(side, height - y * side);
+        for (int x = 0; x < w; x++)
+        {
+            int cover_w = std::min(side, width - x * side);
+            means[y * w + x] =
+                levels[level][y * w + x] * factor / (cover_w * cover_h);
+        }
+    }
+}
+
+/**
+ * Writes the values to a checkpoint. The stored values are written along
+ * with the common factor, so that a restored pyramid gives exactly the same
+ * values as this one.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void StatPyramid::save(CheckpointWriter& writer) const
+{
+    writer.write_double(factor);
+    writer.write_doubles(levels[0]);
+}
+
+/**
+ * Reads the values written by save(). The pyramid must have been constructed
+ * with the dimensions of the warehouse it was written for.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void StatPyramid::load(CheckpointReader& reader)
+{
+    factor = reader.read_double();
+    std::vector<double> values = reader.read_doubles();
+    if (values.size() != levels[0].size())
+        throw("Invalid statistics in checkpoint.");
+    levels[0] = values;
+
+    rebuild();
+}
+
+/**
+ * Recomputes every coarser level from the positions.
+ */
+void StatPyramid::rebuild()
+{
+    for (std::size_t k = 1; k < levels.size(); k++)
+    {
+        std::fill(levels[k].begin(), levels[k].end(), 0);
+        for (int y = 0; y < heights[k-1]; y++)
+        {
+            for (int x = 0; x < widths[k-1]; x++)
+            {
+                levels[k][(y / 2) * widths[k] + (x / 2)] +=
+                    levels[k-1][y * widths[k-1] + x];
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef SIM_INDEX_STAT_PYRAMID_H
+#define SIM_INDEX_STAT_PYRAMID_H
+
+#include <vector>
+
+#include "../checkpoint/checkpoint_reader.h"
+#include "../checkpoint/checkpoint_writer.h"
+#include "../concurrent/thread_pool.h"
+
+/**
+ * A statistic of each position in the warehouse, along with coarser levels
+ * that sum it over squares of 2x2, 4x4, 8x8 and so on positions, up to a
+ * single value for the whole warehouse. Adding to a position updates one
+ * value per level, so the levels are always up to date and any of them can
+ * be read without looking at the positions it covers.
+ *
+ * Scaling every value, as the decaying statistics do every iteration, is done
+ * lazily: the values are stored divided by a common factor, which is all that
+ * changes. The stored values are only rescaled when the factor gets so small
+ * that they could overflow.
+ */
+class StatPyramid
+{
+    public:
+        StatPyramid();
+        StatPyramid(int, int);
+        ~StatPyramid();
+
+        // Add to the value at a position.
+        void add(int, double);
+        // Multiply every value by a factor.
+        void scale(double, ThreadPool *);
+        // Returns the value at a position.
+        double get(int) const;
+        // Returns the value at each position.
+        std::vector<double> get_values() const;
+        // Returns the value stored at a position, before the common factor.
+        double get_stored(int) const;
+        // Returns the common factor.
+        double get_factor() const;
+
+        // Returns the number of levels.
+        int num_levels() const;
+        // Returns the width of a level.
+        int get_level_width(int) const;
+        // Returns the height of a level.
+        int get_level_height(int) const;
+        // Returns the finest level no larger than the given dimensions.
+        int fit_level(int, int) const;
+        // Returns the mean of the positions each value of a level covers.
+        void get_level_means(int, std::vector<float>&) const;
+
+        // Write the values to a checkpoint.
+        void save(CheckpointWriter&) const;
+        // Read the values from a checkpoint.
+        void load(CheckpointReader&);
+    private:
+        // Recomputes the coarser levels from the positions.
+        void rebuild();
+        // Folds the common factor into the stored values.
+        void rescale(ThreadPool *);
+
+        // The dimensions of the warehouse.
+        int width = 0;
+        int height = 0;
+        // The stored values of each level, starting with the positions.
+        std::vector<std::vector<double>> levels{};
+        // The dimensions of each level.
+        std::vector<int> widths{};
+        std::vector<int> heights{};
+        // The factor every stored value is multiplied by.
+        double factor = 1.0;
+
+        // The smallest factor kept before the stored values are rescaled.
+        static constexpr double MIN_FACTOR = 1e-100;
+        // The smallest number of values worth rescaling on another thread.
+        static const int RESCALE_GRAIN = 1 << 14;
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "worker_index.h"
+#include "../util/util.h"
+
+/**
+ * Implementation for worker_index.h
+ */
+
+/**
+ * Default constructor. Creates an empty index.
+ */
+WorkerIndex::WorkerIndex()
+{
+
+}
+
+/**
+ * Constructor.
+ *
+ * @param width The width of the warehouse.
+ * @param height The height of the warehouse.
+ * @param bucket_size The length of the side of a bucket.
+ */
+WorkerIndex::WorkerIndex(int width, int height, int bucket_size)
+{
+    this->width = width;
+    this->height = height;
+    this->bucket_size = bucket_size;
+
+    buckets_w = (width + bucket_size - 1) / bucket_size;
+    buckets_h = (height + bucket_size - 1) / bucket_size;
+
+    occupants = std::vector<int>(width * height, -1);
+    bucket_counts = std::vector<int>(buckets_w * buckets_h, 0);
+}
+
+/**
+ * Destructor.
+ */
+WorkerIndex::~WorkerIndex()
+{
+
+}
+
+/**
+ * Returns the bucket that contains the position.
+ *
+ * @param pos The position in the warehouse.
+ */
+int WorkerIndex::bucket_of(int pos)
+{
+    int x, y;
+    pos_to_coord(&x, &y, pos, width);
+
+    return coord_to_pos(x / bucket_size, y / bucket_size, buckets_w);
+}
+
+/**
+ * Adds a worker to the index.
+ *
+ * @param worker The index of the worker in the warehouse.
+ * @param pos The position of the worker.
+ */
+void WorkerIndex::insert(int worker, int pos)
+{
+    occupants[pos] = worker;
+    bucket_counts[bucket_of(pos)]++;
+}
+
+/**
+ * Moves the worker at the start position to the end position. Like
+ * Warehouse::move_worker(), we assume the start position holds a worker and
+ * the end position is empty.
+ *
+ * @param start The current position of the worker.
+ * @param end The new position of the worker.
+ */
+void WorkerIndex::move(int start, int end)
+{
+    // Workers that stay put do not change the index.
+    if (start == end)
+        return;
+
+    int worker = occupants[start];
+    occupants[start] = -1;
+    occupants[end] = worker;
+
+    int start_bucket = bucket_of(start);
+    int end_bucket = bucket_of(end);
+    if (start_bucket != end_bucket)
+    {
+        bucket_counts[start_bucket]--;
+        bucket_counts[end_bucket]++;
+    }
+}
+
+/**
+ * Moves several workers at once. Unlike move(), a worker may move into a
+ * position that another worker is leaving in the same call, so chains and
+ * cycles of workers can move together.
+ *
+ * @param moves The start and end position of each worker that moves.
+ */
+void WorkerIndex::move_all(const std::vector<std::pair<int,int>>& moves)
+{
+    std::vector<int> movers{};
+    movers.reserve(moves.size());
+
+    // Lift all the workers off their start positions first.
+    for (auto& m : moves)
+    {
+        movers.push_back(occupants[m.first]);
+        occupants[m.first] = -1;
+        bucket_counts[bucket_of(m.first)]--;
+    }
+
+    // Then put them down on their end positions.
+    for (std::size_t i = 0; i < moves.size(); i++)
+    {
+        occupants[moves[i].second] = movers[i];
+        bucket_counts[bucket_of(moves[i].second)]++;
+    }
+}
+
+/**
+ * Returns the index of the worker at the position.
+ *
+ * @param pos The position in the warehouse.
+ *
+ * @return The index of the worker, or -1 if there is no worker there.
+ */
+int WorkerIndex::get_worker(int pos)
+{
+    return occupants[pos];
+}
+
+/**
+ * Adds the workers found in a bucket to the vector.
+ *
+ * @param bx The x-coordinate of the bucket.
+ * @param by The y-coordinate of the bucket.
+ * @param found The vector to add the workers to.
+ */
+void WorkerIndex::collect(int bx, int by, std::vector<int>& found)
+{
+    // Skip buckets outside the warehouse and empty buckets.
+    if (bx < 0 || by < 0 || bx >= buckets_w || by >= buckets_h)
+        return;
+    if (bucket_counts[coord_to_pos(bx, by, buckets_w)] <= 0)
+        return;
+
+    int x_end = std::min((bx + 1) * bucket_size, width);
+    int y_end = std::min((by + 1) * bucket_size, height);
+    for (int y = by * bucket_size; y < y_end; y++)
+    {
+        for (int x = bx * bucket_size; x < x_end; x++)
+        {
+            int worker = occupants[coord_to_pos(x, y, width)];
+            if (worker >= 0)
+                found.push_back(worker);
+        }
+    }
+}
+
+/**
+ * Returns at least 'count' of the workers closest to the position, or every
+ * worker if there are fewer. Buckets are searched in rings of increasing
+ * distance around the position's bucket. Once enough workers are found we
+ * search one more ring, since a worker in the next ring can be closer than a
+ * worker in the corner of the current one.
+ *
+ * @param pos The position to search around.
+ * @param count The minimum number of workers to return.
+ *
+ * @return The indexes of the workers that were found.
+ */
+std::vector<int> WorkerIndex::get_nearby(int pos, std::size_t count)
+{
+    std::vector<int> found{};
+
+    int cx, cy;
+    pos_to_coord(&cx, &cy, pos, width);
+    cx /= bucket_size;
+    cy /= bucket_size;
+
+    int max_ring = std::max(buckets_w, buckets_h);
+    // The ring at which we stop searching, once enough workers are found.
+    int last_ring = max_ring;
+
+    for (int ring = 0; ring <= last_ring && ring <= max_ring; ring++)
+    {
+        if (ring == 0)
+        {
+            collect(cx, cy, found);
+        }
+        else
+        {
+            // Top and bottom rows of the ring.
+            for (int bx = cx - ring; bx <= cx + ring; bx++)
+            {
+                collect(bx, cy - ring, found);
+                collect(bx, cy + ring, found);
+            }
+            // Left and right columns, without the corners.
+            for (int by = cy - ring + 1; by <= cy + ring - 1; by++)
+            {
+                collect(cx - ring, by, found);
+                collect(cx + ring, by, found);
+            }
+        }
+
+        if (found.size() >= count && last_ring == max_ring)
+            last_ring = ring + 1;
+    }
+
+    return found;
+}
@@ -0,0 +1,56 @@
+#ifndef SIM_INDEX_WORKER_INDEX_H
+#define SIM_INDEX_WORKER_INDEX_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * A spatial index of the workers in the warehouse. The warehouse is divided
+ * into square buckets and the index keeps track of which worker occupies each
+ * position and how many workers are in each bucket. Nearby workers are found
+ * by searching the buckets in rings around a position, so only the occupied
+ * buckets close to the position are scanned.
+ *
+ * All the storage is allocated up front, so moving a worker never
+ * reallocates and readers on other threads only ever see stale values.
+ */
+class WorkerIndex
+{
+    public:
+        WorkerIndex();
+        WorkerIndex(int, int, int);
+        ~WorkerIndex();
+
+        // Add a worker at a position.
+        void insert(int, int);
+        // Move the worker at the start position to the end position.
+        void move(int, int);
+        // Move several workers at once.
+        void move_all(const std::vector<std::pair<int,int>>&);
+        // Returns the index of the worker at a position, or -1.
+        int get_worker(int);
+        // Returns the workers closest to a position.
+        std::vector<int> get_nearby(int, std::size_t);
+
+    private:
+        // Returns the bucket containing a position.
+        int bucket_of(int);
+        // Adds the workers in a bucket to the vector.
+        void collect(int, int, std::vector<int>&);
+
+        // The warehouse dimensions.
+        int width = 0;
+        int height = 0;
+        // The length of the side of a bucket.
+        int bucket_size = 1;
+        // The number of buckets along each dimension.
+        int buckets_w = 0;
+        int buckets_h = 0;
+        // The index of the worker at each position, or -1 if it is empty.
+        std::vector<int> occupants{};
+        // The number of workers in each bucket.
+        std::vector<int> bucket_counts{};
+};
+
+#endif
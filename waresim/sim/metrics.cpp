@@ -0,0 +1,101 @@
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "metrics.h"
+
+/**
+ * Returns the two-sided 95% critical value of Student's t distribution. For
+ * degrees of freedom between the tabulated ones, the value for the next lower
+ * tabulated degrees of freedom is used, which gives a slightly wider interval.
+ *
+ * @param df The degrees of freedom, at least one.
+ */
+static double t_critical(int df)
+{
+    static const double TABLE[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+
+    if (df <= 30)
+        return TABLE[df - 1];
+    if (df < 40)
+        return 2.042;
+    if (df < 60)
+        return 2.021;
+    if (df < 120)
+        return 2.000;
+    return 1.980;
+}
+
+/**
+ * Returns the names of the reported metrics, in the order metric_values()
+ * returns them.
+ */
+std::vector<std::string> metric_names()
+{
+    return {"Ticks", "Orders", "Picked", "Delivered", "Throughput", "Moves",
+        "Blocked", "Deadlocks", "Seconds"};
+}
+
+/**
+ * Returns the value of each reported metric. Throughput is the number of
+ * orders delivered per tick.
+ *
+ * @param metrics The metrics of a simulation.
+ */
+std::vector<double> metric_values(const Metrics& metrics)
+{
+    double throughput = 0.0;
+    if (metrics.ticks > 0)
+        throughput = (double) metrics.delivered / metrics.ticks;
+
+    return {(double) metrics.ticks, (double) metrics.orders,
+        (double) metrics.picked, (double) metrics.delivered, throughput,
+        (double) metrics.moves, (double) metrics.blocked,
+        (double) metrics.deadlocks, metrics.seconds};
+}
+
+/**
+ * Computes the mean of a sample and the half width of its 95% confidence
+ * interval.
+ *
+ * @param values The sample, which must not be empty.
+ * @param mean Set to the mean.
+ * @param half_width Set to the half width of the interval.
+ */
+void confidence_interval(const std::vector<double>& values, double *mean,
+        double *half_width)
+{
+    int n = values.size();
+
+    double sum = 0.0;
+    for (auto& value : values)
+        sum += value;
+    *mean = sum / n;
+
+    // The interval needs at least two values to estimate the spread.
+    *half_width = 0.0;
+    if (n < 2)
+        return;
+
+    double squares = 0.0;
+    for (auto& value : values)
+        squares += (value - *mean) * (value - *mean);
+    *half_width = t_critical(n - 1) * std::sqrt(squares / (n - 1) / n);
+}
+
+/**
+ * Returns a metric as text.
+ *
+ * @param value The value of the metric.
+ */
+std::string metric_to_string(double value)
+{
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
@@ -0,0 +1,64 @@
+#ifndef SIM_METRICS_H
+#define SIM_METRICS_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Counts of what happened during a simulation, used to compare runs.
+ */
+struct Metrics
+{
+    // The number of ticks simulated.
+    long ticks = 0;
+    // The number of orders generated.
+    long orders = 0;
+    // The number of orders picked up from their bins.
+    long picked = 0;
+    // The number of orders dropped off.
+    long delivered = 0;
+    // The number of moves made by the workers.
+    long moves = 0;
+    // The number of times a worker's next position was taken.
+    long blocked = 0;
+    // The number of deadlocks found by the contention algorithm.
+    long deadlocks = 0;
+    // The wall clock time the simulation took, in seconds.
+    double seconds = 0.0;
+};
+
+/**
+ * Returns the names of the reported metrics, in the order metric_values()
+ * returns them.
+ */
+std::vector<std::string> metric_names();
+
+/**
+ * Returns the value of each reported metric, including the ones derived from
+ * the counts.
+ *
+ * @param metrics The metrics of a simulation.
+ */
+std::vector<double> metric_values(const Metrics& metrics);
+
+/**
+ * Computes the mean of a sample and the half width of its 95% confidence
+ * interval, using Student's t distribution. The half width is 0 if there are
+ * fewer than two values.
+ *
+ * @param values The sample, which must not be empty.
+ * @param mean Set to the mean.
+ * @param half_width Set to the half width of the interval.
+ */
+void confidence_interval(const std::vector<double>& values, double *mean,
+        double *half_width);
+
+/**
+ * Returns a metric as text, with six significant digits and without trailing
+ * zeros.
+ *
+ * @param value The value of the metric.
+ */
+std::string metric_to_string(double value);
+
+#endif
@@ -1,6 +1,6 @@
 #include "order.h"
 
-int Order::curr_id = 0;
+std::atomic<int> Order::curr_id{0};
 
 /**
  * Default constructor.
@@ -40,3 +40,35 @@ int Order::get_pos()
 {
     return pos;
 }
+
+/**
+ * Writes the order to a checkpoint.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void Order::save(CheckpointWriter& writer) const
+{
+    writer.write_int(my_id);
+    writer.write_int(pos);
+}
+
+/**
+ * Reads an order written by save(). Orders created afterwards get IDs above
+ * the restored order's, so the IDs stay unique.
+ *
+ * @param reader The checkpoint to read from.
+ *
+ * @return The restored order.
+ */
+Order Order::load(CheckpointReader& reader)
+{
+    Order order;
+    order.my_id = reader.read_int();
+    order.pos = reader.read_int();
+
+    int next = curr_id;
+    while (next <= order.my_id &&
+            !curr_id.compare_exchange_weak(next, order.my_id + 1));
+
+    return order;
+}
@@ -1,6 +1,11 @@
 #ifndef SIM_ORDER_H
 #define SIM_ORDER_H
 
+#include <atomic>
+
+#include "checkpoint/checkpoint_reader.h"
+#include "checkpoint/checkpoint_writer.h"
+
 /**
  * @author Joshua A. Campbell
  *
@@ -15,10 +20,15 @@ class Order
 
         // Returns the position of this order in the factory.
         int get_pos();
+        // Writes the order to a checkpoint.
+        void save(CheckpointWriter&) const;
+        // Reads an order from a checkpoint.
+        static Order load(CheckpointReader&);
 
     private:
-        // We will use this to create unique IDs for each order.
-        static int curr_id;
+        // We will use this to create unique IDs for each order. Orders can be
+        // created by several simulations at once.
+        static std::atomic<int> curr_id;
         // ID of this order.
         int my_id;
         // Location of this order.
@@ -21,14 +21,26 @@ OrderGenerator::OrderGenerator(time_t start_time, int sim_length)
  */
 void OrderGenerator::run()
 {
+    if (order_queue != nullptr)
+    {
+        run_pipelined();
+        return;
+    }
+
     // Will be used for logging message.
     std::string log_msg;
 
     std::string log_iter_end = std::string("=====");
 
+    // The number of ticks generated so far.
+    long tick = 0;
+
     // Continue simulation until sim_length seconds have elapsed.
     while (difftime(time(nullptr), start_time) < sim_length)
     { 
+        // Generate the orders while the scheduler simulates the tick, so the
+        // dispatcher gets all of them at the start of the next one.
+        barrier->pass();
 
         if (order_algo->order_ready())
         {
@@ -40,6 +52,9 @@ void OrderGenerator::run()
             log_msg.append(std::to_string(order.get_pos()));
             logger.log(log_msg);
 
+            if (recorder != nullptr)
+                recorder->add_order(tick, order.get_pos());
+
             // Add the order to the queue.
             add_order(order);
         }
@@ -47,10 +62,48 @@ void OrderGenerator::run()
         logger.log(log_iter_end);
 
         barrier->arrive();
+        tick++;
     }
 
 }
 
+/**
+ * Generates the orders in the pipelined mode. Every tick pushes one batch,
+ * which may be empty, so the dispatcher can tell the ticks apart. The queue
+ * lets the generator run ahead of the dispatcher by as many ticks as it
+ * holds, and the generator stops when the queue is closed.
+ */
+void OrderGenerator::run_pipelined()
+{
+    // Will be used for logging message.
+    std::string log_msg;
+
+    std::string log_iter_end = std::string("=====");
+
+    while (true)
+    {
+        std::vector<Order> batch{};
+
+        if (order_algo->order_ready())
+        {
+            // Get the new order.
+            Order order = order_algo->get_new_order(warehouse);
+
+            // Log that a new order is ready.
+            log_msg = std::string("A new order is ready at :");
+            log_msg.append(std::to_string(order.get_pos()));
+            logger.log(log_msg);
+
+            batch.push_back(order);
+        }
+
+        logger.log(log_iter_end);
+
+        if (!order_queue->push(batch))
+            break;
+    }
+}
+
 /**
  * Returns true if there is an order available.
  *
@@ -83,6 +136,29 @@ Order OrderGenerator::get_order()
     return ret;
 }
 
+/**
+ * Removes and returns all of the orders that are currently in the queue. Does
+ * not block if the queue is empty.
+ *
+ * @return The orders in the queue, oldest first.
+ */
+std::vector<Order> OrderGenerator::get_orders()
+{
+    // Lock on the orders mutex.
+    std::unique_lock<std::mutex> lock(orders_mutex);
+
+    // Drain the queue.
+    std::vector<Order> ret{};
+    ret.reserve(orders.size());
+    while (!orders.empty())
+    {
+        ret.push_back(std::move(orders.front()));
+        orders.pop();
+    }
+
+    return ret;
+}
+
 /**
  * Adds an order to the order queue.
  *
@@ -129,6 +205,17 @@ void OrderGenerator::set_warehouse(Warehouse *warehouse)
     this->warehouse = warehouse;
 }
 
+/**
+ * Set the queue of order batches. When set, the generator runs in the
+ * pipelined mode and does not use the barrier.
+ *
+ * @param queue The queue to push the batch of orders of each tick to.
+ */
+void OrderGenerator::set_order_queue(BoundedQueue<std::vector<Order>> *queue)
+{
+    this->order_queue = queue;
+}
+
 /**
  * Set the log file directory.
  *
@@ -138,3 +225,13 @@ void OrderGenerator::set_log_dir(std::string dir)
 {
     logger.set_up(dir);
 }
+
+/**
+ * Set the replay log the order generated in each tick is recorded in.
+ *
+ * @param log The replay log to record in.
+ */
+void OrderGenerator::set_recorder(ReplayLog *log)
+{
+    this->recorder = log;
+}
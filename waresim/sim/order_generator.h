@@ -5,11 +5,14 @@
 #include <ctime>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 #include "algo/ordering/order_algo.h"
 #include "concurrent/barrier.h"
+#include "concurrent/bounded_queue.h"
 #include "warehouse.h"
 #include "order.h"
+#include "replay/replay_log.h"
 #include "thread/thread.h"
 #include "../logger/logger.h"
 
@@ -33,11 +36,19 @@ class OrderGenerator : public Thread
         bool has_order();
         // Returns the next order or blocks if there are no orders.
         Order get_order();
+        // Removes and returns all the orders in the queue without blocking.
+        std::vector<Order> get_orders();
+        // Set the queue of order batches for the pipelined mode.
+        void set_order_queue(BoundedQueue<std::vector<Order>> *);
+        // Set the replay log to record the orders in.
+        void set_recorder(ReplayLog *);
         // Set the log file directory.
         void set_log_dir(std::string dir);
     private:
         // Override from Thread.
         void run() override;
+        // Generates the orders of each tick ahead of the dispatcher.
+        void run_pipelined();
 
         // Adds an order to the order queue.
         void add_order(const Order);
@@ -54,6 +65,11 @@ class OrderGenerator : public Thread
         std::condition_variable order_condition;
         // The barrier.
         Barrier *barrier = nullptr;
+        // The batch of orders of each tick is pushed here in the pipelined
+        // mode.
+        BoundedQueue<std::vector<Order>> *order_queue = nullptr;
+        // The orders of each tick are recorded here, if set.
+        ReplayLog *recorder = nullptr;
         // The ordering generating algorithm to use.
         OrderAlgo * order_algo;
         // The warehouse to choose bins from.
@@ -1,3 +1,5 @@
+#include <sstream>
+
 #include "rand.h"
 
 /**
@@ -60,3 +62,30 @@ std::mt19937 Rand::get_urng()
 {
     return gen;
 }
+
+/**
+ * Writes the state of the generator to a checkpoint.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void Rand::save(CheckpointWriter& writer)
+{
+    std::ostringstream out;
+    out << gen;
+    writer.write_string(out.str());
+}
+
+/**
+ * Restores the state of the generator from a checkpoint, so that it continues
+ * the sequence from where it was saved.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void Rand::load(CheckpointReader& reader)
+{
+    std::istringstream in(reader.read_string());
+    in >> gen;
+    if (!in)
+        throw("Invalid random generator state in checkpoint.");
+    dis.reset();
+}
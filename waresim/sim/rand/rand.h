@@ -3,6 +3,9 @@
 
 #include <random>
 
+#include "../checkpoint/checkpoint_reader.h"
+#include "../checkpoint/checkpoint_writer.h"
+
 /**
  * A random number generator that uses a 32-bit Mersenne twister
  * to return real numbers in the uniform distribution [0,1). These Rand's are
@@ -19,6 +22,10 @@ class Rand
         double rand();
         // Return the underlying URNG.
         std::mt19937 get_urng();
+        // Writes the state of the generator to a checkpoint.
+        void save(CheckpointWriter&);
+        // Restores the state of the generator from a checkpoint.
+        void load(CheckpointReader&);
     private:
         // Seed this generator. Should only be called once.
         void seed(unsigned int);
@@ -0,0 +1,206 @@
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "replay_log.h"
+
+const std::string ReplayLog::MAGIC = "WaresimReplay";
+const int ReplayLog::VERSION;
+
+/**
+ * Constructor.
+ */
+ReplayLog::ReplayLog()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+ReplayLog::~ReplayLog()
+{
+
+}
+
+/**
+ * Reads a replay log written by save(), replacing anything recorded so far.
+ *
+ * @param file The replay log to read.
+ */
+void ReplayLog::load(std::string file)
+{
+    std::ifstream in(file);
+    if (!in)
+        throw("Cannot open replay log.");
+
+    std::string magic;
+    int version = 0;
+    in >> magic >> version;
+    if (magic != MAGIC)
+        throw("Not a replay log.");
+    if (version != VERSION)
+        throw("Unsupported replay log version.");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    tick_log.clear();
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key))
+            continue;
+
+        long tick = 0;
+        int worker = 0, pos = 0;
+        if (key == "Seed")
+            fields >> seed;
+        else if (key == "SchedulerSeed")
+            fields >> scheduler_seed;
+        else if (key == "Ticks")
+            fields >> ticks;
+        else if (key == "Order" && fields >> tick >> pos)
+            tick_log[tick].orders.push_back(pos);
+        else if (key == "Assign" && fields >> tick >> worker >> pos)
+            tick_log[tick].assignments.push_back(std::make_pair(worker, pos));
+        else
+            throw("Invalid line in replay log.");
+
+        if (fields.fail())
+            throw("Invalid line in replay log.");
+    }
+}
+
+/**
+ * Writes the replay log to a file, in tick order. Within a tick, the orders
+ * come before the assignments, each in the order they were recorded.
+ *
+ * @param file The file to write to.
+ */
+void ReplayLog::save(std::string file)
+{
+    std::ofstream out(file);
+    if (!out)
+        throw("Cannot write replay log.");
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    out << MAGIC << " " << VERSION << "\n";
+    out << "Seed " << seed << "\n";
+    out << "SchedulerSeed " << scheduler_seed << "\n";
+    out << "Ticks " << ticks << "\n";
+
+    for (auto& entry : tick_log)
+    {
+        for (auto& pos : entry.second.orders)
+            out << "Order " << entry.first << " " << pos << "\n";
+        for (auto& assignment : entry.second.assignments)
+        {
+            out << "Assign " << entry.first << " " << assignment.first << " "
+                << assignment.second << "\n";
+        }
+    }
+}
+
+/**
+ * Records an order generated in a tick.
+ *
+ * @param tick The tick the order was generated in.
+ * @param pos The position of the order.
+ */
+void ReplayLog::add_order(long tick, int pos)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    tick_log[tick].orders.push_back(pos);
+}
+
+/**
+ * Records an order assigned to a worker in a tick.
+ *
+ * @param tick The tick the order was assigned in.
+ * @param worker The ID of the worker.
+ * @param pos The position of the order.
+ */
+void ReplayLog::add_assignment(long tick, int worker, int pos)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    tick_log[tick].assignments.push_back(std::make_pair(worker, pos));
+}
+
+/**
+ * Returns the orders assigned in a tick, in the order they were assigned.
+ *
+ * @param tick The tick.
+ *
+ * @return The ID of the worker and the position of each order.
+ */
+std::vector<std::pair<int,int>> ReplayLog::get_assignments(long tick)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = tick_log.find(tick);
+    if (it == tick_log.end())
+        return {};
+
+    return it->second.assignments;
+}
+
+/**
+ * Set the seed the simulation's random number generators were seeded from.
+ *
+ * @param seed The seed.
+ */
+void ReplayLog::set_seed(unsigned int seed)
+{
+    this->seed = seed;
+}
+
+/**
+ * Returns the seed the simulation's random number generators were seeded
+ * from.
+ */
+unsigned int ReplayLog::get_seed()
+{
+    return seed;
+}
+
+/**
+ * Set the seed of the scheduler's random number generator.
+ *
+ * @param seed The seed.
+ */
+void ReplayLog::set_scheduler_seed(unsigned int seed)
+{
+    this->scheduler_seed = seed;
+}
+
+/**
+ * Returns the seed of the scheduler's random number generator.
+ */
+unsigned int ReplayLog::get_scheduler_seed()
+{
+    return scheduler_seed;
+}
+
+/**
+ * Set the number of ticks the scheduler simulated.
+ *
+ * @param ticks The number of ticks.
+ */
+void ReplayLog::set_ticks(long ticks)
+{
+    this->ticks = ticks;
+}
+
+/**
+ * Returns the number of ticks the scheduler simulated.
+ */
+long ReplayLog::get_ticks()
+{
+    return ticks;
+}
@@ -0,0 +1,89 @@
+#ifndef SIM_REPLAY_REPLAY_LOG_H
+#define SIM_REPLAY_REPLAY_LOG_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Records what the order generator and the dispatcher did in each tick of a
+ * simulation, along with the seeds of its random number generators, so that
+ * the run can be replayed without them. A replay feeds the recorded dispatch
+ * decisions to the scheduler alone, which makes it deterministic however the
+ * threads of the recorded run were interleaved.
+ *
+ * The log is a text file with one event per line, in tick order, so that two
+ * logs can be compared with diff:
+ *
+ *     WaresimReplay 2
+ *     Seed 1000
+ *     SchedulerSeed 1804289383
+ *     Ticks 600
+ *     Order 3 417
+ *     Assign 4 2 417
+ *
+ * An Order line holds the tick and the position of an order, and an Assign
+ * line holds the tick, the ID of the worker and the position of the order it
+ * was assigned. An order is assigned in the tick after the one it was
+ * generated in, before the scheduler starts that tick.
+ */
+class ReplayLog
+{
+    public:
+        ReplayLog();
+        ~ReplayLog();
+
+        // Reads a replay log from a file.
+        void load(std::string);
+        // Writes the replay log to a file.
+        void save(std::string);
+
+        // Records an order generated in a tick.
+        void add_order(long, int);
+        // Records an order assigned to a worker in a tick.
+        void add_assignment(long, int, int);
+        // Returns the orders assigned in a tick, with their workers.
+        std::vector<std::pair<int,int>> get_assignments(long);
+
+        // Set the seed of the simulation.
+        void set_seed(unsigned int);
+        // Returns the seed of the simulation.
+        unsigned int get_seed();
+        // Set the seed of the scheduler.
+        void set_scheduler_seed(unsigned int);
+        // Returns the seed of the scheduler.
+        unsigned int get_scheduler_seed();
+        // Set the number of ticks simulated.
+        void set_ticks(long);
+        // Returns the number of ticks simulated.
+        long get_ticks();
+    private:
+        // What happened in a tick.
+        struct Tick
+        {
+            // The positions of the orders generated.
+            std::vector<int> orders{};
+            // The ID of the worker and the position of each order assigned.
+            std::vector<std::pair<int,int>> assignments{};
+        };
+
+        // The ticks in which something happened.
+        std::map<long, Tick> tick_log{};
+        // The seed of the simulation.
+        unsigned int seed = 0;
+        // The seed of the scheduler's random number generator.
+        unsigned int scheduler_seed = 0;
+        // The number of ticks simulated.
+        long ticks = 0;
+        // The order generator and the dispatcher record at the same time.
+        std::mutex mutex;
+
+        // The name at the start of every replay log.
+        static const std::string MAGIC;
+        // The version of the format.
+        static const int VERSION = 2;
+};
+
+#endif
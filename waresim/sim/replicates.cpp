@@ -0,0 +1,302 @@
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "event_engine.h"
+#include "replicates.h"
+#include "../logger/logger.h"
+
+/**
+ * Constructor. Parses the warehouse that every replicate starts from.
+ *
+ * @param warehouse_file The file containing the warehouse representation.
+ */
+Replicates::Replicates(std::string warehouse_file)
+{
+    this->warehouse = Warehouse::parse_default_warehouse(warehouse_file);
+}
+
+/**
+ * Destructor.
+ */
+Replicates::~Replicates()
+{
+
+}
+
+/**
+ * Adds a replicate. The algorithms must not be shared with another replicate,
+ * since replicates run at the same time, and should be seeded differently.
+ * This object does not take ownership of them.
+ *
+ * @param algos The algorithms the replicate is simulated with.
+ */
+void Replicates::add(Algos algos)
+{
+    this->algos.push_back(algos);
+}
+
+/**
+ * Runs every replicate, as many at a time as the thread pool has threads, and
+ * reports the results once they have all finished.
+ */
+void Replicates::run()
+{
+    if (ticks <= 0)
+        throw("Replicates need a number of ticks to simulate.");
+
+    metrics.assign(algos.size(), Metrics());
+
+    // Every replicate needs the distances to the drop locations. The distances
+    // to the bins are shared as the replicates find them.
+    distances.precompute(&warehouse, warehouse.get_drops(), thread_pool);
+
+    auto run_range = [this](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+            run_one(i);
+    };
+
+    if (thread_pool == nullptr)
+        run_range(0, algos.size());
+    else
+        thread_pool->parallel_for(0, algos.size(), 1, run_range);
+
+    report();
+}
+
+/**
+ * Simulates a replicate on the calling thread.
+ *
+ * @param index The index of the replicate.
+ */
+void Replicates::run_one(int index)
+{
+    if (origin != nullptr)
+    {
+        metrics[index] = simulate_fork(*origin, algos[index], ticks,
+                decay_factor);
+        return;
+    }
+
+    metrics[index] = simulate(warehouse, algos[index], ticks, decay_factor,
+            checkpoint);
+}
+
+/**
+ * Simulates a copy of a warehouse headless on the event engine, on the
+ * calling thread, and returns what happened. The copy shares the warehouse's
+ * layout and starts from the same state.
+ *
+ * @param warehouse The warehouse to simulate.
+ * @param algos The algorithms to simulate it with.
+ * @param ticks The number of ticks to simulate.
+ * @param decay_factor The decay factor for windows.
+ * @param checkpoint The data of a checkpoint to continue from instead, or
+ * empty. The algorithms keep their own state and seeds.
+ */
+Metrics Replicates::simulate(const Warehouse& warehouse, Algos algos,
+        long ticks, double decay_factor, const std::string& checkpoint)
+{
+    Warehouse copy = warehouse;
+
+    // Only the number of ticks limits the simulation.
+    EventEngine engine(time(nullptr), 0);
+    engine.set_warehouse(&copy);
+    engine.set_order_algo(algos.order_algo);
+    engine.set_dispatch_algo(algos.dispatch_algo);
+    engine.set_routing_algo(algos.routing_algo);
+    engine.set_path_algo(algos.path_algo);
+    engine.set_contention_algo(algos.contention_algo);
+    engine.set_ticks(ticks);
+    engine.set_wait_time(0);
+
+    if (!checkpoint.empty())
+    {
+        CheckpointReader reader(checkpoint);
+        engine.restore(reader, false);
+    }
+    copy.set_decay_factor(decay_factor);
+
+    engine.simulate();
+
+    return engine.get_metrics();
+}
+
+/**
+ * Simulates a fork of a simulation headless on the event engine, on the
+ * calling thread, and returns what happened. The fork shares the layout of
+ * the simulation's warehouse and continues from where the simulation stopped.
+ * Several forks of the same simulation can be simulated at once.
+ *
+ * @param origin The simulation to fork, which must have finished.
+ * @param algos The algorithms to simulate the fork with. They keep their own
+ * state and seeds.
+ * @param ticks The number of ticks to simulate, counting from the start of
+ * the simulation that is forked.
+ * @param decay_factor The decay factor for windows.
+ */
+Metrics Replicates::simulate_fork(Simulation& origin, Algos algos, long ticks,
+        double decay_factor)
+{
+    std::unique_ptr<Simulation> branch(origin.fork(false));
+    branch->set_order_algo(algos.order_algo);
+    branch->set_dispatch_algo(algos.dispatch_algo);
+    branch->set_routing_algo(algos.routing_algo);
+    branch->set_path_algo(algos.path_algo);
+    branch->set_contention_algo(algos.contention_algo);
+    branch->set_planning_algo(nullptr);
+    branch->set_ticks(ticks);
+    branch->set_decay_factor(decay_factor);
+    branch->set_wait_time(0);
+
+    return branch->simulate();
+}
+
+/**
+ * Logs the metrics of each replicate, followed by the mean of each metric
+ * over the replicates and its 95% confidence interval. The report is written
+ * to replicates.txt in the log directory and to the standard output.
+ */
+void Replicates::report()
+{
+    Logger logger;
+    logger.set_up(log_dir + "replicates.txt");
+
+    std::vector<std::string> names = metric_names();
+    std::vector<std::vector<double>> columns(names.size());
+
+    for (std::size_t i = 0; i < metrics.size(); i++)
+    {
+        std::vector<double> values = metric_values(metrics[i]);
+
+        std::string log_msg{"Replicate "};
+        log_msg.append(std::to_string(i));
+        log_msg.append(":");
+        for (std::size_t j = 0; j < names.size(); j++)
+        {
+            log_msg.append(" ");
+            log_msg.append(names[j]);
+            log_msg.append(" ");
+            log_msg.append(metric_to_string(values[j]));
+            columns[j].push_back(values[j]);
+        }
+        logger.log(log_msg);
+        std::cout << log_msg << std::endl;
+    }
+
+    for (std::size_t j = 0; j < names.size(); j++)
+    {
+        double mean, half_width;
+        confidence_interval(columns[j], &mean, &half_width);
+
+        std::string log_msg{names[j]};
+        log_msg.append(": mean ");
+        log_msg.append(metric_to_string(mean));
+        if (metrics.size() > 1)
+        {
+            log_msg.append(", 95% CI [");
+            log_msg.append(metric_to_string(mean - half_width));
+            log_msg.append(", ");
+            log_msg.append(metric_to_string(mean + half_width));
+            log_msg.append("]");
+        }
+
+        logger.log(log_msg);
+        std::cout << log_msg << std::endl;
+    }
+}
+
+/**
+ * Returns the metrics of each replicate, in the order they were added. Only
+ * complete once run() has returned.
+ */
+std::vector<Metrics> Replicates::get_metrics()
+{
+    return metrics;
+}
+
+/**
+ * Returns the distance cache shared by the replicates, which their algorithms
+ * should be given so that each distance is computed once.
+ */
+DistanceCache *Replicates::get_distance_cache()
+{
+    return &distances;
+}
+
+/**
+ * Set the number of ticks each replicate simulates. Must be set before the
+ * replicates are run.
+ *
+ * @param ticks The number of ticks.
+ */
+void Replicates::set_ticks(long ticks)
+{
+    this->ticks = ticks;
+}
+
+/**
+ * Set the decay factor for windows.
+ *
+ * @param d The new decay factor.
+ */
+void Replicates::set_decay_factor(double d)
+{
+    this->decay_factor = d;
+}
+
+/**
+ * Set the thread pool the replicates run on. Without one they run one after
+ * another.
+ *
+ * @param pool The thread pool to use.
+ */
+void Replicates::set_thread_pool(ThreadPool *pool)
+{
+    this->thread_pool = pool;
+}
+
+/**
+ * Set the log file directory.
+ *
+ * @param dir The log file directory to use.
+ */
+void Replicates::set_log_dir(std::string dir)
+{
+    this->log_dir = dir;
+    log_dir.append("/");
+}
+
+/**
+ * Set the checkpoint every replicate continues from, instead of the parsed
+ * warehouse. The warehouse and the pending events come from the checkpoint,
+ * while each replicate's algorithms keep their own seeds. The number of ticks
+ * counts from the start of the simulation that wrote the checkpoint.
+ *
+ * @param file The checkpoint file.
+ */
+void Replicates::set_restore(std::string file)
+{
+    this->checkpoint = CheckpointReader::load(file);
+
+    CheckpointReader reader(checkpoint);
+    this->warehouse = Warehouse::load(reader);
+}
+
+/**
+ * Set the simulation every replicate forks from, instead of starting from the
+ * parsed warehouse. The simulation must have been run by the event engine and
+ * finished, and must outlive the replicates. Each replicate's algorithms keep
+ * their own seeds, and the number of ticks counts from the start of the
+ * simulation that is forked.
+ *
+ * @param origin The simulation to fork.
+ */
+void Replicates::set_origin(Simulation *origin)
+{
+    this->origin = origin;
+    this->warehouse = origin->get_warehouse();
+}
@@ -0,0 +1,103 @@
+#ifndef SIM_REPLICATES_H
+#define SIM_REPLICATES_H
+
+#include <string>
+#include <vector>
+
+#include "algo/contention/contention_algo.h"
+#include "algo/dispatch/dispatch_algo.h"
+#include "algo/ordering/order_algo.h"
+#include "algo/path/distance_cache.h"
+#include "algo/path/path_algo.h"
+#include "algo/routing/routing_algo.h"
+#include "concurrent/thread_pool.h"
+#include "metrics.h"
+#include "simulation.h"
+#include "warehouse.h"
+
+/**
+ * Runs several independent simulations of the same warehouse at once, each
+ * with its own algorithms and seeds, and reports their metrics along with the
+ * mean and a 95% confidence interval for each metric.
+ *
+ * The warehouse is parsed once. Each replicate simulates a copy of it, which
+ * shares the immutable layout, and the distance cache is shared by all the
+ * replicates. The replicates run headless on the event engine for a fixed
+ * number of ticks, spread over the threads of the thread pool.
+ *
+ * The replicates can also all continue from the same checkpoint, for example
+ * one taken after a warm up, in which case they only differ from there on,
+ * or all fork from the same simulation that has been run for a while.
+ */
+class Replicates
+{
+    public:
+        Replicates(std::string);
+        ~Replicates();
+
+        // The algorithms a replicate is simulated with.
+        struct Algos
+        {
+            OrderAlgo *order_algo = nullptr;
+            DispatchAlgo *dispatch_algo = nullptr;
+            RoutingAlgo *routing_algo = nullptr;
+            PathAlgo *path_algo = nullptr;
+            ContentionAlgo *contention_algo = nullptr;
+        };
+
+        // Adds a replicate that uses the given algorithms.
+        void add(Algos);
+        // Runs every replicate and reports the results.
+        void run();
+        // Returns the metrics of each replicate.
+        std::vector<Metrics> get_metrics();
+        // Returns the distance cache shared by the replicates.
+        DistanceCache *get_distance_cache();
+
+        // Simulates a copy of a warehouse with the given algorithms.
+        static Metrics simulate(const Warehouse&, Algos, long, double,
+                const std::string&);
+        // Simulates a fork of a simulation with the given algorithms.
+        static Metrics simulate_fork(Simulation&, Algos, long, double);
+
+        // Set the number of ticks each replicate simulates.
+        void set_ticks(long);
+        // Set the decay factor.
+        void set_decay_factor(double);
+        // Set the thread pool.
+        void set_thread_pool(ThreadPool *);
+        // Set the log file directory.
+        void set_log_dir(std::string dir);
+        // Set the checkpoint the replicates continue from.
+        void set_restore(std::string);
+        // Set the simulation the replicates fork from.
+        void set_origin(Simulation *);
+    private:
+        // Simulates one replicate.
+        void run_one(int);
+        // Logs the metrics of each replicate and their summary.
+        void report();
+
+        // The parsed warehouse that every replicate starts from.
+        Warehouse warehouse;
+        // Distances shared by the replicates' algorithms.
+        DistanceCache distances;
+        // The algorithms of each replicate.
+        std::vector<Algos> algos{};
+        // The metrics of each replicate, once run.
+        std::vector<Metrics> metrics{};
+        // The number of ticks each replicate simulates.
+        long ticks = 0;
+        // The decay factor for windows.
+        double decay_factor = 0.9;
+        // The thread pool the replicates run on, if any.
+        ThreadPool *thread_pool = nullptr;
+        // The log file directory.
+        std::string log_dir;
+        // The data of the checkpoint the replicates continue from, or empty.
+        std::string checkpoint{};
+        // The simulation the replicates fork from, if any.
+        Simulation *origin = nullptr;
+};
+
+#endif
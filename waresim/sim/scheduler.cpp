@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <ctime>
+#include <unordered_map>
+#include <utility>
 
 #include "constants.h"
 #include "scheduler.h"
@@ -33,234 +35,722 @@ int Scheduler::rand_int(int i)
 void Scheduler::run()
 {
     // Will be used for logging purposes.
-    std::string log_msg;
     std::string log_iter_end = std::string("=====");
 
-    // Continue simulation until sim_length seconds have elapsed.
-    while (difftime(time(nullptr), start_time) < sim_length)
+    // The number of ticks simulated so far.
+    long tick = 0;
+
+    // A replay simulates the recorded number of ticks however long it takes.
+    if (replay != nullptr)
+        ticks = replay->get_ticks();
+
+    // Continue simulation until sim_length seconds have elapsed. In the
+    // pipelined mode the scheduler is the only stage that decides when to
+    // stop, and the other stages stop when their queues are closed.
+    while ((replay != nullptr ||
+                difftime(time(nullptr), start_time) < sim_length) &&
+            (ticks == 0 || tick < ticks))
     {
-        // Get the warehouse workers.
-        std::vector<Worker>& workers = warehouse->get_workers();
+        // Wait until the dispatcher has assigned the orders of this tick, so
+        // the workers are never assigned while they are being scheduled.
+        barrier->pass();
+
+        // Only the active workers are scheduled. Idle workers are woken up
+        // when they are assigned an order.
+        wake_workers();
+
+        // Give the workers the orders the dispatcher assigned in this tick of
+        // the recorded run.
+        if (replay != nullptr)
+            replay_assignments(tick);
+
+        // Give the workers the orders the pipelined dispatcher assigned for
+        // this tick.
+        if (assignment_queue != nullptr && !apply_assignments())
+            break;
+
+        // Let the contention algorithm know a new iteration has started.
+        contention_algo->new_iteration(warehouse);
+
+        // Plan the workers in congested areas.
+        if (planning_algo != nullptr)
+            planning_algo->plan(warehouse, &logger);
 
         // Create a randomized scheduling order. This simulates a bunch of
         // multithreaded workers.
-        std::vector<int> sched_order{};
-        int i = 0;
-        for (auto &worker : workers)
-        {
-            sched_order.push_back(i);
-            i++;
-        }
+        std::vector<int> sched_order = active;
         // Randomly shuffle the order.
         std::shuffle(sched_order.begin(), sched_order.end(), rand.get_urng());
         
-        // Get the warehouse layout.
-        auto layout = warehouse->get_layout();
+        // Find the paths of all the workers that need one at once, so that
+        // they can be found in parallel.
+        find_paths(sched_order);
 
-        // We now have a random order in which to process the workers. We
-        // will process each worker once. Processing means moving (or deciding
-        // not to move) each worker one unit in the warehouse.
-        for (auto &index : sched_order)
+        // We now have a random order in which to process the workers. In
+        // two-phase mode all the moves are collected first and then made
+        // together, otherwise the workers move one by one.
+        if (two_phase)
+            two_phase_step(sched_order);
+        else
+            sequential_step(sched_order);
+
+        retire_workers();
+
+        // Tell that warehouse that we have finished processing all workers.
+        warehouse->update_iteration();
+
+        logger.log(log_iter_end);
+
+        if (view_snapshots != nullptr)
+            view_snapshots->publish(tick, warehouse);
+
+        // Let the pipelined dispatcher see the workers after this tick.
+        if (snapshot_queue != nullptr)
+            snapshot_queue->push(warehouse->get_worker_state());
+
+        barrier->arrive();
+        tick++;
+    }// End while loop
+
+    if (recorder != nullptr)
+        recorder->set_ticks(tick);
+    if (view_snapshots != nullptr)
+        view_snapshots->finish();
+
+    // Stop the other stages of the pipeline.
+    if (assignment_queue != nullptr)
+    {
+        assignment_queue->close();
+        snapshot_queue->close();
+    }
+}
+
+/**
+ * Pops the orders assigned for this tick in the pipelined mode, gives them to
+ * their workers and wakes the workers up.
+ *
+ * @return False if the dispatcher has stopped.
+ */
+bool Scheduler::apply_assignments()
+{
+    std::vector<Worker>& workers = warehouse->get_workers();
+
+    std::vector<std::pair<int,Order>> assignments{};
+    if (!assignment_queue->pop(assignments))
+        return false;
+
+    for (auto& assignment : assignments)
+    {
+        int index = id_to_index[assignment.first];
+        workers[index].assign(assignment.second);
+        wake(index);
+    }
+
+    return true;
+}
+
+/**
+ * Gives the workers the orders that were assigned to them in a tick of the
+ * recorded run, and wakes them up. The dispatcher of the recorded run assigned
+ * them before the scheduler started the tick, so they are given their orders
+ * at the start of the same one.
+ *
+ * @param tick The tick of the recorded run.
+ */
+void Scheduler::replay_assignments(long tick)
+{
+    std::vector<Worker>& workers = warehouse->get_workers();
+
+    for (auto& assignment : replay->get_assignments(tick))
+    {
+        auto it = id_to_index.find(assignment.first);
+        if (it == id_to_index.end())
+            throw("The replay log does not match the warehouse.");
+
+        workers[it->second].assign(Order(assignment.second));
+        wake(it->second);
+    }
+}
+
+/**
+ * Routes the workers that are not routed and finds the paths of the workers
+ * that do not have one, before any worker moves. Routing and pathfinding only
+ * depend on the warehouse layout and on the worker itself, so this gives the
+ * same paths as finding them one worker at a time, but the path algorithm
+ * gets the whole batch and can spread it over the thread pool.
+ *
+ * @param sched_order The order in which to process the workers.
+ */
+void Scheduler::find_paths(std::vector<int>& sched_order)
+{
+    std::vector<Worker>& workers = warehouse->get_workers();
+
+    // The start and end of each path to find, and the worker it is for.
+    std::vector<std::pair<int,int>> queries{};
+    std::vector<int> owners{};
+
+    for (auto &index : sched_order)
+    {
+        Worker& worker = workers[index];
+
+        if (!worker.is_routed())
+            routing_algo->route_worker(warehouse, worker);
+
+        if (worker.get_path().empty())
         {
-            Worker& worker = workers[index]; 
+            queries.push_back(std::make_pair(worker.get_pos(),
+                        worker.get_current_dest()));
+            owners.push_back(index);
+        }
+    }
+
+    auto paths = path_algo->find_all(warehouse, queries, thread_pool);
+    for (std::size_t i = 0; i < owners.size(); i++)
+        workers[owners[i]].set_path(paths[i]);
+}
+
+/**
+ * Processes each worker once, one by one in the scheduling order. A worker
+ * whose next position is occupied is handed to the contention algorithm.
+ *
+ * @param sched_order The order in which to process the workers.
+ */
+void Scheduler::sequential_step(std::vector<int>& sched_order)
+{
+    // Will be used for logging purposes.
+    std::string log_msg;
+
+    // Get the warehouse workers.
+    std::vector<Worker>& workers = warehouse->get_workers();
 
+    // Get the warehouse layout.
+    const std::vector<int>& layout = warehouse->get_layout();
+
+    // The worker at each position.
+    WorkerIndex& occupancy = warehouse->get_worker_index();
+
+    // We now have a random order in which to process the workers. We
+    // will process each worker once. Processing means moving (or deciding
+    // not to move) each worker one unit in the warehouse.
+    for (auto &index : sched_order)
+    {
+        Worker& worker = workers[index]; 
+
+        // Log message.
+        log_msg = std::string{"Scheduling worker: "};
+        log_msg.append(std::to_string(worker.get_id()));
+        logger.log(log_msg);
+
+        // If worker is not on a path, try apply routing policy.
+        if (!worker.is_routed())
+        {
             // Log message.
-            log_msg = std::string{"Scheduling worker: "};
+            log_msg = std::string{"Worker "};
             log_msg.append(std::to_string(worker.get_id()));
+            log_msg.append(" is NOT routed.");
             logger.log(log_msg);
 
-            // If worker is not on a path, try apply routing policy.
-            if (!worker.is_routed())
+            // Route the worker.
+            routing_algo->route_worker(warehouse, worker);
+        }
+        else
+        {
+            // Log message.
+            log_msg = std::string{"Worker "};
+            log_msg.append(std::to_string(worker.get_id()));
+            log_msg.append(" is routed already.");
+        }
+
+        // If worker does not have a path, calculate one. 
+        if (worker.get_path().empty())
+        {
+            worker.set_path( 
+                    path_algo->find(warehouse, worker.get_pos(), 
+                        worker.get_current_dest()));
+        }
+
+        // Get the path for the worker we are scheduling.
+        auto path = worker.get_path();
+
+        // Check if path is empty - that means this worker was
+        // assigned to a bin it is currently on!
+        if (path.empty())
+        {
+            worker.set_routed(false);
+
+            // Update to 'drop off ready' if we reached a bin location.
+            if (layout[worker.get_pos()] == BIN_LOC)
             {
-                // Log message.
-                log_msg = std::string{"Worker "};
-                log_msg.append(std::to_string(worker.get_id()));
-                log_msg.append(" is NOT routed.");
-                logger.log(log_msg);
-
-                // Route the worker.
-                routing_algo->route_worker(warehouse, worker);
+                worker.reached_order();
+                worker.set_drop_status(true);
             }
-            else
+            // Update to 'not drop off ready' if we reached a drop off
+            // location.
+            if (layout[worker.get_pos()] == DROP_LOC)
             {
-                // Log message.
-                log_msg = std::string{"Worker "};
-                log_msg.append(std::to_string(worker.get_id()));
-                log_msg.append(" is routed already.");
+                worker.drop_off();
+                worker.set_drop_status(false);
             }
 
-            // If worker does not have a path, calculate one. 
-            if (worker.get_path().empty())
+            continue;
+        }
+
+        // Get the next position.
+        int next_pos = path[0];
+        // Get the old position.
+        int curr_pos = worker.get_pos(); 
+
+        /*
+         * Check for collisions.
+         */
+
+        int height = warehouse->get_height();
+        int width = warehouse->get_width();
+
+        // Marks whether we can move in this position, if the position
+        // we want to move the worker in is already occupied AND if the
+        // worker has a smaller ID than the other worker.
+        bool right_valid = false;
+        bool left_valid = false;
+        bool top_valid = false;
+        bool bot_valid = false;
+
+        // Top neighbor.
+        if (((curr_pos / width) != (height-1)) && (layout[curr_pos+width] == EMPTY_LOC))
+            top_valid = true;
+        // Bottom neighbor.
+        if ((curr_pos >= width) && (layout[curr_pos-width] == EMPTY_LOC))
+            bot_valid = true;
+        // Left neighbor.
+        if (((curr_pos % width) != 0) && (layout[curr_pos-1] == EMPTY_LOC))
+            left_valid = true;
+        // Right neighbor.
+        if ((((curr_pos+1) % width) != 0) && (layout[curr_pos+1] == EMPTY_LOC))
+            right_valid = true;
+
+        // We determined which position we could move in if there is a
+        // contention for our next spot, but now we also want to check that
+        // these position are not occupied themselves.
+        if (top_valid && occupancy.get_worker(curr_pos+width) != -1)
+            top_valid = false;
+        if (bot_valid && occupancy.get_worker(curr_pos-width) != -1)
+            bot_valid = false;
+        if (left_valid && occupancy.get_worker(curr_pos-1) != -1)
+            left_valid = false;
+        if (right_valid && occupancy.get_worker(curr_pos+1) != -1)
+            right_valid = false;
+
+        // Check if the position we intend to move to next already has a
+        // worker on it. A path may repeat the current position, which means
+        // the worker waits there.
+        int next_pos_worker = -1;
+        if (next_pos != curr_pos)
+            next_pos_worker = occupancy.get_worker(next_pos);
+        bool next_pos_taken = (next_pos_worker != -1);
+
+        // Warehouse position is already occupied.
+        if (next_pos_taken)
+        {
+            // Log some details.
+            log_msg = std::string{"Worker # "};
+            log_msg.append(std::to_string(index));
+            log_msg.append("'s next position is taken.");
+            logger.log(log_msg);
+
+            contention_algo->handle(worker, workers[next_pos_worker], warehouse,
+                        top_valid, bot_valid, left_valid, right_valid, &logger);
+            continue;
+        }
+        else // Warehouse position is not occupied.
+        { 
+            // Set the worker's current position.
+            worker.set_pos(next_pos);
+            // Update and set the path.
+            path.erase(path.begin());
+            worker.set_path(path);
+            // Update the warehouse layout.
+            warehouse->move_worker(curr_pos, next_pos);
+
+            log_msg = std::string{"Moving worker # "}; 
+            log_msg.append(std::to_string(index));
+            log_msg.append(" to position: ");
+            log_msg.append(std::to_string(next_pos));
+            logger.log(log_msg);
+        }
+
+        // Update to 'not routed' if we have reached destination.
+        if (path.empty())
+        {
+            worker.set_routed(false);
+
+            // Update to 'drop off ready' if we reached a bin location.
+            if (warehouse->get_layout()[next_pos] == BIN_LOC)
             {
-                worker.set_path( 
-                        path_algo->find(warehouse, worker.get_pos(), 
-                            worker.get_current_dest()));
+                worker.reached_order();
+                worker.set_drop_status(true);
             }
+            // Update to 'not drop off ready' if we reached a drop off
+            // location.
+            if (warehouse->get_layout()[next_pos] == DROP_LOC)
+            {
+                worker.drop_off();
+                worker.set_drop_status(false);
+            }
+        }
 
-            // Get the path for the worker we are scheduling.
-            auto path = worker.get_path();
+    }// End worker for loop
+}
+
+/**
+ * Updates a worker that has reached the end of its path. Reaching a bin picks
+ * up the current order and reaching a drop off location drops off the picked
+ * orders.
+ *
+ * @param worker The worker.
+ * @param layout The warehouse layout.
+ */
+void Scheduler::reached_dest(Worker& worker, const std::vector<int>& layout)
+{
+    worker.set_routed(false);
+
+    // Update to 'drop off ready' if we reached a bin location.
+    if (layout[worker.get_pos()] == BIN_LOC)
+    {
+        worker.reached_order();
+        worker.set_drop_status(true);
+    }
+    // Update to 'not drop off ready' if we reached a drop off location.
+    if (layout[worker.get_pos()] == DROP_LOC)
+    {
+        worker.drop_off();
+        worker.set_drop_status(false);
+    }
+}
+
+/**
+ * Adds the workers that were assigned orders since the last iteration to the
+ * active workers. Every worker starts out active. Without a wake queue idle
+ * workers are never retired, so every worker is scheduled every iteration.
+ */
+void Scheduler::wake_workers()
+{
+    std::vector<Worker>& workers = warehouse->get_workers();
+
+    if (is_active.size() != workers.size())
+    {
+        active.clear();
+        is_active.assign(workers.size(), true);
+        id_to_index.clear();
+        for (std::size_t i = 0; i < workers.size(); i++)
+        {
+            active.push_back(i);
+            id_to_index[workers[i].get_id()] = i;
+        }
+    }
+
+    if (wake_queue == nullptr)
+        return;
+
+    for (auto& id : wake_queue->drain())
+        wake(id_to_index[id]);
+}
+
+/**
+ * Adds a worker to the active workers if it is not already active.
+ *
+ * @param index The index of the worker.
+ */
+void Scheduler::wake(int index)
+{
+    if (!is_active[index])
+    {
+        is_active[index] = true;
+        active.push_back(index);
+    }
+}
+
+/**
+ * Removes the workers that have nothing to do from the active workers, so
+ * that the cost of an iteration depends on the number of busy workers only.
+ * A worker is woken up again through the wake queue.
+ */
+void Scheduler::retire_workers()
+{
+    if (wake_queue == nullptr)
+        return;
+
+    std::vector<Worker>& workers = warehouse->get_workers();
 
-            // Check if path is empty - that means this worker was
-            // assigned to a bin it is currently on!
+    std::size_t kept = 0;
+    for (auto& index : active)
+    {
+        if (is_idle(workers[index]))
+            is_active[index] = false;
+        else
+            active[kept++] = index;
+    }
+    active.resize(kept);
+
+    std::string log_msg{"Active workers: "};
+    log_msg.append(std::to_string(active.size()));
+    logger.log(log_msg);
+}
+
+/**
+ * Returns true if the worker has no orders, no path and is parked at its
+ * initial position. Scheduling such a worker would only route it back to the
+ * position it is already on.
+ *
+ * @param worker The worker.
+ */
+bool Scheduler::is_idle(Worker& worker)
+{
+    return !worker.is_routed() && worker.get_load() == 0 &&
+        worker.get_path().empty() &&
+        worker.get_pos() == worker.get_initial_pos();
+}
+
+/**
+ * Processes each worker once in two phases. The first phase routes the
+ * workers and collects the position each one wants to move to. The second
+ * phase decides which moves can be made using the occupancy in the worker
+ * index: a worker can move into an empty position, or into a position whose
+ * worker is moving on, so whole trains of workers advance together, and
+ * cycles of workers (including two workers swapping) rotate together. When
+ * several workers want the same position, the first in the scheduling order
+ * gets it. All the moves are then made at once, and the workers that could
+ * not move are handed to the contention algorithm.
+ *
+ * @param sched_order The order in which to process the workers.
+ */
+void Scheduler::two_phase_step(std::vector<int>& sched_order)
+{
+    // Will be used for logging purposes.
+    std::string log_msg;
+
+    std::vector<Worker>& workers = warehouse->get_workers();
+    WorkerIndex& occupancy = warehouse->get_worker_index();
+    const std::vector<int>& layout = warehouse->get_layout();
+    int height = warehouse->get_height();
+    int width = warehouse->get_width();
+
+    /*
+     * Phase one: collect the intended moves.
+     */
+
+    // The position each worker wants to move to, or -1.
+    std::vector<int> targets(workers.size(), -1);
+    // The workers that want each position, in the scheduling order.
+    std::unordered_map<int,std::vector<int>> claims{};
+
+    for (auto &index : sched_order)
+    {
+        Worker& worker = workers[index];
+
+        // Log message.
+        log_msg = std::string{"Scheduling worker: "};
+        log_msg.append(std::to_string(worker.get_id()));
+        logger.log(log_msg);
+
+        // If worker is not on a path, try apply routing policy.
+        if (!worker.is_routed())
+            routing_algo->route_worker(warehouse, worker);
+
+        // If worker does not have a path, calculate one.
+        if (worker.get_path().empty())
+        {
+            worker.set_path(
+                    path_algo->find(warehouse, worker.get_pos(),
+                        worker.get_current_dest()));
+        }
+
+        auto path = worker.get_path();
+
+        // The worker is already at its destination.
+        if (path.empty())
+        {
+            reached_dest(worker, layout);
+            continue;
+        }
+
+        // The worker waits in place for this iteration.
+        if (path[0] == worker.get_pos())
+        {
+            path.erase(path.begin());
+            worker.set_path(path);
+            warehouse->move_worker(worker.get_pos(), worker.get_pos());
             if (path.empty())
-            {
-                worker.set_routed(false);
+                reached_dest(worker, layout);
+            continue;
+        }
 
-                // Update to 'drop off ready' if we reached a bin location.
-                if (layout[worker.get_pos()] == BIN_LOC)
-                {
-                    worker.reached_order();
-                    worker.set_drop_status(true);
-                }
-                // Update to 'not drop off ready' if we reached a drop off
-                // location.
-                if (layout[worker.get_pos()] == DROP_LOC)
-                {
-                    worker.drop_off();
-                    worker.set_drop_status(false);
-                }
+        targets[index] = path[0];
+        claims[path[0]].push_back(index);
+    }
+
+    /*
+     * Phase two: resolve the moves. Each worker wants to move into at most
+     * one position, so following the worker in the way of each move either
+     * ends at an empty position, ends at a worker that cannot move, or loops
+     * back into a cycle.
+     */
+
+    const char UNKNOWN = 0, VISITING = 1, MOVES = 2, BLOCKED = 3;
+    std::vector<char> state(workers.size(), UNKNOWN);
+
+    // The worker that gets each wanted position. This starts as the first
+    // worker to want it, but if that worker cannot move the position is
+    // passed on to the next one and the moves are resolved again.
+    std::unordered_map<int,std::size_t> winners{};
+    bool changed = true;
+    while (changed)
+    {
+        std::fill(state.begin(), state.end(), UNKNOWN);
 
+        for (auto &index : sched_order)
+        {
+            if (targets[index] == -1 || state[index] != UNKNOWN)
                 continue;
-            }
 
-            // Get the next position.
-            int next_pos = path[0];
-            // Get the old position.
-            int curr_pos = worker.get_pos(); 
-
-            /*
-             * Check for collisions.
-             */
-
-            int height = warehouse->get_height();
-            int width = warehouse->get_width();
-
-            // Marks whether we can move in this position, if the position
-            // we want to move the worker in is already occupied AND if the
-            // worker has a smaller ID than the other worker.
-            bool right_valid = false;
-            bool left_valid = false;
-            bool top_valid = false;
-            bool bot_valid = false;
-
-            // The worker occupying the spot we want to move.
-            // We set this to the curent worker for convenience because we
-            // did not specify a Worker() constructor.
-            Worker next_pos_worker = worker;
-
-            // Top neighbor.
-            if (((curr_pos / height) != (height-1)) && (layout[curr_pos+width] == EMPTY_LOC))
-                top_valid = true;
-            // Bottom neighbor.
-            if ((curr_pos >= width) && (layout[curr_pos-width] == EMPTY_LOC))
-                bot_valid = true;
-            // Left neighbor.
-            if (((curr_pos % width) != 0) && (layout[curr_pos-1] == EMPTY_LOC))
-                left_valid = true;
-            // Right neighbor.
-            if ((((curr_pos+1) % width) != 0) && (layout[curr_pos+1] == EMPTY_LOC))
-                right_valid = true;
-
-            // Is the next position for this worker taken?
-            int next_pos_taken = false;
-
-            // Get the current worker positions.
-            // We determined which position we could move in if there is a
-            // contention for our next spot, but now we also want to check
-            // that these position are not occupied themselves.
-            // We will also check that the next position for this worker is
-            // empty.
-            for (auto it = workers.begin(); it != workers.end(); ++it)
+            std::vector<int> chain{};
+            int curr = index;
+            char result = BLOCKED;
+            while (true)
             {
-                int other_pos = (*it).get_pos();
-
-                // This set of statements will determine which of neighboring
-                // positions currently have a worker on them.
-                if (top_valid && (other_pos == curr_pos+width))
+                if (state[curr] == VISITING)
                 {
-                    top_valid = false;
+                    // The chain looped back on itself, so the cycle rotates.
+                    result = MOVES;
+                    break;
                 }
-                else if (bot_valid && (other_pos == curr_pos-width))
+                if (state[curr] != UNKNOWN)
                 {
-                    bot_valid = false; 
+                    result = state[curr];
+                    break;
                 }
-                else if (left_valid && (other_pos == curr_pos-1))
+
+                state[curr] = VISITING;
+                chain.push_back(curr);
+
+                // Another worker gets the position.
+                if (claims[targets[curr]][winners[targets[curr]]] != curr)
                 {
-                    left_valid = false;
+                    result = BLOCKED;
+                    break;
                 }
-                else if (right_valid && (other_pos == curr_pos+1))
+
+                int next = occupancy.get_worker(targets[curr]);
+                // The position is empty.
+                if (next == -1)
                 {
-                    right_valid = false;
+                    result = MOVES;
+                    break;
                 }
-
-                // This statement will check if the position we intend to move
-                // to next already has a worker on it.
-                if (next_pos == other_pos)
+                // The worker in the way is not moving.
+                if (targets[next] == -1)
                 {
-                    next_pos_taken = true;
-                    next_pos_worker = *it;
+                    result = BLOCKED;
+                    break;
                 }
+                curr = next;
             }
 
-            // Warehouse position is already occupied.
-            if (next_pos_taken)
-            {
-                // Log some details.
-                log_msg = std::string{"Worker # "};
-                log_msg.append(std::to_string(index));
-                log_msg.append("'s next position is taken.");
-                logger.log(log_msg);
-
-                contention_algo->handle(worker, next_pos_worker, warehouse,
-                            top_valid, bot_valid, left_valid, right_valid, &logger);
-                continue;
-            }
-            else // Warehouse position is not occupied.
-            { 
-                // Set the worker's current position.
-                worker.set_pos(next_pos);
-                // Update and set the path.
-                path.erase(path.begin());
-                worker.set_path(path);
-                // Update the warehouse layout.
-                warehouse->move_worker(curr_pos, next_pos);
-
-                log_msg = std::string{"Moving worker # "}; 
-                log_msg.append(std::to_string(index));
-                log_msg.append(" to position: ");
-                log_msg.append(std::to_string(next_pos));
-                logger.log(log_msg);
-            }
+            for (auto& c : chain)
+                state[c] = result;
+        }
 
-            // Update to 'not routed' if we have reached destination.
-            if (path.empty())
+        // Pass the positions whose workers cannot move on.
+        changed = false;
+        for (auto& claim : claims)
+        {
+            std::size_t& winner = winners[claim.first];
+            if (state[claim.second[winner]] == BLOCKED &&
+                    winner + 1 < claim.second.size())
             {
-                worker.set_routed(false);
-
-                // Update to 'drop off ready' if we reached a bin location.
-                if (warehouse->get_layout()[next_pos] == BIN_LOC)
-                {
-                    worker.reached_order();
-                    worker.set_drop_status(true);
-                }
-                // Update to 'not drop off ready' if we reached a drop off
-                // location.
-                if (warehouse->get_layout()[next_pos] == DROP_LOC)
-                {
-                    worker.drop_off();
-                    worker.set_drop_status(false);
-                }
+                winner++;
+                changed = true;
             }
+        }
+    }
 
-        }// End worker for loop
-
-        // Tell that warehouse that we have finished processing all workers.
-        warehouse->update_iteration();
+    // Make all the moves at once.
+    std::vector<std::pair<int,int>> moves{};
+    for (auto &index : sched_order)
+    {
+        if (state[index] == MOVES)
+            moves.push_back(std::make_pair(workers[index].get_pos(), targets[index]));
+    }
+    warehouse->move_workers(moves);
 
-        logger.log(log_iter_end);
+    for (auto &index : sched_order)
+    {
+        if (state[index] != MOVES)
+            continue;
+
+        Worker& worker = workers[index];
+        auto path = worker.get_path();
+        path.erase(path.begin());
+        worker.set_path(path);
+        worker.set_pos(targets[index]);
+
+        log_msg = std::string{"Moving worker # "};
+        log_msg.append(std::to_string(index));
+        log_msg.append(" to position: ");
+        log_msg.append(std::to_string(targets[index]));
+        logger.log(log_msg);
+
+        // Update to 'not routed' if we have reached destination.
+        if (path.empty())
+            reached_dest(worker, layout);
+    }
+
+    // Hand the workers that could not move to the contention algorithm.
+    for (auto &index : sched_order)
+    {
+        if (state[index] != BLOCKED)
+            continue;
+
+        Worker& worker = workers[index];
+        int curr_pos = worker.get_pos();
+        int next_pos = targets[index];
+
+        log_msg = std::string{"Worker # "};
+        log_msg.append(std::to_string(index));
+        log_msg.append("'s next position is taken.");
+        logger.log(log_msg);
+
+        // The neighbors the worker could back off into.
+        bool top_valid = ((curr_pos / width) != (height-1)) &&
+            (layout[curr_pos+width] == EMPTY_LOC) &&
+            (occupancy.get_worker(curr_pos+width) == -1);
+        bool bot_valid = (curr_pos >= width) &&
+            (layout[curr_pos-width] == EMPTY_LOC) &&
+            (occupancy.get_worker(curr_pos-width) == -1);
+        bool left_valid = ((curr_pos % width) != 0) &&
+            (layout[curr_pos-1] == EMPTY_LOC) &&
+            (occupancy.get_worker(curr_pos-1) == -1);
+        bool right_valid = (((curr_pos+1) % width) != 0) &&
+            (layout[curr_pos+1] == EMPTY_LOC) &&
+            (occupancy.get_worker(curr_pos+1) == -1);
+
+        // Earlier contentions in this loop may have moved the worker that
+        // was in the way.
+        int other = occupancy.get_worker(next_pos);
+        if (other == -1)
+        {
+            auto path = worker.get_path();
+            path.erase(path.begin());
+            worker.set_path(path);
+            worker.set_pos(next_pos);
+            warehouse->move_worker(curr_pos, next_pos);
+            if (path.empty())
+                reached_dest(worker, layout);
+            continue;
+        }
 
-        barrier->arrive();
-    }// End while loop
+        contention_algo->handle(worker, workers[other], warehouse,
+                top_valid, bot_valid, left_valid, right_valid, &logger);
+    }
 }
 
 /**
@@ -333,3 +823,111 @@ void Scheduler::set_contention_algo(ContentionAlgo *algo)
 {
     this->contention_algo = algo;
 }
+
+/**
+ * Set the planning algorithm to use.
+ *
+ * @param algo The planning algorithm to use.
+ */
+void Scheduler::set_planning_algo(PlanningAlgo *algo)
+{
+    this->planning_algo = algo;
+}
+
+/**
+ * Set whether moves are made in two phases. See two_phase_step().
+ *
+ * @param two_phase True to make moves in two phases.
+ */
+void Scheduler::set_two_phase(bool two_phase)
+{
+    this->two_phase = two_phase;
+}
+
+/**
+ * Set the queue of workers that were assigned orders. When set, only the
+ * active workers are scheduled and idle workers wait in the queue.
+ *
+ * @param queue The queue of workers to wake up.
+ */
+void Scheduler::set_wake_queue(WakeQueue *queue)
+{
+    this->wake_queue = queue;
+}
+
+/**
+ * Set the queue of assignments. When set, the scheduler runs in the pipelined
+ * mode: it gives the workers the orders assigned for each tick itself, and it
+ * closes the queues of the pipeline when it stops.
+ *
+ * @param queue The queue to pop the assignments of each tick from.
+ */
+void Scheduler::set_assignment_queue(BoundedQueue<std::vector<std::pair<int,Order>>> *queue)
+{
+    this->assignment_queue = queue;
+}
+
+/**
+ * Set the queue that a snapshot of the workers is pushed to after each tick
+ * in the pipelined mode.
+ *
+ * @param queue The queue of worker snapshots.
+ */
+void Scheduler::set_snapshot_queue(BoundedQueue<Warehouse::WorkerState> *queue)
+{
+    this->snapshot_queue = queue;
+}
+
+/**
+ * Set the number of ticks to simulate in the pipelined mode. The simulation
+ * still stops after its length has elapsed.
+ *
+ * @param ticks The number of ticks, or 0 for no limit.
+ */
+void Scheduler::set_ticks(long ticks)
+{
+    this->ticks = ticks;
+}
+
+/**
+ * Set the thread pool used to find the paths of the workers in parallel.
+ *
+ * @param pool The thread pool to use.
+ */
+void Scheduler::set_thread_pool(ThreadPool *pool)
+{
+    this->thread_pool = pool;
+}
+
+/**
+ * Set the replay log the number of ticks simulated is recorded in.
+ *
+ * @param log The replay log to record in.
+ */
+void Scheduler::set_recorder(ReplayLog *log)
+{
+    this->recorder = log;
+}
+
+/**
+ * Set the replay log to replay. The scheduler then simulates the recorded
+ * number of ticks without a time limit, and gives the workers the recorded
+ * orders instead of the ones from a dispatcher.
+ *
+ * @param log The replay log to replay.
+ */
+void Scheduler::set_replay(ReplayLog *log)
+{
+    this->replay = log;
+}
+
+/**
+ * Set the buffer the workers are published to at the end of each tick, so
+ * that the view can draw them without reading the live warehouse.
+ *
+ * @param buffer The buffer to publish to.
+ */
+void Scheduler::set_view_snapshots(SnapshotBuffer *buffer)
+{
+    this->view_snapshots = buffer;
+}
@@ -3,14 +3,22 @@
 
 #include <ctime>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "algo/contention/contention_algo.h"
 #include "algo/path/path_algo.h"
+#include "algo/planning/planning_algo.h"
 #include "algo/routing/routing_algo.h"
 #include "concurrent/barrier.h"
+#include "concurrent/bounded_queue.h"
+#include "concurrent/snapshot_buffer.h"
+#include "concurrent/thread_pool.h"
+#include "concurrent/wake_queue.h"
 #include "warehouse.h"
 #include "rand/rand.h"
+#include "replay/replay_log.h"
 #include "thread/thread.h"
 #include "../logger/logger.h"
 
@@ -34,8 +42,28 @@ class Scheduler : public Thread
         void set_path_algo(PathAlgo *);
         // Set the contention algorithm.
         void set_contention_algo(ContentionAlgo *);
+        // Set the planning algorithm.
+        void set_planning_algo(PlanningAlgo *);
         // Set the log file directory.
         void set_log_dir(std::string dir);
+        // Set whether moves are made in two phases.
+        void set_two_phase(bool);
+        // Set the queue of workers to wake up.
+        void set_wake_queue(WakeQueue *);
+        // Set the queue of assignments for the pipelined mode.
+        void set_assignment_queue(BoundedQueue<std::vector<std::pair<int,Order>>> *);
+        // Set the queue of worker snapshots for the pipelined mode.
+        void set_snapshot_queue(BoundedQueue<Warehouse::WorkerState> *);
+        // Set the number of ticks to simulate in the pipelined mode.
+        void set_ticks(long);
+        // Set the thread pool.
+        void set_thread_pool(ThreadPool *);
+        // Set the replay log to record the number of ticks in.
+        void set_recorder(ReplayLog *);
+        // Set the replay log to replay.
+        void set_replay(ReplayLog *);
+        // Set the buffer the view reads the workers from.
+        void set_view_snapshots(SnapshotBuffer *);
     private:
         // Override from Thread
         void run() override;
@@ -43,6 +71,26 @@ class Scheduler : public Thread
         int rand_int(int);
         // Returns the shortest path between the two positions.
         std::vector<int> shortest_path(int, int);
+        // Routes the workers and finds the missing paths in one batch.
+        void find_paths(std::vector<int>&);
+        // Moves the workers one by one.
+        void sequential_step(std::vector<int>&);
+        // Moves the workers in two phases.
+        void two_phase_step(std::vector<int>&);
+        // Updates a worker that reached its destination.
+        void reached_dest(Worker&, const std::vector<int>&);
+        // Adds the woken workers to the active workers.
+        void wake_workers();
+        // Adds a worker to the active workers.
+        void wake(int);
+        // Gives the workers the orders assigned to them for this tick.
+        bool apply_assignments();
+        // Gives the workers the orders assigned to them in a replayed tick.
+        void replay_assignments(long);
+        // Removes the idle workers from the active workers.
+        void retire_workers();
+        // Returns true if the worker has nothing to do.
+        bool is_idle(Worker&);
 
         // The start time for the simulation.
         time_t start_time;
@@ -60,6 +108,38 @@ class Scheduler : public Thread
         PathAlgo *path_algo = nullptr;
         // The contention algorithm.
         ContentionAlgo *contention_algo = nullptr;
+        // The planning algorithm, if any.
+        PlanningAlgo *planning_algo = nullptr;
+        // Whether moves are collected first and then made together.
+        bool two_phase = false;
+        // The workers that were assigned orders, if only active workers are
+        // scheduled.
+        WakeQueue *wake_queue = nullptr;
+        // The indexes of the workers scheduled each iteration.
+        std::vector<int> active{};
+        // Whether each worker is in the active workers.
+        std::vector<bool> is_active{};
+        // Maps worker IDs to their indexes.
+        std::unordered_map<int,int> id_to_index{};
+        // The pipelined mode pops the orders assigned for each tick from
+        // here.
+        BoundedQueue<std::vector<std::pair<int,Order>>> *assignment_queue = nullptr;
+        // The pipelined mode pushes a copy of the workers after each tick
+        // here.
+        BoundedQueue<Warehouse::WorkerState> *snapshot_queue = nullptr;
+        // The number of ticks to simulate in the pipelined mode, or 0 for no
+        // limit.
+        long ticks = 0;
+        // The thread pool used to find paths, if any.
+        ThreadPool *thread_pool = nullptr;
+        // The number of ticks simulated is recorded here, if set.
+        ReplayLog *recorder = nullptr;
+        // The assignments of each tick are taken from here when replaying,
+        // instead of from the dispatcher.
+        ReplayLog *replay = nullptr;
+        // The workers are published here at the end of each tick for the
+        // view, if any.
+        SnapshotBuffer *view_snapshots = nullptr;
         // The logger.
         Logger logger;
 };
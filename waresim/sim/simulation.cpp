@@ -24,6 +24,15 @@ Simulation::Simulation(int sim_length, std::string warehouse_file)
     this->warehouse = Warehouse::parse_default_warehouse(warehouse_file);
 }
 
+/**
+ * Constructor for forks, which copy their warehouse from the simulation they
+ * were forked from.
+ */
+Simulation::Simulation()
+{
+
+}
+
 /**
  * Destructor.
  */
@@ -31,8 +40,15 @@ Simulation::~Simulation()
 {
     // Delete memory this object allocated.
     delete barrier;
+    delete wake_queue;
+    delete order_queue;
+    delete assignment_queue;
+    delete snapshot_queue;
     delete order_gen;
     delete scheduler;
+    delete engine;
+    delete origin;
+    delete view_snapshots;
 }
 
 /**
@@ -41,6 +57,15 @@ Simulation::~Simulation()
  */
 int Simulation::num_threads()
 {
+    // In the pipelined mode only the scheduler waits on the barrier, which
+    // then just paces the ticks.
+    if (pipeline > 0)
+        return 1;
+
+    // A replay only runs the scheduler.
+    if (replay != nullptr)
+        return 1;
+
     // TODO Make this neater.
     // Order generator, dispatcher, scheduler.
     return 1 + 1 + 1;
@@ -51,63 +76,275 @@ int Simulation::num_threads()
  */
 void Simulation::start()
 {
+    // Only the event engine stops between ticks in a state that can be
+    // written out and continued exactly.
+    if (!event_driven && (!checkpoint_file.empty() || !restore_file.empty()))
+        throw("Checkpoints need the event engine.");
+    // The other modes are deterministic already.
+    if ((recorder != nullptr || replay != nullptr) &&
+            (event_driven || pipeline > 0))
+        throw("Replays need the tick engine without a pipeline.");
+
+    // Set the start time for this simulation.
+    start_time = time(nullptr);
+
+    // The event engine runs the whole simulation by itself.
+    if (event_driven)
+    {
+        set_up_engine();
+
+        // Forks may run without a view.
+        if (view == nullptr)
+        {
+            engine->start();
+            return;
+        }
+
+        // The engine publishes the workers to the view after every tick.
+        view_snapshots = new SnapshotBuffer();
+        engine->set_view_snapshots(view_snapshots);
+
+        view->set_sim_params(start_time, sim_length);
+        view->set_warehouse(&warehouse);
+        view->set_snapshot_buffer(view_snapshots);
+        view->setup();
+
+        engine->start();
+        view->run();
+        return;
+    }
+
     // Set the decay factor for the warehouse.
     this->warehouse.set_decay_factor(decay_factor);
+    this->warehouse.set_thread_pool(thread_pool);
 
     // This is the barrier the different components in the simulation will
     // synchronize upon. We use a barrier to simulate 'time steps' within the
     // warehouse.
-    barrier = new Barrier(num_threads(), wait_time);
+    // Replays run at full speed.
+    barrier = new Barrier(num_threads(), (replay != nullptr) ? 0 : wait_time);
 
-    // Set the start time for this simulation.
-    start_time = time(nullptr);
+    // The dispatcher uses this queue to tell the scheduler which workers were
+    // assigned orders, so that the scheduler can skip idle workers.
+    wake_queue = new WakeQueue();
 
-    // Initialize the order generator.
-    order_gen = new OrderGenerator(start_time, sim_length);
-    order_gen->set_barrier(barrier);
-    order_gen->set_order_algo(order_algo);
-    order_gen->set_warehouse(&warehouse);
-    order_gen->set_log_dir(log_dir + "order_gen.txt");
-
-    // Initialize dispatcher.
-    dispatcher = new Dispatcher(start_time, sim_length);
-    dispatcher->set_barrier(barrier);
-    dispatcher->set_warehouse(&warehouse);
-    dispatcher->set_order_generator(order_gen);
-    dispatcher->set_algo(dispatch_algo);
-    dispatcher->set_log_dir(log_dir + "dispatcher.txt");
+    // In the pipelined mode the stages are connected by queues that hold up
+    // to 'pipeline' ticks. The dispatcher assigns the orders of tick t using
+    // the workers after tick t - pipeline, so the snapshot queue starts with
+    // that many copies of the initial workers.
+    if (pipeline > 0)
+    {
+        order_queue = new BoundedQueue<std::vector<Order>>(pipeline);
+        assignment_queue =
+            new BoundedQueue<std::vector<std::pair<int,Order>>>(pipeline);
+        snapshot_queue = new BoundedQueue<Warehouse::WorkerState>(pipeline);
+        for (int i = 0; i < pipeline; i++)
+            snapshot_queue->push(warehouse.get_worker_state());
+    }
+
+    // A replay takes the orders and their assignments from the replay log
+    // instead of the order generator and the dispatcher.
+    if (replay == nullptr)
+    {
+        // Initialize the order generator.
+        order_gen = new OrderGenerator(start_time, sim_length);
+        order_gen->set_barrier(barrier);
+        order_gen->set_order_algo(order_algo);
+        order_gen->set_warehouse(&warehouse);
+        order_gen->set_order_queue(order_queue);
+        order_gen->set_recorder(recorder);
+        order_gen->set_log_dir(log_dir + "order_gen.txt");
+
+        // Initialize dispatcher.
+        dispatcher = new Dispatcher(start_time, sim_length);
+        dispatcher->set_barrier(barrier);
+        dispatcher->set_warehouse(&warehouse);
+        dispatcher->set_order_generator(order_gen);
+        dispatcher->set_algo(dispatch_algo);
+        dispatcher->set_order_queue(order_queue);
+        dispatcher->set_assignment_queue(assignment_queue);
+        dispatcher->set_snapshot_queue(snapshot_queue);
+        dispatcher->set_lag(pipeline);
+        // The pipelined dispatcher runs ahead, so the scheduler wakes the
+        // workers when it gives them their orders.
+        if (pipeline == 0)
+            dispatcher->set_wake_queue(wake_queue);
+        dispatcher->set_recorder(recorder);
+        dispatcher->set_log_dir(log_dir + "dispatcher.txt");
+    }
+
+    // The scheduler's seed is recorded, so that a replay shuffles the
+    // workers the same way even if other generators are seeded differently.
+    unsigned int scheduler_seed = std::rand();
+    if (replay != nullptr)
+        scheduler_seed = replay->get_scheduler_seed();
+    if (recorder != nullptr)
+        recorder->set_scheduler_seed(scheduler_seed);
 
     // Initialize the scheduler.
     scheduler = new Scheduler(start_time, sim_length);
     scheduler->set_barrier(barrier);
     scheduler->set_warehouse(&warehouse);
-    scheduler->set_rand(Rand(std::rand()));
+    scheduler->set_rand(Rand(scheduler_seed));
     scheduler->set_routing_algo(routing_algo);
     scheduler->set_path_algo(path_algo);
     scheduler->set_contention_algo(contention_algo);
+    scheduler->set_planning_algo(planning_algo);
+    scheduler->set_two_phase(two_phase);
+    scheduler->set_wake_queue(wake_queue);
+    scheduler->set_thread_pool(thread_pool);
+    scheduler->set_assignment_queue(assignment_queue);
+    scheduler->set_snapshot_queue(snapshot_queue);
+    if (pipeline > 0)
+        scheduler->set_ticks(ticks);
+    scheduler->set_recorder(recorder);
+    scheduler->set_replay(replay);
     scheduler->set_log_dir(log_dir + "scheduler.txt");
 
+    // The scheduler publishes the workers to the view after every tick.
+    view_snapshots = new SnapshotBuffer();
+    scheduler->set_view_snapshots(view_snapshots);
+
     // Initial the render view.
     view->set_sim_params(start_time, sim_length);
     view->set_warehouse(&warehouse);
+    view->set_snapshot_buffer(view_snapshots);
     view->setup();
 
     // Start the simulation.
-    order_gen->start();
-    dispatcher->start();
+    if (order_gen != nullptr)
+        order_gen->start();
+    if (dispatcher != nullptr)
+        dispatcher->start();
     scheduler->start();
     view->run();
 }
 
 
+/**
+ * Creates the event engine, which continues from the checkpoint or the
+ * simulation this one was forked from, if any, and sets up the warehouse.
+ */
+void Simulation::set_up_engine()
+{
+    delete engine;
+    engine = new EventEngine(start_time, sim_length);
+    engine->set_warehouse(&warehouse);
+    engine->set_order_algo(order_algo);
+    engine->set_dispatch_algo(dispatch_algo);
+    engine->set_routing_algo(routing_algo);
+    engine->set_path_algo(path_algo);
+    engine->set_contention_algo(contention_algo);
+    engine->set_ticks(ticks);
+    engine->set_wait_time(wait_time);
+    if (!log_dir.empty())
+        engine->set_log_dir(log_dir + "engine.txt");
+    engine->set_checkpoint(checkpoint_file, checkpoint_every);
+
+    if (origin != nullptr)
+        engine->fork(*origin, true);
+
+    // Continue from the checkpoint, replacing the parsed warehouse.
+    if (!restore_file.empty())
+    {
+        CheckpointReader reader(CheckpointReader::load(restore_file));
+        engine->restore(reader, true);
+    }
+
+    // Set the decay factor for the warehouse.
+    this->warehouse.set_decay_factor(decay_factor);
+    this->warehouse.set_thread_pool(thread_pool);
+}
+
+/**
+ * Runs the simulation on the calling thread, without a view, and returns what
+ * happened. Only the event engine can be run this way. Any number of forks
+ * can be simulated at once, each on its own thread.
+ */
+Metrics Simulation::simulate()
+{
+    if (!event_driven)
+        throw("Only the event engine can simulate on the calling thread.");
+
+    start_time = time(nullptr);
+    set_up_engine();
+    engine->simulate();
+
+    return engine->get_metrics();
+}
+
+/**
+ * Returns a copy of this simulation that continues from where it stopped,
+ * for trying out what would happen with other algorithms or parameters. This
+ * simulation must have been run by the event engine and must have finished,
+ * for example after simulate() returned or join() was called with a number
+ * of ticks set. It is left as it was.
+ *
+ * The fork shares the immutable layout of the warehouse with this simulation
+ * and copies the state that changes, so it is cheap to make many forks. It
+ * has the same settings and algorithms, but no view, log directory or
+ * checkpoints. Any algorithm with state, such as a random number generator,
+ * must be replaced with a new one before the fork runs at the same time as
+ * another simulation using it. The caller owns the fork.
+ *
+ * @param copy_algos Whether the fork's algorithms continue from the state of
+ * this simulation's algorithms, for the ones of the same kind, so that a fork
+ * with the same algorithms goes on exactly as this simulation would have.
+ * Otherwise they keep their own state and seeds.
+ */
+Simulation *Simulation::fork(bool copy_algos)
+{
+    if (engine == nullptr)
+        throw("Only simulations run by the event engine can be forked.");
+
+    Simulation *branch = new Simulation();
+    branch->sim_length = sim_length;
+    branch->warehouse = warehouse;
+    branch->dispatch_algo = dispatch_algo;
+    branch->routing_algo = routing_algo;
+    branch->path_algo = path_algo;
+    branch->contention_algo = contention_algo;
+    branch->planning_algo = planning_algo;
+    branch->order_algo = order_algo;
+    branch->thread_pool = thread_pool;
+    branch->wait_time = wait_time;
+    branch->decay_factor = decay_factor;
+    branch->two_phase = two_phase;
+    branch->event_driven = true;
+    branch->ticks = ticks;
+    branch->pipeline = pipeline;
+
+    // Keep the engine's state until the fork is run.
+    branch->origin = new EventEngine(0, 0);
+    branch->origin->fork(*engine, copy_algos);
+
+    return branch;
+}
+
+/**
+ * Returns the warehouse being simulated.
+ */
+const Warehouse& Simulation::get_warehouse()
+{
+    return warehouse;
+}
+
 /**
  * Waits for the simulation to finish its execution.
  * Should only be called after run().
  */
 void Simulation::join()
 {
-    order_gen->join();
-    dispatcher->join();
+    if (engine != nullptr)
+    {
+        engine->join();
+        return;
+    }
+
+    if (order_gen != nullptr)
+        order_gen->join();
+    if (dispatcher != nullptr)
+        dispatcher->join();
     scheduler->join();
     //view->join();
 }
@@ -173,6 +410,16 @@ void Simulation::set_contention_algo(ContentionAlgo *algo)
     this->contention_algo = algo;
 }
 
+/**
+ * Set the planning algorithm to use. No planning is done if this is not set.
+ *
+ * @param algo The planning algorithm to use.
+ */
+void Simulation::set_planning_algo(PlanningAlgo *algo)
+{
+    this->planning_algo = algo;
+}
+
 /**
  * Set the log file directory.
  *
@@ -203,3 +450,113 @@ void Simulation::set_decay_factor(double d)
 {
     this->decay_factor = d;
 }
+
+/**
+ * Set whether the scheduler makes moves in two phases.
+ *
+ * @param two_phase True to make moves in two phases.
+ */
+void Simulation::set_two_phase(bool two_phase)
+{
+    this->two_phase = two_phase;
+}
+
+/**
+ * Set whether the simulation is run by the event engine instead of stepping
+ * the order generator, dispatcher and scheduler every tick.
+ *
+ * @param event_driven True to use the event engine.
+ */
+void Simulation::set_event_driven(bool event_driven)
+{
+    this->event_driven = event_driven;
+}
+
+/**
+ * Set the number of ticks for the event engine or the pipeline to simulate.
+ *
+ * @param ticks The number of ticks, or 0 for no limit.
+ */
+void Simulation::set_ticks(long ticks)
+{
+    this->ticks = ticks;
+}
+
+/**
+ * Set how many ticks the order generator and dispatcher may run ahead of the
+ * scheduler. With 0 (the default) all three wait for each other on the
+ * barrier every tick.
+ *
+ * @param pipeline The number of ticks, or 0.
+ */
+void Simulation::set_pipeline(int pipeline)
+{
+    this->pipeline = pipeline;
+}
+
+/**
+ * Set the thread pool shared by the scheduler and the warehouse statistics.
+ * The algorithms that use it are given it when they are created.
+ *
+ * @param pool The thread pool to use.
+ */
+void Simulation::set_thread_pool(ThreadPool *pool)
+{
+    this->thread_pool = pool;
+}
+
+/**
+ * Set the file the event engine writes checkpoints to. Only the event engine
+ * supports checkpoints.
+ *
+ * @param file The checkpoint file, or empty for no checkpoints.
+ * @param every The number of ticks between checkpoints, or 0 to only write
+ * one when the simulation stops.
+ */
+void Simulation::set_checkpoint(std::string file, long every)
+{
+    this->checkpoint_file = file;
+    this->checkpoint_every = every;
+}
+
+/**
+ * Set the checkpoint to continue from. The warehouse, the pending events and
+ * the state of the algorithms are all restored, so the simulation goes on
+ * exactly as the one that wrote the checkpoint would have. Only the event
+ * engine supports checkpoints.
+ *
+ * @param file The checkpoint file, or empty to start a new simulation.
+ */
+void Simulation::set_restore(std::string file)
+{
+    this->restore_file = file;
+}
+
+/**
+ * Set the replay log the run is recorded in: the orders generated and the
+ * orders assigned in each tick, the seed of the scheduler and the number of
+ * ticks simulated. Only the tick engine without a pipeline records, since the
+ * other modes are deterministic already. The caller saves the log once the
+ * simulation has finished.
+ *
+ * @param log The replay log to record in.
+ */
+void Simulation::set_recorder(ReplayLog *log)
+{
+    this->recorder = log;
+}
+
+/**
+ * Set the replay log to replay. The scheduler then runs alone at full speed,
+ * takes the assignments of each tick from the log instead of the order
+ * generator and the dispatcher, and stops after the recorded number of ticks
+ * instead of after the simulation length. The result only depends on the log
+ * and on the scheduler's algorithms, so runs with different versions of them
+ * can be compared.
+ *
+ * @param log The replay log to replay.
+ */
+void Simulation::set_replay(ReplayLog *log)
+{
+    this->replay = log;
+}
@@ -4,16 +4,25 @@
 #include <ctime>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "algo/contention/contention_algo.h"
 #include "algo/dispatch/dispatch_algo.h"
 #include "algo/ordering/order_algo.h"
 #include "algo/path/path_algo.h"
+#include "algo/planning/planning_algo.h"
 #include "algo/routing/routing_algo.h"
 #include "concurrent/barrier.h"
+#include "concurrent/bounded_queue.h"
+#include "concurrent/snapshot_buffer.h"
+#include "concurrent/thread_pool.h"
+#include "concurrent/wake_queue.h"
 #include "dispatcher.h"
+#include "event_engine.h"
 #include "warehouse.h"
 #include "order_generator.h"
+#include "replay/replay_log.h"
 #include "scheduler.h"
 #include "view/view.h"
 
@@ -32,6 +41,13 @@ class Simulation
         void start();
         // Waits for the simulation thread to finish.
         void join();
+        // Runs the simulation on the calling thread.
+        Metrics simulate();
+        // Returns a copy of the simulation that continues from where it
+        // stopped.
+        Simulation *fork(bool);
+        // Returns the warehouse being simulated.
+        const Warehouse& get_warehouse();
 
         // Set the dispatch algorithm to use.
         void set_dispatch_algo(DispatchAlgo *);
@@ -45,16 +61,40 @@ class Simulation
         void set_order_algo(OrderAlgo *);
         // Set the contention algorithm to use.
         void set_contention_algo(ContentionAlgo *);
+        // Set the planning algorithm to use.
+        void set_planning_algo(PlanningAlgo *);
         // Set the log file directory.
         void set_log_dir(std::string dir);
         // Set the wait time between steps.
         void set_wait_time(int);
         // Set the decay factor.
         void set_decay_factor(double);
+        // Set whether the scheduler makes moves in two phases.
+        void set_two_phase(bool);
+        // Set whether the simulation is run by the event engine.
+        void set_event_driven(bool);
+        // Set the number of ticks to simulate.
+        void set_ticks(long);
+        // Set how many ticks the pipeline stages may run ahead.
+        void set_pipeline(int);
+        // Set the thread pool.
+        void set_thread_pool(ThreadPool *);
+        // Set the checkpoint file and how often to write it.
+        void set_checkpoint(std::string, long);
+        // Set the checkpoint to continue from.
+        void set_restore(std::string);
+        // Set the replay log to record the run in.
+        void set_recorder(ReplayLog *);
+        // Set the replay log to replay.
+        void set_replay(ReplayLog *);
 
     private:
+        Simulation();
+
         // Returns the number of threads that need to by synchronized.
         int num_threads();
+        // Creates the event engine.
+        void set_up_engine();
 
         // The start time of the simulation.
         time_t start_time;
@@ -68,10 +108,21 @@ class Simulation
         Dispatcher *dispatcher = nullptr;
         // Scheduler for the simulation.
         Scheduler *scheduler = nullptr;
+        // Event engine for the simulation, used instead of the order
+        // generator, dispatcher and scheduler.
+        EventEngine *engine = nullptr;
+        // The engine state a fork continues from, until it is run.
+        EventEngine *origin = nullptr;
         // Warehouse that the dispatcher will use.
         Warehouse warehouse;
         // The barrier.
         Barrier *barrier = nullptr;
+        // Workers assigned new orders, shared by the dispatcher and scheduler.
+        WakeQueue *wake_queue = nullptr;
+        // The queues connecting the stages in the pipelined mode.
+        BoundedQueue<std::vector<Order>> *order_queue = nullptr;
+        BoundedQueue<std::vector<std::pair<int,Order>>> *assignment_queue = nullptr;
+        BoundedQueue<Warehouse::WorkerState> *snapshot_queue = nullptr;
         // The dispatch algorithm.
         DispatchAlgo *dispatch_algo = nullptr;
         // The routing algorithm.
@@ -80,16 +131,42 @@ class Simulation
         PathAlgo *path_algo = nullptr;
         // The contention algorithm to use.
         ContentionAlgo *contention_algo = nullptr;
+        // The planning algorithm to use, if any.
+        PlanningAlgo *planning_algo = nullptr;
         // The order generating algorithm to use.
         OrderAlgo *order_algo = nullptr;
         // The view to render the warehouse.
         View *view = nullptr;
+        // The thread pool shared by the components, if any.
+        ThreadPool *thread_pool = nullptr;
         // The log file directory.
         std::string log_dir;
         // The wait time between steps.
         int wait_time = 1000;
         // The decay factor for windows.
         double decay_factor = 0.9;
+        // Whether the scheduler makes moves in two phases.
+        bool two_phase = false;
+        // Whether the simulation is run by the event engine.
+        bool event_driven = false;
+        // The number of ticks for the event engine or the pipeline to
+        // simulate, or 0.
+        long ticks = 0;
+        // How many ticks the pipeline stages may run ahead, or 0 to run the
+        // stages in lockstep on the barrier.
+        int pipeline = 0;
+        // The file the event engine writes checkpoints to, or empty.
+        std::string checkpoint_file;
+        // The number of ticks between checkpoints, or 0.
+        long checkpoint_every = 0;
+        // The checkpoint to continue from, or empty.
+        std::string restore_file;
+        // The replay log the run is recorded in, if any.
+        ReplayLog *recorder = nullptr;
+        // The replay log being replayed, if any.
+        ReplayLog *replay = nullptr;
+        // The buffer the workers are published to for the view, if any.
+        SnapshotBuffer *view_snapshots = nullptr;
 };
 
 #endif
@@ -0,0 +1,248 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sweep.h"
+
+/**
+ * Constructor.
+ */
+Sweep::Sweep()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+Sweep::~Sweep()
+{
+
+}
+
+/**
+ * Returns the warehouse in a file, parsing it the first time it is asked
+ * for. When the sweep continues from a checkpoint or forks from a
+ * simulation, that warehouse is returned instead.
+ *
+ * @param warehouse_file The file containing the warehouse representation.
+ */
+const Warehouse& Sweep::get_warehouse(std::string warehouse_file)
+{
+    auto it = warehouses.find(warehouse_file);
+    if (it == warehouses.end() && origin != nullptr)
+    {
+        it = warehouses.emplace(warehouse_file, origin->get_warehouse()).first;
+    }
+    else if (it == warehouses.end() && !checkpoint.empty())
+    {
+        CheckpointReader reader(checkpoint);
+        it = warehouses.emplace(warehouse_file, Warehouse::load(reader)).first;
+    }
+    else if (it == warehouses.end())
+    {
+        it = warehouses.emplace(warehouse_file,
+                Warehouse::parse_default_warehouse(warehouse_file)).first;
+    }
+
+    return it->second;
+}
+
+/**
+ * Returns the distance cache for the warehouse in a file, which the
+ * algorithms of every point using that warehouse should be given.
+ *
+ * @param warehouse_file The file containing the warehouse representation.
+ */
+DistanceCache *Sweep::get_distance_cache(std::string warehouse_file)
+{
+    std::unique_ptr<DistanceCache>& cache = caches[warehouse_file];
+    if (!cache)
+        cache.reset(new DistanceCache());
+
+    return cache.get();
+}
+
+/**
+ * Adds a point of the sweep. Its replicates are added with add_replicate().
+ *
+ * @param values The value of each swept parameter at this point.
+ * @param warehouse_file The warehouse file the point simulates.
+ * @param ticks The number of ticks each replicate simulates.
+ * @param decay_factor The decay factor for windows.
+ */
+void Sweep::add_point(std::vector<std::pair<std::string,std::string>> values,
+        std::string warehouse_file, long ticks, double decay_factor)
+{
+    if (ticks <= 0)
+        throw("Sweeps need a number of ticks to simulate.");
+
+    // Parse the warehouse now, so that the runs only read the parsed ones.
+    get_warehouse(warehouse_file);
+
+    Point point;
+    point.values = values;
+    point.warehouse_file = warehouse_file;
+    point.ticks = ticks;
+    point.decay_factor = decay_factor;
+    points.push_back(point);
+}
+
+/**
+ * Adds a replicate to the last point added. The algorithms must not be shared
+ * with another run. This object does not take ownership of them.
+ *
+ * @param algos The algorithms the replicate is simulated with.
+ */
+void Sweep::add_replicate(Replicates::Algos algos)
+{
+    points.back().algos.push_back(algos);
+}
+
+/**
+ * Runs every replicate of every point, as many at a time as the thread pool
+ * has threads, and writes the results once they have all finished.
+ */
+void Sweep::run()
+{
+    // Every run needs the distances to the drop locations of its warehouse.
+    for (auto& entry : warehouses)
+    {
+        get_distance_cache(entry.first)->precompute(&entry.second,
+                entry.second.get_drops(), thread_pool);
+    }
+
+    // The point and replicate of each run.
+    std::vector<std::pair<int,int>> runs;
+    for (std::size_t p = 0; p < points.size(); p++)
+    {
+        points[p].metrics.assign(points[p].algos.size(), Metrics());
+        for (std::size_t r = 0; r < points[p].algos.size(); r++)
+            runs.push_back({p, r});
+    }
+
+    auto run_range = [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            Point& point = points[runs[i].first];
+            int r = runs[i].second;
+            if (origin != nullptr)
+            {
+                point.metrics[r] = Replicates::simulate_fork(*origin,
+                        point.algos[r], point.ticks, point.decay_factor);
+                continue;
+            }
+            point.metrics[r] = Replicates::simulate(
+                    warehouses.at(point.warehouse_file), point.algos[r],
+                    point.ticks, point.decay_factor, checkpoint);
+        }
+    };
+
+    if (thread_pool == nullptr)
+        run_range(0, runs.size());
+    else
+        thread_pool->parallel_for(0, runs.size(), 1, run_range);
+
+    report();
+}
+
+/**
+ * Writes one row per point to sweep.csv in the log directory, and to the
+ * standard output. A row holds the values of the swept parameters, the number
+ * of replicates, and the mean of each metric with the bounds of its 95%
+ * confidence interval.
+ */
+void Sweep::report()
+{
+    std::ofstream out(log_dir + "sweep.csv");
+    std::vector<std::string> names = metric_names();
+
+    std::string header;
+    if (!points.empty())
+    {
+        for (auto& value : points[0].values)
+            header.append(value.first + ",");
+    }
+    header.append("Replicates");
+    for (auto& name : names)
+        header.append("," + name + "," + name + " low," + name + " high");
+
+    out << header << std::endl;
+    std::cout << header << std::endl;
+
+    for (auto& point : points)
+    {
+        std::string row;
+        for (auto& value : point.values)
+            row.append(value.second + ",");
+        row.append(std::to_string(point.metrics.size()));
+
+        std::vector<std::vector<double>> columns(names.size());
+        for (auto& metrics : point.metrics)
+        {
+            std::vector<double> values = metric_values(metrics);
+            for (std::size_t j = 0; j < names.size(); j++)
+                columns[j].push_back(values[j]);
+        }
+
+        for (auto& column : columns)
+        {
+            double mean, half_width;
+            confidence_interval(column, &mean, &half_width);
+            row.append("," + metric_to_string(mean));
+            row.append("," + metric_to_string(mean - half_width));
+            row.append("," + metric_to_string(mean + half_width));
+        }
+
+        out << row << std::endl;
+        std::cout << row << std::endl;
+    }
+}
+
+/**
+ * Set the thread pool the runs are spread over. Without one they run one
+ * after another.
+ *
+ * @param pool The thread pool to use.
+ */
+void Sweep::set_thread_pool(ThreadPool *pool)
+{
+    this->thread_pool = pool;
+}
+
+/**
+ * Set the log file directory.
+ *
+ * @param dir The log file directory to use.
+ */
+void Sweep::set_log_dir(std::string dir)
+{
+    this->log_dir = dir;
+    log_dir.append("/");
+}
+
+/**
+ * Set the checkpoint every run of every point continues from. Must be set
+ * before any points are added.
+ *
+ * @param file The checkpoint file.
+ */
+void Sweep::set_restore(std::string file)
+{
+    this->checkpoint = CheckpointReader::load(file);
+}
+
+/**
+ * Set the simulation every run of every point forks from. The simulation must
+ * have been run by the event engine and finished, and must outlive the sweep.
+ * Must be set before any points are added.
+ *
+ * @param origin The simulation to fork.
+ */
+void Sweep::set_origin(Simulation *origin)
+{
+    this->origin = origin;
+}
@@ -0,0 +1,96 @@
+#ifndef SIM_SWEEP_H
+#define SIM_SWEEP_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "algo/path/distance_cache.h"
+#include "concurrent/thread_pool.h"
+#include "metrics.h"
+#include "replicates.h"
+#include "simulation.h"
+#include "warehouse.h"
+
+/**
+ * Runs the points of a parameter sweep and writes their results to a single
+ * table. Each point is simulated by one or more replicates, all of which run
+ * headless on the event engine, and every run of every point is spread over
+ * the threads of the thread pool, so the pool's size limits how many run at
+ * once.
+ *
+ * Points that use the same warehouse file share the parsed warehouse and its
+ * distance cache, so each layout is parsed once and each distance is computed
+ * once for the whole sweep.
+ *
+ * Every point can also continue from the same checkpoint, in which case the
+ * warehouse comes from the checkpoint instead of the points' warehouse files,
+ * or fork from the same simulation.
+ */
+class Sweep
+{
+    public:
+        Sweep();
+        ~Sweep();
+
+        // Returns the parsed warehouse in a file.
+        const Warehouse& get_warehouse(std::string);
+        // Returns the distance cache for the warehouse in a file.
+        DistanceCache *get_distance_cache(std::string);
+
+        // Adds a point of the sweep.
+        void add_point(std::vector<std::pair<std::string,std::string>>,
+                std::string, long, double);
+        // Adds a replicate to the last point added.
+        void add_replicate(Replicates::Algos);
+        // Runs every point and writes the results.
+        void run();
+
+        // Set the thread pool.
+        void set_thread_pool(ThreadPool *);
+        // Set the log file directory.
+        void set_log_dir(std::string dir);
+        // Set the checkpoint the points continue from.
+        void set_restore(std::string);
+        // Set the simulation the points fork from.
+        void set_origin(Simulation *);
+    private:
+        // A point of the sweep.
+        struct Point
+        {
+            // The value of each swept parameter.
+            std::vector<std::pair<std::string,std::string>> values{};
+            // The warehouse file.
+            std::string warehouse_file;
+            // The number of ticks each replicate simulates.
+            long ticks = 0;
+            // The decay factor for windows.
+            double decay_factor = 0.9;
+            // The algorithms of each replicate.
+            std::vector<Replicates::Algos> algos{};
+            // The metrics of each replicate, once run.
+            std::vector<Metrics> metrics{};
+        };
+
+        // Writes the results table.
+        void report();
+
+        // The points of the sweep.
+        std::vector<Point> points{};
+        // The parsed warehouses, keyed by file.
+        std::map<std::string, Warehouse> warehouses{};
+        // The distance caches, keyed by warehouse file.
+        std::map<std::string, std::unique_ptr<DistanceCache>> caches{};
+        // The thread pool the runs are spread over, if any.
+        ThreadPool *thread_pool = nullptr;
+        // The log file directory.
+        std::string log_dir;
+        // The data of the checkpoint the points continue from, or empty.
+        std::string checkpoint{};
+        // The simulation the points fork from, if any.
+        Simulation *origin = nullptr;
+};
+
+#endif
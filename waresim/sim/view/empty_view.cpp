@@ -43,3 +43,15 @@ void EmptyView::set_sim_params(time_t, int)
 {
 
 }
+
+// This method will not do anything.
+void EmptyView::set_snapshot_buffer(SnapshotBuffer *)
+{
+
+}
+
+// This method will not do anything.
+void EmptyView::set_frame_rate(int)
+{
+
+}
@@ -21,4 +21,8 @@ class EmptyView : public View
         void set_warehouse(Warehouse *) override;
         // This method will not do anything.
         void set_sim_params(time_t, int) override;
+        // This method will not do anything.
+        void set_snapshot_buffer(SnapshotBuffer *) override;
+        // This method will not do anything.
+        void set_frame_rate(int) override;
 };
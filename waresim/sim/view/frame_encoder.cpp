@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <iostream>
+#include <utility>
+
+#include "frame_encoder.h"
+
+/**
+ * Implementation for frame_encoder.h
+ */
+
+/**
+ * Constructor.
+ *
+ * @param dir The directory to write the frames to, which must exist.
+ * @param capacity The most frames waiting to be written at once.
+ */
+FrameEncoder::FrameEncoder(const std::string& dir, std::size_t capacity)
+    : frames(capacity)
+{
+    this->dir = dir;
+    if (!this->dir.empty() && this->dir.back() != '/')
+        this->dir += '/';
+}
+
+/**
+ * Destructor.
+ */
+FrameEncoder::~FrameEncoder()
+{
+
+}
+
+/**
+ * Adds a frame to be written. Blocks while the queue is full, so the caller
+ * must not be a thread the simulation waits on.
+ *
+ * @param frame The frame to write.
+ */
+void FrameEncoder::push(Frame frame)
+{
+    frames.push(std::move(frame));
+}
+
+/**
+ * Closes the queue. The thread stops once the frames already added have been
+ * written.
+ */
+void FrameEncoder::close()
+{
+    frames.close();
+}
+
+/**
+ * Returns the number of frames written. Must only be called once the thread
+ * has been joined.
+ */
+long FrameEncoder::get_written()
+{
+    return written;
+}
+
+/**
+ * Writes frames until the queue is closed and empty.
+ */
+void FrameEncoder::run()
+{
+    Frame frame;
+    while (frames.pop(frame))
+    {
+        if (write(frame))
+            written++;
+    }
+}
+
+/**
+ * Writes a frame as a binary PPM. The file is named after the tick, padded so
+ * that the files sort in the order of their ticks.
+ *
+ * @param frame The frame to write.
+ *
+ * @return False if the file could not be written.
+ */
+bool FrameEncoder::write(const Frame& frame)
+{
+    char name[32];
+    std::snprintf(name, sizeof name, "frame_%08ld.ppm", frame.tick);
+    std::string file = dir + name;
+
+    std::FILE *out = std::fopen(file.c_str(), "wb");
+    if (out == nullptr)
+    {
+        std::cout << "Unable to write frame " << file << std::endl;
+        return false;
+    }
+
+    std::fprintf(out, "P6\n%d %d\n255\n", frame.width, frame.height);
+    std::size_t size = frame.pixels.size();
+    bool ok = std::fwrite(frame.pixels.data(), 1, size, out) == size;
+    ok = (std::fclose(out) == 0) && ok;
+    if (!ok)
+        std::cout << "Unable to write frame " << file << std::endl;
+
+    return ok;
+}
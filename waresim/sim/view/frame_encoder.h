@@ -0,0 +1,55 @@
+#ifndef SIM_VIEW_FRAME_ENCODER_H
+#define SIM_VIEW_FRAME_ENCODER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../concurrent/bounded_queue.h"
+#include "../thread/thread.h"
+
+/**
+ * Writes frames to image files on its own thread, so that encoding and disk
+ * writes never hold up whoever draws the frames. Each frame is written as a
+ * binary PPM named after its tick. Frames wait in a bounded queue until they
+ * are written.
+ */
+class FrameEncoder : public Thread
+{
+    public:
+        FrameEncoder(const std::string&, std::size_t);
+        ~FrameEncoder();
+
+        // An image of the simulation at a tick.
+        struct Frame
+        {
+            // The tick drawn.
+            long tick = 0;
+            // The size of the image in pixels.
+            int width = 0;
+            int height = 0;
+            // The red, green and blue of each pixel, row by row from the top.
+            std::vector<unsigned char> pixels{};
+        };
+
+        // Add a frame to write, blocking while the queue is full.
+        void push(Frame);
+        // Stop once every frame added has been written.
+        void close();
+        // Returns the number of frames written.
+        long get_written();
+    private:
+        // Override from Thread.
+        void run() override;
+        // Write a frame to its file.
+        bool write(const Frame&);
+
+        // The directory the frames are written to.
+        std::string dir;
+        // The frames waiting to be written.
+        BoundedQueue<Frame> frames;
+        // The number of frames written.
+        long written = 0;
+};
+
+#endif
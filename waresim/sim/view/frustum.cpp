@@ -0,0 +1,79 @@
+#include "frustum.h"
+
+/**
+ * Implementation for frustum.h
+ */
+
+/**
+ * Constructor. The planes start at zero, so every box is visible until the
+ * planes are extracted.
+ */
+Frustum::Frustum()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+Frustum::~Frustum()
+{
+
+}
+
+/**
+ * Finds the planes of the frustum from the rows of the combined projection
+ * and modelview matrix. The matrices are in OpenGL's column-major order, as
+ * returned by glGetFloatv().
+ *
+ * @param projection The projection matrix.
+ * @param modelview The modelview matrix.
+ */
+void Frustum::extract(const GLfloat *projection, const GLfloat *modelview)
+{
+    // The combined matrix, indexed by column and then row.
+    GLfloat clip[4][4];
+    for (int col = 0; col < 4; col++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            clip[col][row] = 0;
+            for (int k = 0; k < 4; k++)
+                clip[col][row] += projection[k*4 + row] * modelview[col*4 + k];
+        }
+    }
+
+    // Each plane is the last row plus or minus one of the others: left,
+    // right, bottom, top, near and far.
+    for (int p = 0; p < 6; p++)
+    {
+        int row = p / 2;
+        GLfloat sign = (p % 2 == 0) ? 1 : -1;
+        for (int col = 0; col < 4; col++)
+            planes[p][col] = clip[col][3] + sign * clip[col][row];
+    }
+}
+
+/**
+ * Returns whether any of an axis-aligned box may be visible. A box is only
+ * rejected if it is entirely outside one of the planes, so a few boxes near
+ * the corners of the frustum are kept even though they are not visible.
+ *
+ * @param min The smallest x, y and z coordinates of the box.
+ * @param max The largest x, y and z coordinates of the box.
+ */
+bool Frustum::intersects(const GLfloat *min, const GLfloat *max) const
+{
+    for (auto& plane : planes)
+    {
+        // The corner of the box furthest inside the plane.
+        GLfloat dist = plane[3];
+        for (int i = 0; i < 3; i++)
+            dist += plane[i] * ((plane[i] >= 0) ? max[i] : min[i]);
+
+        if (dist < 0)
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef SIM_VIEW_FRUSTUM_H
+#define SIM_VIEW_FRUSTUM_H
+
+#include <GL/gl.h>
+
+/**
+ * The part of the scene the camera can see, bounded by six planes. The planes
+ * are found from the projection and modelview matrices, so boxes are tested in
+ * the coordinates of whatever is drawn with those matrices.
+ */
+class Frustum
+{
+    public:
+        Frustum();
+        ~Frustum();
+
+        // Find the planes from the projection and modelview matrices.
+        void extract(const GLfloat *, const GLfloat *);
+        // Returns whether any of a box may be visible.
+        bool intersects(const GLfloat *, const GLfloat *) const;
+    private:
+        // The planes as a, b, c and d, where ax + by + cz + d >= 0 inside.
+        GLfloat planes[6][4] = {};
+};
+
+#endif
@@ -68,6 +68,20 @@ std::vector<GLfloat> OpenGLBox::back_normals{
     0, 0,-1,   0, 0,-1,   0, 0,-1 
 };
 
+/*
+ * The faces in the order of the face constants.
+ */
+
+const std::vector<GLfloat> *OpenGLBox::face_vertices[6] = {
+    &front_vertices, &back_vertices, &top_vertices,
+    &bot_vertices, &left_vertices, &right_vertices
+};
+
+const std::vector<GLfloat> *OpenGLBox::face_normals[6] = {
+    &front_normals, &back_normals, &top_normals,
+    &bot_normals, &left_normals, &right_normals
+};
+
 /**
  * Returns the top vertices.
  *
@@ -469,3 +483,263 @@ std::vector<GLfloat> OpenGLBox::get_right_normals()
     return right_normals;
 }
 
+
+/**
+ * Appends the vertices and normals of every face of the box, in the order
+ * front, back, top, bottom, left and right. Unlike the get_* methods this
+ * does not make a copy of each face.
+ *
+ * @param verts The vertices to append to.
+ * @param norms The normals to append to.
+ * @param scalex The scale of x coords.
+ * @param scaley The scale of the y coords.
+ * @param scalez The scale of the z coords.
+ * @param offx The offsets of the x-vertices.
+ * @param offy The offsets of the y-vertices.
+ * @param offz The offsets of the z-vertices.
+ */
+void OpenGLBox::append_box(std::vector<GLfloat>& verts,
+        std::vector<GLfloat>& norms, float scalex, float scaley, float scalez,
+        float offx, float offy, float offz)
+{
+    append_face(front_vertices, front_normals, verts, norms, scalex, scaley,
+            scalez, offx, offy, offz);
+    append_face(back_vertices, back_normals, verts, norms, scalex, scaley,
+            scalez, offx, offy, offz);
+    append_face(top_vertices, top_normals, verts, norms, scalex, scaley,
+            scalez, offx, offy, offz);
+    append_face(bot_vertices, bot_normals, verts, norms, scalex, scaley,
+            scalez, offx, offy, offz);
+    append_face(left_vertices, left_normals, verts, norms, scalex, scaley,
+            scalez, offx, offy, offz);
+    append_face(right_vertices, right_normals, verts, norms, scalex, scaley,
+            scalez, offx, offy, offz);
+}
+
+/**
+ * Appends the vertices of a face, scaled and offset, and its normals.
+ *
+ * @param face The vertices of the face of the unit box.
+ * @param normals The normals of the face.
+ * @param verts The vertices to append to.
+ * @param norms The normals to append to.
+ * @param scalex The scale of x coords.
+ * @param scaley The scale of the y coords.
+ * @param scalez The scale of the z coords.
+ * @param offx The offsets of the x-vertices.
+ * @param offy The offsets of the y-vertices.
+ * @param offz The offsets of the z-vertices.
+ */
+void OpenGLBox::append_face(const std::vector<GLfloat>& face,
+        const std::vector<GLfloat>& normals, std::vector<GLfloat>& verts,
+        std::vector<GLfloat>& norms, float scalex, float scaley, float scalez,
+        float offx, float offy, float offz)
+{
+    for (std::size_t i = 0; i < face.size(); i += 3)
+    {
+        verts.push_back(face[i] * scalex + offx);
+        verts.push_back(face[i+1] * scaley + offy);
+        verts.push_back(face[i+2] * scalez + offz);
+    }
+    norms.insert(norms.end(), normals.begin(), normals.end());
+}
+
+/**
+ * Appends the four corners of a face, scaled and offset, along with their
+ * normals and the indices of the face's two triangles. The triangles wind the
+ * same way as those of the get_* methods. Scaling a face stretches it over
+ * several cells, so a merged face is appended the same way as a single one.
+ *
+ * @param face The face, one of the face constants.
+ * @param verts The vertices to append to.
+ * @param norms The normals to append to.
+ * @param indices The indices to append to.
+ * @param scalex The scale of x coords.
+ * @param scaley The scale of the y coords.
+ * @param scalez The scale of the z coords.
+ * @param offx The offsets of the x-vertices.
+ * @param offy The offsets of the y-vertices.
+ * @param offz The offsets of the z-vertices.
+ */
+void OpenGLBox::append_indexed_face(int face, std::vector<GLfloat>& verts,
+        std::vector<GLfloat>& norms, std::vector<GLuint>& indices,
+        float scalex, float scaley, float scalez, float offx, float offy,
+        float offz)
+{
+    // Each face is stored as the triangles (0, 1, 2) and (2, 4, 0), so these
+    // are its corners.
+    static const int corners[4] = {0, 1, 2, 4};
+    static const GLuint triangles[6] = {0, 1, 2, 2, 3, 0};
+
+    const std::vector<GLfloat>& vertices = *face_vertices[face];
+    const std::vector<GLfloat>& normals = *face_normals[face];
+    GLuint base = verts.size() / 3;
+
+    for (int corner : corners)
+    {
+        verts.push_back(vertices[corner*3] * scalex + offx);
+        verts.push_back(vertices[corner*3 + 1] * scaley + offy);
+        verts.push_back(vertices[corner*3 + 2] * scalez + offz);
+        norms.insert(norms.end(), normals.begin() + corner*3,
+                normals.begin() + corner*3 + 3);
+    }
+
+    for (GLuint index : triangles)
+        indices.push_back(base + index);
+}
+
+/**
+ * Appends every face of the box, sharing the corners of each face between
+ * its two triangles. A box is 24 vertices rather than 36.
+ *
+ * @param verts The vertices to append to.
+ * @param norms The normals to append to.
+ * @param indices The indices to append to.
+ * @param scalex The scale of x coords.
+ * @param scaley The scale of the y coords.
+ * @param scalez The scale of the z coords.
+ * @param offx The offsets of the x-vertices.
+ * @param offy The offsets of the y-vertices.
+ * @param offz The offsets of the z-vertices.
+ */
+void OpenGLBox::append_indexed_box(std::vector<GLfloat>& verts,
+        std::vector<GLfloat>& norms, std::vector<GLuint>& indices,
+        float scalex, float scaley, float scalez, float offx, float offy,
+        float offz)
+{
+    for (int face = 0; face < 6; face++)
+    {
+        append_indexed_face(face, verts, norms, indices, scalex, scaley,
+                scalez, offx, offy, offz);
+    }
+}
+
+/**
+ * Appends the walls in a rectangle of a layout, as unit boxes centered on
+ * their cells. A side is left out when it faces another wall, even one
+ * outside the rectangle. The tops and bottoms are merged into rectangles
+ * greedily: each takes as many cells of its row as it can, then as many rows
+ * as are covered by walls not yet taken. The sides are merged into runs along
+ * their row or column. A straight wall is thus a handful of faces however
+ * long it is.
+ *
+ * @param walls Whether each position of the layout is a wall.
+ * @param width The width of the layout.
+ * @param height The height of the layout.
+ * @param x0 The first column of the rectangle.
+ * @param z0 The first row of the rectangle.
+ * @param x1 The column after the last of the rectangle.
+ * @param z1 The row after the last of the rectangle.
+ * @param verts The vertices to append to.
+ * @param norms The normals to append to.
+ * @param indices The indices to append to.
+ */
+void OpenGLBox::append_walls(const std::vector<bool>& walls, int width,
+        int height, int x0, int z0, int x1, int z1,
+        std::vector<GLfloat>& verts, std::vector<GLfloat>& norms,
+        std::vector<GLuint>& indices)
+{
+    auto is_wall = [&walls, width, height](int x, int z)
+    {
+        return x >= 0 && x < width && z >= 0 && z < height &&
+            walls[z * width + x];
+    };
+
+    // Merge the tops and bottoms.
+    int w = x1 - x0;
+    std::vector<bool> taken((z1 - z0) * w, false);
+    auto is_free = [&](int x, int z)
+    {
+        return is_wall(x, z) && !taken[(z - z0) * w + (x - x0)];
+    };
+    for (int z = z0; z < z1; z++)
+    {
+        for (int x = x0; x < x1; x++)
+        {
+            if (!is_free(x, z))
+                continue;
+
+            // Take as many cells of the row as possible.
+            int xe = x + 1;
+            while (xe < x1 && is_free(xe, z))
+                xe++;
+
+            // Then as many of the following rows as are free in full.
+            int ze = z + 1;
+            for (bool full = true; full && ze < z1; )
+            {
+                for (int i = x; i < xe && full; i++)
+                    full = is_free(i, ze);
+                if (full)
+                    ze++;
+            }
+
+            for (int j = z; j < ze; j++)
+            {
+                for (int i = x; i < xe; i++)
+                    taken[(j - z0) * w + (i - x0)] = true;
+            }
+
+            float sx = xe - x;
+            float sz = ze - z;
+            float cx = x + (sx - 1) / 2;
+            float cz = z + (sz - 1) / 2;
+            append_indexed_face(TOP, verts, norms, indices, sx, 1, sz, cx, 0,
+                    cz);
+            append_indexed_face(BOT, verts, norms, indices, sx, 1, sz, cx, 0,
+                    cz);
+        }
+    }
+
+    // Merge the fronts and backs along each row.
+    for (int z = z0; z < z1; z++)
+    {
+        for (int dz : {1, -1})
+        {
+            int x = x0;
+            while (x < x1)
+            {
+                if (!is_wall(x, z) || is_wall(x, z + dz))
+                {
+                    x++;
+                    continue;
+                }
+
+                int xe = x + 1;
+                while (xe < x1 && is_wall(xe, z) && !is_wall(xe, z + dz))
+                    xe++;
+
+                float sx = xe - x;
+                append_indexed_face((dz > 0) ? FRONT : BACK, verts, norms,
+                        indices, sx, 1, 1, x + (sx - 1) / 2, 0, z);
+                x = xe;
+            }
+        }
+    }
+
+    // Merge the lefts and rights along each column.
+    for (int x = x0; x < x1; x++)
+    {
+        for (int dx : {1, -1})
+        {
+            int z = z0;
+            while (z < z1)
+            {
+                if (!is_wall(x, z) || is_wall(x + dx, z))
+                {
+                    z++;
+                    continue;
+                }
+
+                int ze = z + 1;
+                while (ze < z1 && is_wall(x, ze) && !is_wall(x + dx, ze))
+                    ze++;
+
+                float sz = ze - z;
+                append_indexed_face((dx > 0) ? RIGHT : LEFT, verts, norms,
+                        indices, 1, 1, sz, x, 0, z + (sz - 1) / 2);
+                z = ze;
+            }
+        }
+    }
+}
@@ -42,7 +42,39 @@ class OpenGLBox
         // Returns the right normals for the box.
         static std::vector<GLfloat> get_right_normals();
 
+        // Appends the vertices and normals of every face of the box.
+        static void append_box(std::vector<GLfloat>&, std::vector<GLfloat>&,
+                float, float, float, float, float, float);
+
+        // The faces of the box, for append_indexed_face().
+        static const int FRONT = 0;
+        static const int BACK = 1;
+        static const int TOP = 2;
+        static const int BOT = 3;
+        static const int LEFT = 4;
+        static const int RIGHT = 5;
+
+        // Appends the four corners of a face, its normals and its indices.
+        static void append_indexed_face(int, std::vector<GLfloat>&,
+                std::vector<GLfloat>&, std::vector<GLuint>&, float, float,
+                float, float, float, float);
+        // Appends the corners, normals and indices of every face of the box.
+        static void append_indexed_box(std::vector<GLfloat>&,
+                std::vector<GLfloat>&, std::vector<GLuint>&, float, float,
+                float, float, float, float);
+        // Appends the visible faces of the unit walls in part of a layout,
+        // merged into as few faces as possible.
+        static void append_walls(const std::vector<bool>&, int, int, int, int,
+                int, int, std::vector<GLfloat>&, std::vector<GLfloat>&,
+                std::vector<GLuint>&);
+
     private:
+        // Appends the vertices and normals of a face.
+        static void append_face(const std::vector<GLfloat>&,
+                const std::vector<GLfloat>&, std::vector<GLfloat>&,
+                std::vector<GLfloat>&, float, float, float, float, float,
+                float);
+
 
         // Vertex array for a cube.
         static std::vector<GLfloat> front_vertices; 
@@ -52,6 +84,10 @@ class OpenGLBox
         static std::vector<GLfloat> bot_vertices; 
         static std::vector<GLfloat> back_vertices; 
 
+        // The vertex and normal arrays of each face, by face.
+        static const std::vector<GLfloat> *face_vertices[6];
+        static const std::vector<GLfloat> *face_normals[6];
+
         // Normal array for a cube.
         static std::vector<GLfloat> front_normals; 
         static std::vector<GLfloat> right_normals; 
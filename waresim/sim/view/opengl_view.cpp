@@ -4,7 +4,11 @@
 
 #include <GL/glew.h>
 #include <GL/glfw.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <thread>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -36,8 +40,14 @@ OpenGLView::OpenGLView()
 OpenGLView::~OpenGLView()
 {
     // We need to delete the VBO.
+    reserve_instances(0);
     glDeleteBuffersARB(1, &workerVBO);
     glDeleteBuffersARB(1, &warehouseVBO);
+    glDeleteBuffersARB(1, &warehouseIBO);
+    glDeleteProgram(workerProgram);
+    glDeleteTextures((GLsizei) NUM_STATS, statTextures);
+    glDeleteBuffers(1, &statVBO);
+    glDeleteProgram(statProgram);
 
 }
 
@@ -108,6 +118,45 @@ void OpenGLView::init()
 	// Create the vertex buffer object for the text.
 	glGenBuffers(1, &textVBO);
 
+    // Create the statistics shader.
+    statProgram = create_program("shaders/stat.v.glsl", "shaders/stat.f.glsl");
+    if (statProgram == 0)
+        std::cout << "Error creating program." << std::endl;
+
+    // Get its attributes.
+    stat_attribute_coord = get_attrib(statProgram, "coord");
+    stat_uniform_tex = get_uniform(statProgram, "tex");
+    stat_uniform_cells = get_uniform(statProgram, "cells");
+    stat_uniform_pixels = get_uniform(statProgram, "pixels");
+    if (stat_attribute_coord == -1 || stat_uniform_tex == -1 ||
+            stat_uniform_cells == -1 || stat_uniform_pixels == -1)
+        std::cout << "Error setting shader attributes." << std::endl;
+
+    // Create the vertex buffer object for the statistics.
+    glGenBuffers(1, &statVBO);
+
+    // Draw the workers with a single instanced draw call if the driver can.
+    // Otherwise each worker is drawn on its own.
+    if (GLEW_ARB_draw_instanced && GLEW_ARB_instanced_arrays)
+    {
+        workerProgram = create_program("shaders/worker.v.glsl",
+                "shaders/worker.f.glsl");
+        if (workerProgram != 0)
+        {
+            worker_attribute_coord = get_attrib(workerProgram, "coord");
+            worker_attribute_normal = get_attrib(workerProgram, "normal");
+            worker_attribute_color = get_attrib(workerProgram, "color");
+            worker_attribute_offset = get_attrib(workerProgram, "offset");
+            worker_uniform_lighting = get_uniform(workerProgram, "lighting");
+            worker_uniform_light0 = get_uniform(workerProgram, "light0");
+            instanced = worker_attribute_coord != -1 &&
+                worker_attribute_normal != -1 &&
+                worker_attribute_color != -1 &&
+                worker_attribute_offset != -1 &&
+                worker_uniform_lighting != -1 && worker_uniform_light0 != -1;
+        }
+    }
+
     // Set the viewing size.
     glViewport(0, 0, (GLsizei)desktop.Width, (GLsizei)desktop.Height);
     
@@ -236,47 +285,6 @@ void OpenGLView::shut_down()
     glfwCloseWindow();
 }
 
-/**
- * Sets the OpenGL color for a value mapped to a heatmap, where blue = 0.0 and
- * red = 1.0. 
- *
- * @param val A double value in the range [0.0,1.0].
- */
-void set_glColor_heat(double val)
-{
-    // Maps the RGB range (0,0,1) to (0,1,1) 
-    // for values in the range [0, 0.25).
-    if (0 <= val && val < 0.25)
-    {
-        glColor3f(0, val/0.25, 1);
-        return;
-    }
-
-    val -= 0.25;
-    // Maps the RGB range (0,1,1) to (0,1,0) 
-    // for values in the range [0.25, 0.50).
-    if (0 <= val && val < 0.25)
-    {
-        glColor3f(0, 1, 1-(val/0.25));
-        return;
-    }
-
-    val -= 0.25;
-    // Maps the RGB range (0,1,0) to (1,1,0) 
-    // for values in the range [0.50, 0.75).
-    if (0 <= val && val < 0.25)
-    {
-        glColor3f(val/0.25, 1, 0);
-        return;
-    }
-
-    val -= 0.25;
-    // Maps the RGB range (1,1,0) to (1,0,0) 
-    // for values in the range [0.75, 1).
-    glColor3f(1, 1-(val/0.25), 0);
-    return;
-}
-
 /**
  * Rendering function
  */
@@ -316,50 +324,24 @@ void OpenGLView::render()
      * Render the warehouse.
      */
 
-    // Bind the warehouse VBO.
-    glBindBufferARB(GL_ARRAY_BUFFER_ARB, warehouseVBO);
-
-    // Set the pointers.
-    glVertexPointer(3, GL_FLOAT, 0, 0);
-    glNormalPointer(GL_FLOAT, 0, (void*) warehouse_vert_len);
-    glColorPointer(3, GL_FLOAT, 0, 
-            (void*) (warehouse_vert_len + warehouse_norm_len));
-
     glPushMatrix();
     glTranslated(0,0,-warehouse->get_height());
-    glDrawArrays(GL_TRIANGLES, 0, num_warehouse_tris);
+    render_warehouse();
     glPopMatrix();
     
     /*
      * Render the workers.
      */
 
-    // Bind the workers VBO.
-    glBindBufferARB(GL_ARRAY_BUFFER_ARB, workerVBO);
- 
-    // Set the pointers.
-    glVertexPointer(3, GL_FLOAT, 0, 0);
-    glNormalPointer(GL_FLOAT, 0, (void*) worker_vert_len);
-    glColorPointer(3, GL_FLOAT, 0, 
-            (void*) (worker_vert_len + worker_norm_len));
+    render_workers();
 
-    // Render the workers.
-    for (auto& pos : warehouse->get_worker_locs())
-    {
-        // Translate the worker's position to a coordinate.
-        int x,z;
-        pos_to_coord(&x, &z, pos, warehouse->get_width());
- 
-        // Translate the 'y' coordinate to OpenGL's z coordinate.
-        z -= warehouse->get_height();
-        
-        // Move to the worker's location and draw the worker.
-        glPushMatrix();
-        glTranslated(x,0,z);
-        glDrawArrays(GL_TRIANGLES, 0, num_worker_tris);
-        glPopMatrix();
-    }
+    // Disable vertex arrays.
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
 
+    // Release VBOs after use.
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
 
     /*
      * Render 2D statistic projections.
@@ -373,221 +355,10 @@ void OpenGLView::render()
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    glPushMatrix();
-    // Trick for exact pixelation.
-    glTranslatef(0.375, 0.375, 0);
-
-    /*
-     * Render statistics.
-     */
-
-    // Determine how many points from the warehouse to group together, and how 
-    // many points paint at a time on the screen. We will group 'group_w'
-    // points together when calculating that color to paint 'paint_w' pixels.
-    // We need to group (or spread) the points because the warehouse
-    // representation and the allocated space to draw the statistics are
-    // different sizes.
-    int group_w, group_h, paint_w, paint_h;
-    int warehouse_w = warehouse->get_width();
-    int warehouse_h = warehouse->get_height();
-    
-    // There are less warehouse points than available points.
-    if (warehouse_w < stat_w)
-    {
-        group_w = 1;
-        paint_w = stat_w / warehouse_w;
-    }
-    else // There are more warehouse points than available points.
-    {
-        // TODO Implement.
-        throw "not implemented yet";
-    }
-    // There are less warehouse points than available points. 
-    if (warehouse_h < stat_h)
-    {
-        group_h = 1;
-        paint_h = stat_h / warehouse_h;
-    }
-    else // There are more warehouse points that available points.
-    {
-        // TODO Implement.
-        throw "not implemented yet";
-    }
-    
-    // Track the max heat window.
-    double max_heat_window = 0;
-    auto heat_window = warehouse->get_heat_window();
-    std::vector<double> hw_vals{};
-    
-    double max_heat_total = 0;
-    auto heat_total = warehouse->get_heat_total();
-    std::vector<double> ht_vals{};
-
-    double max_contentions = 0;
-    auto contentions = warehouse->get_contention_spots();
-    std::vector<double> cont_vals{};
-
-    double max_deadlocks = 0;
-    auto deadlocks = warehouse->get_deadlock_spots();
-    std::vector<double> dead_vals{};
-
-    // TODO Clean up this loop and the following loop.
-    // TODO We run this loop twice because the first time we find the value,
-    // which we will use in the following loop to normalize the values before
-    // we render them.
-    for (int x_offset = 0, num_x = 0; num_x <= ceil(1.0*warehouse_w / group_w); x_offset+=group_w, num_x++)
-    {
-        for (int y_offset = 0, num_y = 0; num_y <= ceil(1.0*warehouse_h/ group_h); y_offset+=group_h, num_y++)
-        {
-            // Start forming this group.
-            int group_size = 0;
-
-            // Sum for the heat window.
-            double hw_sum = 0;
-            // Sum for the total heat.
-            double ht_sum = 0;
-            // Sum for the contentions.
-            double cont_sum = 0;
-            // Sum for the deadlocks.
-            double dead_sum = 0;
-
-            for (int x = 0; x < group_w && x+x_offset < warehouse_w; x++)
-            {
-                for (int y = 0; y < group_h && y+y_offset < warehouse_h; y++)
-                {
-                    group_size++;
-                    int pos = coord_to_pos(x+x_offset, y+y_offset, warehouse_w);
-
-                    // Update values.
-                    hw_sum += heat_window[pos];
-                    ht_sum += heat_total[pos];
-                    auto cont_it = contentions.find(pos);
-                    if (cont_it != contentions.end()) cont_sum += cont_it->second;
-                    auto dead_it = deadlocks.find(pos);
-                    if (dead_it != deadlocks.end()) dead_sum += dead_it->second;
-                }
-            }
-             
-            // Calculate values for this group.
-            if (group_size > 0)
-            {
-                // Average the values. We need this because if the warehouse size
-                // was greater than the viewing window, we will need to merge
-                // some points when rendering.
-                hw_sum /= group_size;
-                ht_sum /= group_size;
-                cont_sum /= group_size;
-                dead_sum /= group_size;
-
-                // Update the max values.
-                if (hw_sum > max_heat_window) max_heat_window = hw_sum;
-                if (ht_sum > max_heat_total) max_heat_total = ht_sum;
-                if (cont_sum > max_contentions) max_contentions = cont_sum;
-                if (dead_sum > max_deadlocks) max_deadlocks = dead_sum;
-
-                // Save the values.
-                hw_vals.push_back(hw_sum);
-                ht_vals.push_back(ht_sum);
-                cont_vals.push_back(cont_sum);
-                dead_vals.push_back(dead_sum);
-            }
-        }
-    }
-
-    // We need to align the text based on the last point where pixels were
-    // painted for the statistics. I didn't have time to derive the equation
-    // for this so I will calculate it at runtime.
-    int text_x_align = 0;
-
-    glBegin(GL_TRIANGLES);
-    int index = 0;
-    // This is the loop where we will actually render the statistics.
-    // TODO this is basically the same as the previous loop, but until we clean
-    // up the previous loop's logic we have to do this.
-    for (int x_offset = 0, num_x = 0; num_x <= ceil(1.0*warehouse_w / group_w); x_offset+=group_w, num_x++)
-    {
-        for (int y_offset = 0, num_y = 0; num_y <= ceil(1.0*warehouse_h/ group_h); y_offset+=group_h, num_y++)
-        {    
-
-            int group_size = 0;
-            for (int x = 0; x < group_w && x+x_offset < warehouse_w; x++)
-                for (int y = 0; y < group_h && y+y_offset < warehouse_h; y++)
-                    group_size++;
+    render_stats();
 
-            // Calculate the average for this group and paint.
-            if (group_size > 0)
-            {
-
-                // Get the values.
-                double hw_sum = hw_vals[index];
-                double ht_sum = ht_vals[index];
-                double cont_sum = cont_vals[index];
-                double dead_sum = dead_vals[index];
-
-                // Normalize the values.
-                if (max_heat_window > 0)
-                    hw_sum /= max_heat_window;
-                if (max_heat_total > 0)
-                    ht_sum /= max_heat_total;
-
-                // Update the index.
-                index++;
-
-                // TODO Optimize. Draw pre-colored VBOs instead.
-
-                // Update where the text needs to be aligned. This corresponds
-                // to the right-most pixel that was painted.
-                text_x_align = paint_w * x_offset + paint_w;
-
-                // Draw the heat window.
-                set_glColor_heat(hw_sum); 
-                glVertex2f(paint_w*x_offset, paint_h*y_offset);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset+paint_h);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+paint_h);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+paint_h);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset);
-
-                // Draw the total heat.
-                set_glColor_heat(ht_sum);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset + stat_h + STAT_SEP);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset+paint_h+stat_h + STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+paint_h+stat_h + STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+paint_h+stat_h + STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+stat_h + STAT_SEP);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset+stat_h + STAT_SEP);
-
-                // Draw the contentions.
-                set_glColor_heat(cont_sum);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset + 2*stat_h + 2*STAT_SEP);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset+paint_h+2*stat_h + 2*STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+paint_h+2*stat_h + 2*STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+paint_h+2*stat_h + 2*STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+2*stat_h + 2*STAT_SEP);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset+2*stat_h + 2*STAT_SEP);
-
-                // Draw the deadlocks.
-                set_glColor_heat(dead_sum);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset + 3*stat_h + 3*STAT_SEP);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset+paint_h+3*stat_h + 3*STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+paint_h+3*stat_h + 3*STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+paint_h+3*stat_h + 3*STAT_SEP);
-                glVertex2f(paint_w*x_offset+paint_w, paint_h*y_offset+3*stat_h + 3*STAT_SEP);
-                glVertex2f(paint_w*x_offset, paint_h*y_offset+3*stat_h + 3*STAT_SEP);
-                
-            } 
-        }
-    } 
-    glEnd();
-    glPopMatrix();
-    
-    // Disable vertex arrays.
-    glDisableClientState(GL_VERTEX_ARRAY);
-    glDisableClientState(GL_COLOR_ARRAY);
-    glDisableClientState(GL_NORMAL_ARRAY);
-
-    // Release VBOs after use.
-    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    // The text is aligned with the right edge of the statistics.
+    int text_x_align = stat_w;
 
     /*
      * Render text for the statistics.
@@ -626,12 +397,405 @@ void OpenGLView::render()
     // Deadlock's text.
     render_text("Deadlocks", -1 + text_x_align * sx, 1 - (3*stat_h + 25) * sy, sx, sy);
 
+    render_frame_time(sx, sy);
+
     // Stop using the text shader.
     glUseProgram(0);
 
+    // Time the draw calls before the swap, which may wait for the vertical
+    // sync.
+    double draw_end = glfwGetTime();
 
     // Swap back and front buffers
     glfwSwapBuffers();
+
+    // Update the average frame and draw times.
+    double now = glfwGetTime();
+    if (frame_end > 0)
+    {
+        frame_time += FRAME_TIME_WEIGHT * ((now - frame_end) - frame_time);
+        draw_time += FRAME_TIME_WEIGHT * ((draw_end - frame_end) - draw_time);
+    }
+    frame_end = now;
+}
+
+/**
+ * Render the statistics, one above the other on the left of the screen. The
+ * warehouse keeps each statistic summed over coarser and coarser levels, and
+ * the finest level that fits in the space the statistics are drawn in is
+ * uploaded to a texture, one texel per cell, and drawn as a single quad. The
+ * shader colors each pixel and averages the cells it covers. The CPU cost
+ * therefore depends on the size of the screen, not of the warehouse.
+ */
+void OpenGLView::render_stats()
+{
+    // The heat is normalized by its maximum.
+    upload_stat(0, warehouse->get_heat_window_pyramid(), true);
+    upload_stat(1, warehouse->get_heat_total_pyramid(), true);
+    // The contentions and deadlocks are counts, so any spot with one is red.
+    upload_stat(2, warehouse->get_contention_pyramid(), false);
+    upload_stat(3, warehouse->get_deadlock_pyramid(), false);
+
+    const StatPyramid& pyramid = warehouse->get_heat_window_pyramid();
+    glUseProgram(statProgram);
+    glUniform2f(stat_uniform_cells, pyramid.get_level_width(stat_level),
+            pyramid.get_level_height(stat_level));
+    glUniform2f(stat_uniform_pixels, stat_w, stat_h);
+
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(stat_uniform_tex, 0);
+
+    glEnableVertexAttribArray(stat_attribute_coord);
+    glBindBuffer(GL_ARRAY_BUFFER, statVBO);
+    glVertexAttribPointer(stat_attribute_coord, 4, GL_FLOAT, GL_FALSE, 0, 0);
+
+    for (int k = 0; k < NUM_STATS; k++)
+    {
+        GLfloat top = k * (stat_h + STAT_SEP);
+        point box[4] = {
+            {0, top, 0, 0},
+            {(GLfloat) stat_w, top, 1, 0},
+            {0, top + stat_h, 0, 1},
+            {(GLfloat) stat_w, top + stat_h, 1, 1},
+        };
+
+        glBindTexture(GL_TEXTURE_2D, statTextures[k]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof box, box, GL_DYNAMIC_DRAW);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+    glDisableVertexAttribArray(stat_attribute_coord);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+}
+
+/**
+ * Upload a level of a statistic to its texture. Each texel is the mean of the
+ * cells it covers.
+ *
+ * @param index The index of the statistic.
+ * @param pyramid The statistic.
+ * @param normalize Whether to divide the values by their maximum.
+ */
+void OpenGLView::upload_stat(int index, const StatPyramid& pyramid,
+        bool normalize)
+{
+    pyramid.get_level_means(stat_level, stat_texels);
+
+    if (normalize && !stat_texels.empty())
+    {
+        GLfloat max = *std::max_element(stat_texels.begin(), stat_texels.end());
+        if (max > 0)
+        {
+            for (auto& texel : stat_texels)
+                texel /= max;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, statTextures[index]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, pyramid.get_level_width(stat_level),
+            pyramid.get_level_height(stat_level), GL_LUMINANCE, GL_FLOAT,
+            &stat_texels[0]);
+}
+
+/**
+ * Render the chunks of the warehouse that may be visible. Each chunk is tested
+ * against the frustum of the current matrices, and the chunks that pass are
+ * drawn by a single call.
+ */
+void OpenGLView::render_warehouse()
+{
+    GLfloat projection[16];
+    GLfloat modelview[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    frustum.extract(projection, modelview);
+
+    chunk_offsets.clear();
+    chunk_counts.clear();
+    for (auto& chunk : chunks)
+    {
+        if (!frustum.intersects(chunk.min, chunk.max))
+            continue;
+        chunk_offsets.push_back(
+                (const GLvoid*) (chunk.first * sizeof(GLuint)));
+        chunk_counts.push_back(chunk.count);
+    }
+
+    if (chunk_offsets.empty())
+        return;
+
+    // Bind the warehouse VBO.
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, warehouseVBO);
+
+    // Set the pointers.
+    glVertexPointer(3, GL_FLOAT, 0, 0);
+    glNormalPointer(GL_FLOAT, 0, (void*) warehouse_vert_len);
+    glColorPointer(3, GL_FLOAT, 0, 
+            (void*) (warehouse_vert_len + warehouse_norm_len));
+
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, warehouseIBO);
+    glMultiDrawElements(GL_TRIANGLES, &chunk_counts[0], GL_UNSIGNED_INT,
+            &chunk_offsets[0], chunk_offsets.size());
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+}
+
+/**
+ * Finds where to draw each worker. The workers are drawn one tick behind the
+ * simulation, between the last two snapshots it published, and move from the
+ * first to the second over the time that passed between them. The view thus
+ * moves smoothly however fast the simulation runs, and never reads the
+ * workers while they are being moved. Until a snapshot is published the
+ * workers are drawn where they start.
+ */
+void OpenGLView::interpolate_workers()
+{
+    int warehouse_w = warehouse->get_width();
+    int warehouse_h = warehouse->get_height();
+    worker_coords.clear();
+
+    if (snapshots != nullptr)
+        snapshots->read(previous_snapshot, latest_snapshot);
+
+    if (snapshots == nullptr || latest_snapshot.tick < 0)
+    {
+        for (auto& pos : warehouse->get_worker_locs())
+        {
+            int x,z;
+            pos_to_coord(&x, &z, pos, warehouse_w);
+            worker_coords.push_back(x);
+            worker_coords.push_back(z - warehouse_h);
+        }
+        return;
+    }
+
+    // How far to move from the previous snapshot to the latest one.
+    const std::vector<int>& from = previous_snapshot.positions;
+    const std::vector<int>& to = latest_snapshot.positions;
+    double interval = latest_snapshot.time - previous_snapshot.time;
+    double alpha = 1;
+    if (interval > 0 && from.size() == to.size())
+    {
+        alpha = (SnapshotBuffer::now() - latest_snapshot.time) / interval;
+        alpha = std::max(0.0, std::min(1.0, alpha));
+    }
+
+    // Translate the 'y' coordinate to OpenGL's z coordinate.
+    for (std::size_t i = 0; i < to.size(); i++)
+    {
+        int x1, z1;
+        pos_to_coord(&x1, &z1, to[i], warehouse_w);
+        int x0 = x1, z0 = z1;
+        if (alpha < 1)
+            pos_to_coord(&x0, &z0, from[i], warehouse_w);
+
+        worker_coords.push_back(x0 + alpha * (x1 - x0));
+        worker_coords.push_back(z0 + alpha * (z1 - z0) - warehouse_h);
+    }
+}
+
+/**
+ * Render the workers. Their offsets are written to the instance buffer and
+ * every worker is drawn by a single instanced draw call. If the buffer is
+ * persistently mapped the offsets are written straight into it, in a region
+ * the GPU is no longer reading, so the buffer is never mapped or copied during
+ * the frame. Without instancing each worker is drawn on its own.
+ */
+void OpenGLView::render_workers()
+{
+    interpolate_workers();
+    std::size_t num_workers = worker_coords.size() / 2;
+
+    // Bind the workers VBO.
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, workerVBO);
+
+    if (!instanced)
+    {
+        // Set the pointers.
+        glVertexPointer(3, GL_FLOAT, 0, 0);
+        glNormalPointer(GL_FLOAT, 0, (void*) worker_vert_len);
+        glColorPointer(3, GL_FLOAT, 0,
+                (void*) (worker_vert_len + worker_norm_len));
+
+        for (std::size_t i = 0; i < num_workers; i++)
+        {
+            // Move to the worker's location and draw the worker.
+            glPushMatrix();
+            glTranslated(worker_coords[2*i], 0, worker_coords[2*i + 1]);
+            glDrawArrays(GL_TRIANGLES, 0, num_worker_tris);
+            glPopMatrix();
+        }
+        return;
+    }
+
+    if (num_workers == 0)
+        return;
+    if (num_workers > instance_capacity)
+        reserve_instances(std::max(num_workers, 2 * instance_capacity));
+
+    // Find where this frame's offsets go.
+    GLfloat *offsets = instance_offsets.data();
+    std::size_t first = 0;
+    if (instance_data != nullptr)
+    {
+        instance_region = (instance_region + 1) % INSTANCE_REGIONS;
+        first = instance_region * instance_capacity * 2;
+        offsets = instance_data + first;
+
+        // Wait for the GPU to finish the frame that last used this region.
+        GLsync& fence = instance_fences[instance_region];
+        if (fence != nullptr)
+        {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    // Write the offset of each worker.
+    std::copy(worker_coords.begin(), worker_coords.end(), offsets);
+
+    glUseProgram(workerProgram);
+
+    // Light the workers like the rest of the scene.
+    glUniform1i(worker_uniform_lighting, glIsEnabled(GL_LIGHTING));
+    glUniform1i(worker_uniform_light0, glIsEnabled(GL_LIGHT0));
+
+    // The cube is shared by every worker.
+    glEnableVertexAttribArray(worker_attribute_coord);
+    glVertexAttribPointer(worker_attribute_coord, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(worker_attribute_normal);
+    glVertexAttribPointer(worker_attribute_normal, 3, GL_FLOAT, GL_FALSE, 0,
+            (void*) worker_vert_len);
+    glEnableVertexAttribArray(worker_attribute_color);
+    glVertexAttribPointer(worker_attribute_color, 3, GL_FLOAT, GL_FALSE, 0,
+            (void*) (worker_vert_len + worker_norm_len));
+
+    // Each worker has its own offset.
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, instanceVBO);
+    if (instance_data == nullptr)
+    {
+        // Orphan the buffer so we do not wait for the GPU to read it.
+        glBufferDataARB(GL_ARRAY_BUFFER_ARB,
+                instance_offsets.size() * sizeof(GLfloat), 0,
+                GL_STREAM_DRAW_ARB);
+        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0,
+                num_workers * 2 * sizeof(GLfloat), offsets);
+    }
+    glEnableVertexAttribArray(worker_attribute_offset);
+    glVertexAttribPointer(worker_attribute_offset, 2, GL_FLOAT, GL_FALSE, 0,
+            (void*) (first * sizeof(GLfloat)));
+    glVertexAttribDivisorARB(worker_attribute_offset, 1);
+
+    glDrawArraysInstancedARB(GL_TRIANGLES, 0, num_worker_tris, num_workers);
+
+    if (instance_data != nullptr)
+    {
+        instance_fences[instance_region] =
+            glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    glVertexAttribDivisorARB(worker_attribute_offset, 0);
+    glDisableVertexAttribArray(worker_attribute_offset);
+    glDisableVertexAttribArray(worker_attribute_color);
+    glDisableVertexAttribArray(worker_attribute_normal);
+    glDisableVertexAttribArray(worker_attribute_coord);
+    glUseProgram(0);
+}
+
+/**
+ * Make room in the instance buffer for the offsets of a number of workers,
+ * replacing the old buffer. The buffer is split into INSTANCE_REGIONS regions
+ * and persistently mapped if the driver supports buffer storage. Otherwise it
+ * holds a single region that is orphaned every frame.
+ *
+ * @param count The number of workers, or 0 to only delete the buffer.
+ */
+void OpenGLView::reserve_instances(std::size_t count)
+{
+    // Delete the old buffer once the GPU no longer needs it.
+    for (auto& fence : instance_fences)
+    {
+        if (fence != nullptr)
+        {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (instanceVBO != 0)
+    {
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, instanceVBO);
+        if (instance_data != nullptr)
+            glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+        glDeleteBuffersARB(1, &instanceVBO);
+    }
+    instanceVBO = 0;
+    instance_data = nullptr;
+    instance_offsets.clear();
+    instance_capacity = 0;
+
+    if (count == 0)
+        return;
+
+    glGenBuffersARB(1, &instanceVBO);
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, instanceVBO);
+
+    if (GLEW_ARB_buffer_storage)
+    {
+        GLbitfield flags =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLsizeiptr size = INSTANCE_REGIONS * count * 2 * sizeof(GLfloat);
+        glBufferStorage(GL_ARRAY_BUFFER_ARB, size, 0, flags);
+        instance_data = (GLfloat *) glMapBufferRange(GL_ARRAY_BUFFER_ARB, 0,
+                size, flags);
+
+        // Buffer storage is immutable, so start again with a new buffer.
+        if (instance_data == nullptr)
+        {
+            glDeleteBuffersARB(1, &instanceVBO);
+            glGenBuffersARB(1, &instanceVBO);
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, instanceVBO);
+        }
+    }
+
+    if (instance_data == nullptr)
+    {
+        instance_offsets.assign(count * 2, 0);
+        glBufferDataARB(GL_ARRAY_BUFFER_ARB, count * 2 * sizeof(GLfloat), 0,
+                GL_STREAM_DRAW_ARB);
+    }
+
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    instance_capacity = count;
+}
+
+/**
+ * Render the average frame time in the top right corner, along with the time
+ * spent issuing the draw calls, how the workers are drawn and how many chunks
+ * of the warehouse were drawn. Must be called with the text shader in use.
+ *
+ * @param sx The horizontal scale of the text.
+ * @param sy The vertical scale of the text.
+ */
+void OpenGLView::render_frame_time(float sx, float sy)
+{
+    char text[128];
+    std::snprintf(text, sizeof text, "Frame %.2f ms (%.0f fps), draw %.2f ms",
+            frame_time * 1000, (frame_time > 0) ? 1 / frame_time : 0.0,
+            draw_time * 1000);
+    render_text(text, 1 - 420 * sx, 1 - 25 * sy, sx, sy);
+
+    std::snprintf(text, sizeof text, "%zu workers, %s",
+            worker_coords.size() / 2,
+            instanced ? "instanced" : "one draw each");
+    render_text(text, 1 - 420 * sx, 1 - 55 * sy, sx, sy);
+
+    std::snprintf(text, sizeof text, "%zu of %zu chunks drawn",
+            chunk_offsets.size(), chunks.size());
+    render_text(text, 1 - 420 * sx, 1 - 85 * sy, sx, sy);
 }
 
 /**
@@ -803,183 +967,138 @@ void OpenGLView::setup()
     glGenBuffersARB(1, &warehouseVBO);
     glBindBufferARB(GL_ARRAY_BUFFER_ARB, warehouseVBO);
 
-    std::vector<GLfloat> warehouse_verts{};
-    std::vector<GLfloat> warehouse_norms{};
-    std::vector<GLfloat> warehouse_colors{};
-
-    // Add the warehouse floor. We use 'top' so we can see the floor.
-    // We move the top -1 units down (so it acts as a floor) and re-align it.
-    auto floor = OpenGLBox::get_top_vertices(warehouse->get_width(), 
-            1, warehouse->get_height(), warehouse->get_width()/2.0f-0.5f, -1, 
-            warehouse->get_height()/2.0f-0.5f);
-    warehouse_verts.insert(warehouse_verts.end(), floor.begin(), floor.end());
-    auto floorn = OpenGLBox::get_top_normals();
-    warehouse_norms.insert(warehouse_norms.end(), floorn.begin(), floorn.end());
-    for (int i = 0; i < 2; i++)
+    // The size and color of the box drawn for each bin and drop off.
+    struct Kind
     {
-        warehouse_colors.insert(warehouse_colors.end(), default_warehouse_color.begin(), 
-                default_warehouse_color.end());
+        float x, y, z;
+        const std::vector<GLfloat> *color;
+    };
+    const Kind kinds[] = {
+        {BIN_X, BIN_Y, BIN_Z, &bin_color},
+        {DROP_X, DROP_Y, DROP_Z, &drop_color},
+    };
+    const std::vector<int> positions[] = {
+        warehouse->get_bins(),
+        warehouse->get_drops(),
+    };
+
+    // Sort the boxes into square chunks of the floor, so that each chunk can
+    // be stored in one range of the VBO and skipped when it is out of sight.
+    int chunks_w = (warehouse_w + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int chunks_h = (warehouse_h + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    // The position and kind of each box, by chunk.
+    std::vector<std::vector<std::pair<int, int>>> chunk_boxes(chunks_w * chunks_h);
+    std::size_t num_boxes = 0;
+    for (int k = 0; k < 2; k++)
+    {
+        for (auto& pos : positions[k])
+        {
+            int x,z;
+            pos_to_coord(&x, &z, pos, warehouse_w);
+            chunk_boxes[coord_to_pos(x / CHUNK_SIZE, z / CHUNK_SIZE, chunks_w)]
+                .push_back({pos, k});
+        }
+        num_boxes += positions[k].size();
     }
-    num_warehouse_tris += 2;
-
-    // Note: the loops for adding the walls, bins, and drop locs is very
-    // similar. However, we leave them separated in case we decide to render
-    // each entity with a different representation than a box.
 
-    // Add each wall.
+    // The walls are merged with their neighbours rather than drawn as boxes.
+    std::vector<bool> walls(warehouse_w * warehouse_h, false);
     for (auto& pos : warehouse->get_walls())
     {
-        num_warehouse_tris += 36;
-
-        // Translate the position to a coordinate.
-        int x,z;
-        pos_to_coord(&x, &z, pos, warehouse->get_width());
-
-         // Form vertices.
-        auto ffront = OpenGLBox::get_front_vertices(1, 1, 1, x, 0, z);
-        auto fback = OpenGLBox::get_back_vertices(1, 1, 1, x, 0, z);
-        auto ftop = OpenGLBox::get_top_vertices(1, 1, 1, x, 0, z);
-        auto fbot = OpenGLBox::get_bot_vertices(1, 1, 1, x, 0, z);
-        auto fleft = OpenGLBox::get_left_vertices(1, 1, 1, x, 0, z);
-        auto fright = OpenGLBox::get_right_vertices(1, 1, 1, x, 0, z);
-
-        // Add the vertices.
-        warehouse_verts.insert(warehouse_verts.end(), ffront.begin(), ffront.end());
-        warehouse_verts.insert(warehouse_verts.end(), fback.begin(), fback.end());
-        warehouse_verts.insert(warehouse_verts.end(), ftop.begin(), ftop.end());
-        warehouse_verts.insert(warehouse_verts.end(), fbot.begin(), fbot.end());
-        warehouse_verts.insert(warehouse_verts.end(), fleft.begin(), fleft.end());
-        warehouse_verts.insert(warehouse_verts.end(), fright.begin(), fright.end());
-
-        // Form normals.
-        auto fnfront = OpenGLBox::get_front_normals();
-        auto fnback = OpenGLBox::get_back_normals();
-        auto fntop = OpenGLBox::get_top_normals();
-        auto fnbot = OpenGLBox::get_bot_normals();
-        auto fnleft = OpenGLBox::get_left_normals();
-        auto fnright = OpenGLBox::get_right_normals();
-
-        // Add the normals.
-        warehouse_norms.insert(warehouse_norms.end(), fnfront.begin(), fnfront.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnback.begin(), fnback.end());
-        warehouse_norms.insert(warehouse_norms.end(), fntop.begin(), fntop.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnbot.begin(), fnbot.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnleft.begin(), fnleft.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnright.begin(), fnright.end());
-
-        // Add the colors.
-        // Insert twice for each face because each face is two triangles.
-        for (int i = 0; i < 12; i++)
-        {
-            warehouse_colors.insert(warehouse_colors.end(), 
-                    default_wall_color.begin(), default_wall_color.end());
-        }   
+        walls[pos] = true;
+        num_boxes++;
     }
 
-    // Add each bin.
-    for (auto& pos : warehouse->get_bins())
+    // A box has at most 24 vertices and 36 indices, and the floor has 4 and
+    // 6. There are 3 floats for each vertex, normal, and color.
+    std::size_t num_floats = (num_boxes * 24 + 4) * 3;
+    std::vector<GLfloat> warehouse_verts{};
+    std::vector<GLfloat> warehouse_norms{};
+    std::vector<GLfloat> warehouse_colors{};
+    std::vector<GLuint> warehouse_indices{};
+    warehouse_verts.reserve(num_floats);
+    warehouse_norms.reserve(num_floats);
+    warehouse_colors.reserve(num_floats);
+    warehouse_indices.reserve(num_boxes * 36 + 6);
+
+    // Colors the vertices added since the last call.
+    auto add_colors = [&warehouse_verts, &warehouse_colors](
+            const std::vector<GLfloat>& color)
     {
-        num_warehouse_tris += 36;
-
-        // Translate the position to a coordinate.
-        int x,z;
-        pos_to_coord(&x, &z, pos, warehouse->get_width());
-
-         // Form vertices.
-        auto ffront = OpenGLBox::get_front_vertices(BIN_X, BIN_Y, BIN_Z, x, 0, z);
-        auto fback = OpenGLBox::get_back_vertices(BIN_X, BIN_Y, BIN_Z, x, 0, z);
-        auto ftop = OpenGLBox::get_top_vertices(BIN_X, BIN_Y, BIN_Z, x, 0, z);
-        auto fbot = OpenGLBox::get_bot_vertices(BIN_X, BIN_Y, BIN_Z, x, 0, z);
-        auto fleft = OpenGLBox::get_left_vertices(BIN_X, BIN_Y, BIN_Z, x, 0, z);
-        auto fright = OpenGLBox::get_right_vertices(BIN_X, BIN_Y, BIN_Z, x, 0, z);
-
-        // Add vertices.
-        warehouse_verts.insert(warehouse_verts.end(), ffront.begin(), ffront.end());
-        warehouse_verts.insert(warehouse_verts.end(), fback.begin(), fback.end());
-        warehouse_verts.insert(warehouse_verts.end(), ftop.begin(), ftop.end());
-        warehouse_verts.insert(warehouse_verts.end(), fbot.begin(), fbot.end());
-        warehouse_verts.insert(warehouse_verts.end(), fleft.begin(), fleft.end());
-        warehouse_verts.insert(warehouse_verts.end(), fright.begin(), fright.end());
-
-        // Form normals.
-        auto fnfront = OpenGLBox::get_front_normals();
-        auto fnback = OpenGLBox::get_back_normals();
-        auto fntop = OpenGLBox::get_top_normals();
-        auto fnbot = OpenGLBox::get_bot_normals();
-        auto fnleft = OpenGLBox::get_left_normals();
-        auto fnright = OpenGLBox::get_right_normals();
-
-        // Add the normals.
-        warehouse_norms.insert(warehouse_norms.end(), fnfront.begin(), fnfront.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnback.begin(), fnback.end());
-        warehouse_norms.insert(warehouse_norms.end(), fntop.begin(), fntop.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnbot.begin(), fnbot.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnleft.begin(), fnleft.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnright.begin(), fnright.end());
-
-        // Add colors.
-        // Insert twice for each face because each face is two triangles.
-        for (int i = 0; i < 12; i++)
+        while (warehouse_colors.size() < warehouse_verts.size())
         {
-            warehouse_colors.insert(warehouse_colors.end(), 
-                    bin_color.begin(), bin_color.end());
-        }   
-    }
+            warehouse_colors.insert(warehouse_colors.end(), color.begin(),
+                    color.begin() + 3);
+        }
+    };
 
-    // Add drop offs.
-    for (auto& pos : warehouse->get_drops())
+    // Add the warehouse floor as a chunk of its own, since it covers every
+    // other chunk. We use 'top' so we can see the floor.
+    // We move the top -1 units down (so it acts as a floor) and re-align it.
+    Chunk floor;
+    OpenGLBox::append_indexed_face(OpenGLBox::TOP, warehouse_verts,
+            warehouse_norms, warehouse_indices, warehouse_w, 1, warehouse_h,
+            warehouse_w/2.0f-0.5f, -1, warehouse_h/2.0f-0.5f);
+    add_colors(default_warehouse_color);
+    floor.count = warehouse_indices.size();
+    floor.min[0] = -0.5f;
+    floor.min[1] = -0.5f;
+    floor.min[2] = -0.5f;
+    floor.max[0] = warehouse_w - 0.5f;
+    floor.max[1] = -0.5f;
+    floor.max[2] = warehouse_h - 0.5f;
+    chunks.push_back(floor);
+
+    // Add the walls and boxes of each chunk.
+    for (int cz = 0; cz < chunks_h; cz++)
     {
-        num_warehouse_tris += 36;
-
-        // Translate the position to a coordinate.
-        int x,z;
-        pos_to_coord(&x, &z, pos, warehouse->get_width());
-
-         // Form vertices.
-        auto ffront = OpenGLBox::get_front_vertices(DROP_X, DROP_Y, DROP_Z, x, 0, z);
-        auto fback = OpenGLBox::get_back_vertices(DROP_X, DROP_Y, DROP_Z, x, 0, z);
-        auto ftop = OpenGLBox::get_top_vertices(DROP_X, DROP_Y, DROP_Z, x, 0, z);
-        auto fbot = OpenGLBox::get_bot_vertices(DROP_X, DROP_Y, DROP_Z, x, 0, z);
-        auto fleft = OpenGLBox::get_left_vertices(DROP_X, DROP_Y, DROP_Z, x, 0, z);
-        auto fright = OpenGLBox::get_right_vertices(DROP_X, DROP_Y, DROP_Z, x, 0, z);
-
-        // Add vertices.
-        warehouse_verts.insert(warehouse_verts.end(), ffront.begin(), ffront.end());
-        warehouse_verts.insert(warehouse_verts.end(), fback.begin(), fback.end());
-        warehouse_verts.insert(warehouse_verts.end(), ftop.begin(), ftop.end());
-        warehouse_verts.insert(warehouse_verts.end(), fbot.begin(), fbot.end());
-        warehouse_verts.insert(warehouse_verts.end(), fleft.begin(), fleft.end());
-        warehouse_verts.insert(warehouse_verts.end(), fright.begin(), fright.end());
-
-        // Form normals.
-        auto fnfront = OpenGLBox::get_front_normals();
-        auto fnback = OpenGLBox::get_back_normals();
-        auto fntop = OpenGLBox::get_top_normals();
-        auto fnbot = OpenGLBox::get_bot_normals();
-        auto fnleft = OpenGLBox::get_left_normals();
-        auto fnright = OpenGLBox::get_right_normals();
-
-        // Add the normals.
-        warehouse_norms.insert(warehouse_norms.end(), fnfront.begin(), fnfront.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnback.begin(), fnback.end());
-        warehouse_norms.insert(warehouse_norms.end(), fntop.begin(), fntop.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnbot.begin(), fnbot.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnleft.begin(), fnleft.end());
-        warehouse_norms.insert(warehouse_norms.end(), fnright.begin(), fnright.end());
-
-        // Add colors.
-        // Insert twice for each face because each face is two triangles.
-        for (int i = 0; i < 12; i++)
+        for (int cx = 0; cx < chunks_w; cx++)
         {
-            warehouse_colors.insert(warehouse_colors.end(), 
-                    drop_color.begin(), drop_color.end());
-        }   
+            int x0 = cx * CHUNK_SIZE;
+            int z0 = cz * CHUNK_SIZE;
+            int x1 = std::min(x0 + CHUNK_SIZE, warehouse_w);
+            int z1 = std::min(z0 + CHUNK_SIZE, warehouse_h);
+
+            Chunk chunk;
+            chunk.first = warehouse_indices.size();
+
+            OpenGLBox::append_walls(walls, warehouse_w, warehouse_h, x0, z0,
+                    x1, z1, warehouse_verts, warehouse_norms,
+                    warehouse_indices);
+            add_colors(default_wall_color);
+
+            for (auto& box : chunk_boxes[coord_to_pos(cx, cz, chunks_w)])
+            {
+                int x,z;
+                pos_to_coord(&x, &z, box.first, warehouse_w);
+                const Kind& kind = kinds[box.second];
+
+                OpenGLBox::append_indexed_box(warehouse_verts,
+                        warehouse_norms, warehouse_indices, kind.x, kind.y,
+                        kind.z, x, 0, z);
+                add_colors(*kind.color);
+            }
+
+            chunk.count = warehouse_indices.size() - chunk.first;
+            if (chunk.count == 0)
+                continue;
+
+            // The boxes are at most one unit on each side and centered on
+            // their cell.
+            chunk.min[0] = x0 - 0.5f;
+            chunk.min[1] = -0.5f;
+            chunk.min[2] = z0 - 0.5f;
+            chunk.max[0] = x1 - 0.5f;
+            chunk.max[1] = 0.5f;
+            chunk.max[2] = z1 - 0.5f;
+            chunks.push_back(chunk);
+        }
     }
     
     // Store lengths index lengths.
-    warehouse_vert_len = sizeof(&warehouse_verts[0]) * warehouse_verts.size();
-    warehouse_norm_len = sizeof(&warehouse_norms[0]) * warehouse_norms.size();
-    warehouse_color_len = sizeof(&warehouse_colors[0]) * warehouse_colors.size();
+    warehouse_vert_len = sizeof(GLfloat) * warehouse_verts.size();
+    warehouse_norm_len = sizeof(GLfloat) * warehouse_norms.size();
+    warehouse_color_len = sizeof(GLfloat) * warehouse_colors.size();
 
     // Target, size, data, usage.
     glBufferDataARB(GL_ARRAY_BUFFER_ARB, 
@@ -994,6 +1113,14 @@ void OpenGLView::setup()
     glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, warehouse_vert_len + warehouse_norm_len, 
             warehouse_color_len, &warehouse_colors[0]);
 
+    // Create the warehouse index buffer.
+    glGenBuffersARB(1, &warehouseIBO);
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, warehouseIBO);
+    glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,
+            sizeof(GLuint) * warehouse_indices.size(), &warehouse_indices[0],
+            GL_STATIC_DRAW_ARB);
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+
 
     // Create the worker VBO.
     glGenBuffersARB(1, &workerVBO);
@@ -1003,35 +1130,8 @@ void OpenGLView::setup()
     std::vector<GLfloat> worker_norms{}; 
     std::vector<GLfloat> worker_colors{}; 
 
-    // Form vertices
-    auto wfront = OpenGLBox::get_front_vertices(1, 1, 1, 0, 0, 0);
-    auto wback = OpenGLBox::get_back_vertices(1, 1, 1, 0, 0, 0);
-    auto wtop = OpenGLBox::get_top_vertices(1, 1, 1, 0, 0, 0);
-    auto wbot = OpenGLBox::get_bot_vertices(1, 1, 1, 0, 0, 0);
-    auto wleft = OpenGLBox::get_left_vertices(1, 1, 1, 0, 0, 0);
-    auto wright = OpenGLBox::get_right_vertices(1, 1, 1, 0, 0, 0);
-
-    worker_verts.insert(worker_verts.end(), wfront.begin(), wfront.end());
-    worker_verts.insert(worker_verts.end(), wback.begin(), wback.end());
-    worker_verts.insert(worker_verts.end(), wtop.begin(), wtop.end());
-    worker_verts.insert(worker_verts.end(), wbot.begin(), wbot.end());
-    worker_verts.insert(worker_verts.end(), wleft.begin(), wleft.end());
-    worker_verts.insert(worker_verts.end(), wright.begin(), wright.end());
-
-    // Form normals
-    auto wnfront = OpenGLBox::get_front_normals();
-    auto wnback = OpenGLBox::get_back_normals();
-    auto wntop = OpenGLBox::get_top_normals();
-    auto wnbot = OpenGLBox::get_bot_normals();
-    auto wnleft = OpenGLBox::get_left_normals();
-    auto wnright = OpenGLBox::get_right_normals();
-
-    worker_norms.insert(worker_norms.end(), wnfront.begin(), wnfront.end());
-    worker_norms.insert(worker_norms.end(), wnback.begin(), wnback.end());
-    worker_norms.insert(worker_norms.end(), wntop.begin(), wntop.end());
-    worker_norms.insert(worker_norms.end(), wnbot.begin(), wnbot.end());
-    worker_norms.insert(worker_norms.end(), wnleft.begin(), wnleft.end());
-    worker_norms.insert(worker_norms.end(), wnright.begin(), wnright.end());
+    // Form vertices and normals.
+    OpenGLBox::append_box(worker_verts, worker_norms, 1, 1, 1, 0, 0, 0);
 
     // Form colors
     // Insert twice for each face because each face is two triangles.
@@ -1042,9 +1142,9 @@ void OpenGLView::setup()
     }
 
     // Store lengths index lengths.
-    worker_vert_len = sizeof(&worker_verts[0]) * worker_verts.size();
-    worker_norm_len = sizeof(&worker_norms[0]) * worker_norms.size();
-    worker_color_len = sizeof(&worker_colors[0]) * worker_colors.size();
+    worker_vert_len = sizeof(GLfloat) * worker_verts.size();
+    worker_norm_len = sizeof(GLfloat) * worker_norms.size();
+    worker_color_len = sizeof(GLfloat) * worker_colors.size();
 
     // Target, size, data, usage.
     glBufferDataARB(GL_ARRAY_BUFFER_ARB, 
@@ -1057,6 +1157,35 @@ void OpenGLView::setup()
     // Copy colors after normals.
     glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, worker_vert_len+worker_norm_len, worker_color_len, &worker_colors[0]);
 
+    // Make room for the offset of every worker.
+    if (instanced)
+        reserve_instances(warehouse->get_worker_locs().size());
+
+    // Draw the finest level of the statistics that fits in the space for
+    // them. Every statistic has the same levels.
+    const StatPyramid& pyramid = warehouse->get_heat_window_pyramid();
+    stat_level = pyramid.fit_level(stat_w, stat_h);
+
+    // Create a texture for each statistic. Float textures keep the counts
+    // and the small heat values exact; without them the values are clamped
+    // to [0, 1], which the shader does anyway.
+    GLint stat_format = GLEW_ARB_texture_float ? GL_LUMINANCE32F_ARB :
+        GL_LUMINANCE;
+    glGenTextures((GLsizei) NUM_STATS, statTextures);
+    for (int k = 0; k < NUM_STATS; k++)
+    {
+        glBindTexture(GL_TEXTURE_2D, statTextures[k]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        // The shader averages the cells itself, so each sample is one cell.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, stat_format,
+                pyramid.get_level_width(stat_level),
+                pyramid.get_level_height(stat_level), 0, GL_LUMINANCE,
+                GL_FLOAT, 0);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 
@@ -1070,8 +1199,10 @@ void OpenGLView::run()
     double prevTime = glfwGetTime();
     double accumulator = 0.0;
 
-    // Continue simulation until sim_length seconds have elapsed.
-    while (difftime(time(nullptr), start_time) < sim_length)
+    // Continue until the simulation finishes, or without snapshots until
+    // sim_length seconds have elapsed.
+    while ((snapshots != nullptr) ? !snapshots->is_finished() :
+            difftime(time(nullptr), start_time) < sim_length)
     {
         // Calculate time since last frame
         double currentTime = glfwGetTime();
@@ -1098,6 +1229,16 @@ void OpenGLView::run()
         }
 
         render(); 
+
+        // Sample the simulation at the frame rate. The simulation publishes
+        // its ticks without waiting for the view, so neither this nor a
+        // vertical sync in render() slows it down.
+        if (frame_rate > 0)
+        {
+            double wait = currentTime + 1.0 / frame_rate - glfwGetTime();
+            if (wait > 0)
+                std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+        }
     }
 }
 
@@ -1118,3 +1259,25 @@ void OpenGLView::set_sim_params(time_t start_time, int sim_length)
     this->start_time = start_time;
     this->sim_length = sim_length;
 }
+
+/**
+ * Set the buffer the simulation publishes the workers to. The workers are
+ * drawn from it instead of the live warehouse, and the view stops once the
+ * simulation has finished.
+ *
+ * @param buffer The buffer to read from.
+ */
+void OpenGLView::set_snapshot_buffer(SnapshotBuffer *buffer)
+{
+    this->snapshots = buffer;
+}
+
+/**
+ * Set the number of frames to render each second.
+ *
+ * @param fps The frame rate, or 0 to render as many frames as possible.
+ */
+void OpenGLView::set_frame_rate(int fps)
+{
+    this->frame_rate = fps;
+}
@@ -12,6 +12,7 @@
 #include <cstddef>
 #include <vector>
 
+#include "frustum.h"
 #include "view.h"
 
 /**
@@ -32,6 +33,10 @@ class OpenGLView : public View
         void set_warehouse(Warehouse *) override;
         // Override from View.
         void set_sim_params(time_t, int) override;
+        // Override from View.
+        void set_snapshot_buffer(SnapshotBuffer *) override;
+        // Override from View.
+        void set_frame_rate(int) override;
     private:
         // Override from Thread.
         //void run() override;
@@ -44,6 +49,20 @@ class OpenGLView : public View
         void update(double);
         // Render the view.
         void render();
+        // Render the statistics.
+        void render_stats();
+        // Upload the values of a statistic to its texture.
+        void upload_stat(int, const StatPyramid&, bool);
+        // Render the chunks of the warehouse the camera can see.
+        void render_warehouse();
+        // Find where to draw each worker.
+        void interpolate_workers();
+        // Render the workers.
+        void render_workers();
+        // Make room for the offsets of a number of workers.
+        void reserve_instances(std::size_t);
+        // Render the frame time.
+        void render_frame_time(float, float);
         // Render text.
         void render_text(const char *, float, float, float, float);
         // Handle mouse events.
@@ -71,6 +90,16 @@ class OpenGLView : public View
         time_t start_time;
         // The legnth of the simulation in seconds.
         int sim_length;
+        // The buffer the simulation publishes the workers to, if any.
+        SnapshotBuffer *snapshots = nullptr;
+        // The last two snapshots read from the buffer.
+        SnapshotBuffer::Snapshot previous_snapshot;
+        SnapshotBuffer::Snapshot latest_snapshot;
+        // The coordinates to draw each worker at, as x and z pairs.
+        std::vector<GLfloat> worker_coords{};
+        // The number of frames to render each second, or 0 for as many as
+        // possible.
+        int frame_rate = 60;
 
         // Dimensions are defined in terms of UNITs.
         const float UNIT = 1.0f;
@@ -96,6 +125,8 @@ class OpenGLView : public View
 
         // Holds the static warehouse VBO.
         GLuint warehouseVBO = 0; 
+        // Holds the indices of the warehouse triangles.
+        GLuint warehouseIBO = 0;
         // Holds the worker VBO.
         GLuint workerVBO = 0;
 
@@ -129,8 +160,27 @@ class OpenGLView : public View
             0.4, 0.2, 0,  
             0.4, 0.2, 0
         };
-        // The number of triangles it took to represent the warehouse.
-        int num_warehouse_tris = 0;
+        // A square of the floor and the boxes on it, stored as one range of
+        // the warehouse VBO so that it can be skipped when out of sight.
+        struct Chunk
+        {
+            // The first index and the number of indices.
+            GLint first = 0;
+            GLsizei count = 0;
+            // The bounding box, in the coordinates the warehouse is drawn in.
+            GLfloat min[3];
+            GLfloat max[3];
+        };
+        // The chunks of the warehouse. The first is the floor.
+        std::vector<Chunk> chunks{};
+        // The number of cells on each side of a chunk.
+        const int CHUNK_SIZE = 16;
+        // The part of the warehouse the camera can see.
+        Frustum frustum;
+        // The offset of the first index and number of indices of each chunk
+        // drawn.
+        std::vector<const GLvoid*> chunk_offsets{};
+        std::vector<GLsizei> chunk_counts{};
         
         // Worker data.
         std::size_t worker_vert_len;
@@ -145,6 +195,52 @@ class OpenGLView : public View
         // We need 36 triangles to form a cube.
         int num_worker_tris = 36;
 
+        /*
+         * The following are used for instanced rendering of the workers.
+         */
+
+        // Whether the workers are drawn with a single instanced draw call.
+        bool instanced = false;
+        // The shader for the workers.
+        GLuint workerProgram = 0;
+        // Attributes and uniforms for the worker shader.
+        GLint worker_attribute_coord;
+        GLint worker_attribute_normal;
+        GLint worker_attribute_color;
+        GLint worker_attribute_offset;
+        GLint worker_uniform_lighting;
+        GLint worker_uniform_light0;
+        // Holds the offset of each worker, one region per frame in flight.
+        GLuint instanceVBO = 0;
+        // The number of regions in the offset buffer, so that a frame can be
+        // written while the GPU still reads the previous ones.
+        static const int INSTANCE_REGIONS = 3;
+        // The number of workers each region has room for.
+        std::size_t instance_capacity = 0;
+        // The region written this frame.
+        int instance_region = 0;
+        // The offset buffer, mapped for as long as it exists, or null if it
+        // is written with glBufferSubData instead.
+        GLfloat *instance_data = nullptr;
+        // Signalled once the GPU is done reading each region.
+        GLsync instance_fences[INSTANCE_REGIONS] = {};
+        // The offsets written this frame when the buffer is not mapped.
+        std::vector<GLfloat> instance_offsets{};
+
+        /*
+         * The following are used for the frame time overlay.
+         */
+
+        // The time the last frame ended, in seconds.
+        double frame_end = 0;
+        // The average frame time, in seconds.
+        double frame_time = 0;
+        // The average time spent issuing the draw calls of a frame, which
+        // unlike the frame time is not limited by the vertical sync.
+        double draw_time = 0;
+        // The weight of the newest frame in the average frame time.
+        const double FRAME_TIME_WEIGHT = 0.05;
+
         // Bin dimensions.
         const float BIN_X = 0.75;
         const float BIN_Y = 0.75;
@@ -154,6 +250,27 @@ class OpenGLView : public View
         const float DROP_Y = 0.75;
         const float DROP_Z = 0.75;
 
+        /*
+         * The following are used for rendering the statistics.
+         */
+
+        // The shader for the statistics, which colors and downsamples them.
+        GLuint statProgram = 0;
+        // Attributes for the statistics shader.
+        GLint stat_attribute_coord;
+        GLint stat_uniform_tex;
+        GLint stat_uniform_cells;
+        GLint stat_uniform_pixels;
+        // A texture for each statistic, holding its value in each cell of
+        // the level drawn.
+        GLuint statTextures[4] = {};
+        // The level of the statistics drawn, the finest that fits.
+        int stat_level = 0;
+        // The statistics vertex buffer object.
+        GLuint statVBO = 0;
+        // The values of a statistic, ready to upload.
+        std::vector<GLfloat> stat_texels{};
+
         /*
          * The following are used for text rendering.
          */
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+#include "software_view.h"
+#include "../util/util.h"
+
+/**
+ * Implementation for software_view.h
+ */
+
+/**
+ * Constructor.
+ *
+ * @param dir The directory to write the frames to, which must exist.
+ * @param every The number of ticks between frames. Must be at least one.
+ */
+SoftwareView::SoftwareView(const std::string& dir, long every)
+{
+    if (every < 1)
+        throw("Frames must be at least one tick apart.");
+
+    this->dir = dir;
+    this->every = every;
+}
+
+/**
+ * Destructor.
+ */
+SoftwareView::~SoftwareView()
+{
+    delete encoder;
+}
+
+/**
+ * Lays out the image and draws the warehouse without its workers, which every
+ * frame starts from. The warehouse is drawn on the left, one cell per
+ * CELL_PIXELS square, and the four statistics are drawn on the right in two
+ * rows of two at a smaller scale. Also asks the snapshot buffer to keep the
+ * ticks to draw, with the values of the statistics.
+ */
+void SoftwareView::setup()
+{
+    int warehouse_w = warehouse->get_width();
+    int warehouse_h = warehouse->get_height();
+    int stat_w = warehouse_w * STAT_PIXELS;
+    int stat_h = warehouse_h * STAT_PIXELS;
+
+    width = warehouse_w * CELL_PIXELS + SEP + stat_w + SEP + stat_w;
+    height = std::max(warehouse_h * CELL_PIXELS, stat_h + SEP + stat_h);
+    background.assign(width * height * 3, 0);
+
+    fill(background, 0, 0, warehouse_w * CELL_PIXELS,
+            warehouse_h * CELL_PIXELS, floor_color);
+
+    int x,y;
+    for (auto& pos : warehouse->get_walls())
+    {
+        pos_to_coord(&x, &y, pos, warehouse_w);
+        fill(background, x * CELL_PIXELS, y * CELL_PIXELS, CELL_PIXELS,
+                CELL_PIXELS, wall_color);
+    }
+
+    // Bins and drop-offs are drawn smaller than their cell, as in the OpenGL
+    // view.
+    int inset = CELL_PIXELS / 8;
+    int size = CELL_PIXELS - 2 * inset;
+    for (auto& pos : warehouse->get_bins())
+    {
+        pos_to_coord(&x, &y, pos, warehouse_w);
+        fill(background, x * CELL_PIXELS + inset, y * CELL_PIXELS + inset,
+                size, size, bin_color);
+    }
+    for (auto& pos : warehouse->get_drops())
+    {
+        pos_to_coord(&x, &y, pos, warehouse_w);
+        fill(background, x * CELL_PIXELS + inset, y * CELL_PIXELS + inset,
+                size, size, drop_color);
+    }
+
+    if (snapshots != nullptr)
+        snapshots->set_capture(every, MAX_CAPTURES, SnapshotBuffer::STAT_VALUES);
+}
+
+/**
+ * Draws each tick the snapshot buffer kept and hands it to the encoder, until
+ * the simulation finishes. The buffer is checked frame_rate times a second,
+ * and every tick kept since the last check is drawn. This thread may wait for
+ * the encoder, but the simulation never waits for this thread: once too many
+ * ticks are waiting the buffer drops the rest.
+ */
+void SoftwareView::run()
+{
+    if (snapshots == nullptr)
+        return;
+
+    encoder = new FrameEncoder(dir, MAX_FRAMES);
+    encoder->start();
+
+    SnapshotBuffer::Snapshot snapshot;
+    while (true)
+    {
+        // Checked before taking the kept ticks, so that the last ones are
+        // drawn once the simulation finishes.
+        bool finished = snapshots->is_finished();
+
+        while (snapshots->take_capture(snapshot))
+        {
+            FrameEncoder::Frame frame;
+            draw(snapshot, frame);
+            encoder->push(std::move(frame));
+        }
+
+        if (finished)
+            break;
+
+        if (frame_rate > 0)
+            std::this_thread::sleep_for(
+                    std::chrono::microseconds(1000000 / frame_rate));
+        else
+            std::this_thread::yield();
+    }
+
+    encoder->close();
+    encoder->join();
+
+    std::cout << "Wrote " << encoder->get_written() << " frames to " << dir;
+    long dropped = snapshots->get_dropped_captures();
+    if (dropped > 0)
+        std::cout << ", dropped " << dropped << " that were not drawn in time";
+    std::cout << std::endl;
+}
+
+/**
+ * Draws the workers of a tick over the background, and the statistics. The
+ * statistics were copied by the simulation when it kept the tick, so they are
+ * drawn as they were at the end of the same tick as the workers.
+ *
+ * @param snapshot The workers and statistics at the end of the tick.
+ * @param frame Set to the image of the tick.
+ */
+void SoftwareView::draw(const SnapshotBuffer::Snapshot& snapshot,
+        FrameEncoder::Frame& frame)
+{
+    int warehouse_w = warehouse->get_width();
+    int warehouse_h = warehouse->get_height();
+
+    frame.tick = snapshot.tick;
+    frame.width = width;
+    frame.height = height;
+    frame.pixels = background;
+
+    int x,y;
+    for (auto& pos : snapshot.positions)
+    {
+        pos_to_coord(&x, &y, pos, warehouse_w);
+        fill(frame.pixels, x * CELL_PIXELS, y * CELL_PIXELS, CELL_PIXELS,
+                CELL_PIXELS, worker_color);
+    }
+
+    int left = warehouse_w * CELL_PIXELS + SEP;
+    int right = left + warehouse_w * STAT_PIXELS + SEP;
+    int bottom = warehouse_h * STAT_PIXELS + SEP;
+    const std::vector<std::vector<float>>& stats = snapshot.stat_values;
+    draw_stat(frame.pixels, left, 0, stats[0], true);
+    draw_stat(frame.pixels, right, 0, stats[1], true);
+    draw_stat(frame.pixels, left, bottom, stats[2], false);
+    draw_stat(frame.pixels, right, bottom, stats[3], false);
+}
+
+/**
+ * Draws a statistic as a heat map, one cell per STAT_PIXELS square, with the
+ * same colors and scaling as the OpenGL view.
+ *
+ * @param pixels The image to draw in.
+ * @param left The left of the heat map in pixels.
+ * @param top The top of the heat map in pixels.
+ * @param values The value of the statistic at each position.
+ * @param normalize Whether to scale the values so the largest is one.
+ * Otherwise values above one are drawn as one.
+ */
+void SoftwareView::draw_stat(std::vector<unsigned char>& pixels, int left,
+        int top, const std::vector<float>& values, bool normalize)
+{
+    float max = 1;
+    if (normalize && !values.empty())
+    {
+        max = *std::max_element(values.begin(), values.end());
+        if (max <= 0)
+            max = 1;
+    }
+
+    int w = warehouse->get_width();
+    int h = warehouse->get_height();
+    unsigned char color[3];
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            heat(values[y * w + x] / max, color);
+            fill(pixels, left + x * STAT_PIXELS, top + y * STAT_PIXELS,
+                    STAT_PIXELS, STAT_PIXELS, color);
+        }
+    }
+}
+
+/**
+ * Finds the color of a value in a heat map, going from blue through cyan,
+ * green and yellow to red.
+ *
+ * @param val The value, which is clamped to [0, 1].
+ * @param color Set to the red, green and blue of the color.
+ */
+void SoftwareView::heat(float val, unsigned char *color)
+{
+    val = std::min(std::max(val, 0.0f), 1.0f);
+
+    float r, g, b;
+    if (val < 0.25f)
+    {
+        r = 0; g = val / 0.25f; b = 1;
+    }
+    else if (val < 0.5f)
+    {
+        r = 0; g = 1; b = 1 - (val - 0.25f) / 0.25f;
+    }
+    else if (val < 0.75f)
+    {
+        r = (val - 0.5f) / 0.25f; g = 1; b = 0;
+    }
+    else
+    {
+        r = 1; g = 1 - (val - 0.75f) / 0.25f; b = 0;
+    }
+
+    color[0] = r * 255;
+    color[1] = g * 255;
+    color[2] = b * 255;
+}
+
+/**
+ * Fills a rectangle of an image with a color.
+ *
+ * @param pixels The image.
+ * @param left The left of the rectangle in pixels.
+ * @param top The top of the rectangle in pixels.
+ * @param w The width of the rectangle in pixels.
+ * @param h The height of the rectangle in pixels.
+ * @param color The red, green and blue of the color.
+ */
+void SoftwareView::fill(std::vector<unsigned char>& pixels, int left, int top,
+        int w, int h, const unsigned char *color)
+{
+    for (int y = top; y < top + h; y++)
+    {
+        unsigned char *row = &pixels[(y * width + left) * 3];
+        for (int x = 0; x < w; x++)
+        {
+            row[x*3] = color[0];
+            row[x*3 + 1] = color[1];
+            row[x*3 + 2] = color[2];
+        }
+    }
+}
+
+/**
+ * Set the warehouse to render.
+ *
+ * @param warehouse The warehouse to render.
+ */
+void SoftwareView::set_warehouse(Warehouse *warehouse)
+{
+    this->warehouse = warehouse;
+}
+
+/**
+ * Sets the length of the simulation. The view runs until the simulation
+ * finishes instead.
+ *
+ * @param start_time The start time of the simulation.
+ * @param sim_length The length of the simulation in seconds.
+ */
+void SoftwareView::set_sim_params(time_t start_time, int sim_length)
+{
+    this->start_time = start_time;
+    this->sim_length = sim_length;
+}
+
+/**
+ * Set the buffer the simulation publishes the workers to.
+ *
+ * @param snapshots The buffer.
+ */
+void SoftwareView::set_snapshot_buffer(SnapshotBuffer *snapshots)
+{
+    this->snapshots = snapshots;
+}
+
+/**
+ * Set the number of times each second to check for ticks to draw.
+ *
+ * @param frame_rate The number of checks each second, or 0 to check as often
+ * as possible.
+ */
+void SoftwareView::set_frame_rate(int frame_rate)
+{
+    this->frame_rate = frame_rate;
+}
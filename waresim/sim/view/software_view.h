@@ -0,0 +1,92 @@
+#ifndef SIM_VIEW_SOFTWARE_VIEW_H
+#define SIM_VIEW_SOFTWARE_VIEW_H
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "frame_encoder.h"
+#include "view.h"
+
+/**
+ * A view that needs no display. It draws the warehouse from above, with the
+ * workers and the statistics, into an image in memory every nth tick, and
+ * hands the images to a FrameEncoder that writes them out on its own thread.
+ * The ticks to draw are kept for it by the snapshot buffer, which drops them
+ * rather than waiting if the view falls behind, so the simulation never waits
+ * for the view.
+ */
+class SoftwareView : public View
+{
+    public:
+        SoftwareView(const std::string&, long);
+        ~SoftwareView();
+
+        // Lay out the image and draw the parts that never change.
+        void setup() override;
+        // Draw and write the kept ticks until the simulation finishes.
+        void run() override;
+        // Set the warehouse to render.
+        void set_warehouse(Warehouse *) override;
+        // Sets the length of the simulation to render.
+        void set_sim_params(time_t, int) override;
+        // Set the buffer the simulation publishes the workers to.
+        void set_snapshot_buffer(SnapshotBuffer *) override;
+        // Set the number of times each second to check for kept ticks.
+        void set_frame_rate(int) override;
+    private:
+        // Draw the workers and statistics of a tick.
+        void draw(const SnapshotBuffer::Snapshot&, FrameEncoder::Frame&);
+        // Draw a statistic as a heat map.
+        void draw_stat(std::vector<unsigned char>&, int, int,
+                const std::vector<float>&, bool);
+        // Find the color of a value in a heat map.
+        static void heat(float, unsigned char *);
+        // Fill a rectangle of an image with a color.
+        void fill(std::vector<unsigned char>&, int, int, int, int,
+                const unsigned char *);
+
+        // The warehouse to render.
+        Warehouse *warehouse = nullptr;
+        // The buffer the simulation publishes the workers to.
+        SnapshotBuffer *snapshots = nullptr;
+        // Writes the frames.
+        FrameEncoder *encoder = nullptr;
+        // The directory the frames are written to.
+        std::string dir;
+        // The number of ticks between frames.
+        long every;
+        // The number of times each second to check for kept ticks.
+        int frame_rate = 60;
+        // The start time of the simulation.
+        time_t start_time;
+        // The length of the simulation.
+        int sim_length;
+
+        // The size of the image in pixels.
+        int width = 0;
+        int height = 0;
+        // The image without the workers and statistics.
+        std::vector<unsigned char> background{};
+
+        // The size of a cell of the warehouse in pixels.
+        const int CELL_PIXELS = 8;
+        // The size of a cell of a statistic in pixels.
+        const int STAT_PIXELS = 4;
+        // The space between the parts of the image in pixels.
+        const int SEP = 4;
+        // The most ticks kept waiting to be drawn.
+        const std::size_t MAX_CAPTURES = 64;
+        // The most frames waiting to be written.
+        const std::size_t MAX_FRAMES = 8;
+
+        // The colors of the floor, walls, bins, drop-offs and workers, as in
+        // the OpenGL view.
+        const unsigned char floor_color[3] = {191, 191, 191};
+        const unsigned char wall_color[3] = {153, 153, 153};
+        const unsigned char bin_color[3] = {102, 51, 0};
+        const unsigned char drop_color[3] = {255, 255, 0};
+        const unsigned char worker_color[3] = {255, 0, 0};
+};
+
+#endif
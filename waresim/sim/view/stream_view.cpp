@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "stream_view.h"
+
+/**
+ * Implementation for stream_view.h
+ */
+
+/**
+ * Constructor.
+ *
+ * @param path The path of the socket. Any file already there is replaced.
+ */
+StreamView::StreamView(const std::string& path)
+{
+    this->path = path;
+}
+
+/**
+ * Destructor. Closes the socket and removes it.
+ */
+StreamView::~StreamView()
+{
+    close_client();
+    if (server >= 0)
+    {
+        close(server);
+        unlink(path.c_str());
+    }
+}
+
+/**
+ * Opens the socket, without waiting for a client, and asks the snapshot buffer
+ * to keep every tick with the changes in the statistics.
+ */
+void StreamView::setup()
+{
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        throw("Invalid stream socket path.");
+    std::strcpy(addr.sun_path, path.c_str());
+
+    unlink(path.c_str());
+    server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0 || bind(server, (sockaddr *) &addr, sizeof(addr)) != 0 ||
+            listen(server, 1) != 0 ||
+            fcntl(server, F_SETFL, O_NONBLOCK) != 0)
+        throw("Unable to open the stream socket.");
+
+    int size = warehouse->get_width() * warehouse->get_height();
+    stat_values.assign(SnapshotBuffer::NUM_STATS, std::vector<double>(size, 0));
+    unsent.assign(SnapshotBuffer::NUM_STATS, std::vector<int>());
+    is_unsent.assign(SnapshotBuffer::NUM_STATS, std::vector<bool>(size, false));
+
+    if (snapshots != nullptr)
+        snapshots->set_capture(1, MAX_CAPTURES, SnapshotBuffer::STAT_CHANGES);
+}
+
+/**
+ * Streams each tick the snapshot buffer kept until the simulation finishes,
+ * checking for new ticks and clients frame_rate times a second. Nothing here
+ * waits for the client: a tick is only turned into a frame once the client
+ * has been sent every earlier frame, and is skipped otherwise. Ticks kept
+ * without a client are not sent, but their statistics are still taken, so a
+ * client that connects later is sent them. Once the simulation finishes, the
+ * client is given a second to read what is left.
+ */
+void StreamView::run()
+{
+    if (snapshots == nullptr)
+        return;
+
+    SnapshotBuffer::Snapshot snapshot;
+    while (true)
+    {
+        // Checked before taking the kept ticks, so that the last ones are
+        // sent once the simulation finishes.
+        bool finished = snapshots->is_finished();
+
+        if (client < 0)
+            accept_client();
+        if (client >= 0)
+            flush();
+
+        while (snapshots->take_capture(snapshot))
+        {
+            take_stats(snapshot);
+            if (client < 0)
+                continue;
+
+            if (pending_sent < pending.size())
+            {
+                frames_skipped++;
+                continue;
+            }
+
+            add_tick(snapshot);
+            flush();
+        }
+
+        if (finished)
+            break;
+
+        if (frame_rate > 0)
+            std::this_thread::sleep_for(
+                    std::chrono::microseconds(1000000 / frame_rate));
+        else
+            std::this_thread::yield();
+    }
+
+    // The simulation has finished, so the rest can be sent blocking.
+    if (client >= 0)
+    {
+        timeval timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_usec = 0;
+        fcntl(client, F_SETFL, 0);
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        flush();
+        close_client();
+    }
+
+    std::cout << "Streamed " << frames_sent << " frames to " << path;
+    if (frames_skipped > 0)
+        std::cout << ", skipped " << frames_skipped << " the client was not "
+            << "ready for";
+    long dropped = snapshots->get_dropped_captures();
+    if (dropped > 0)
+        std::cout << ", dropped " << dropped << " that were not sent in time";
+    std::cout << std::endl;
+}
+
+/**
+ * Accepts a client if one is waiting. The client is sent the layout first,
+ * and its first frame holds every worker and every nonzero statistic.
+ */
+void StreamView::accept_client()
+{
+    client = accept(server, nullptr, nullptr);
+    if (client < 0)
+        return;
+    fcntl(client, F_SETFL, O_NONBLOCK);
+
+    sent_positions.clear();
+    for (int k = 0; k < SnapshotBuffer::NUM_STATS; k++)
+    {
+        unsent[k].clear();
+        for (std::size_t pos = 0; pos < stat_values[k].size(); pos++)
+        {
+            is_unsent[k][pos] = stat_values[k][pos] != 0;
+            if (is_unsent[k][pos])
+                unsent[k].push_back(pos);
+        }
+    }
+    pending.clear();
+    pending_sent = 0;
+    add_layout();
+}
+
+/**
+ * Disconnects the client, if any, and drops the messages not yet sent.
+ */
+void StreamView::close_client()
+{
+    if (client >= 0)
+        close(client);
+    client = -1;
+    pending.clear();
+    pending_sent = 0;
+}
+
+/**
+ * Sends as much of the pending messages as the socket takes without waiting.
+ * The client is disconnected if the socket fails.
+ */
+void StreamView::flush()
+{
+    while (pending_sent < pending.size())
+    {
+        ssize_t sent = send(client, pending.data() + pending_sent,
+                pending.size() - pending_sent, MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            pending_sent += sent;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+
+        close_client();
+        return;
+    }
+
+    pending.clear();
+    pending_sent = 0;
+}
+
+/**
+ * Adds the layout message: the width and height of the warehouse, the walls,
+ * bins and drop-offs, and the number of statistics each frame holds.
+ */
+void StreamView::add_layout()
+{
+    CheckpointWriter writer;
+    writer.write_int(LAYOUT_MESSAGE);
+    writer.write_int(warehouse->get_width());
+    writer.write_int(warehouse->get_height());
+    writer.write_ints(warehouse->get_walls());
+    writer.write_ints(warehouse->get_bins());
+    writer.write_ints(warehouse->get_drops());
+    writer.write_int(SnapshotBuffer::NUM_STATS);
+    add_message(writer);
+}
+
+/**
+ * Applies the changes in the statistics kept with a tick, and marks the
+ * positions that changed to be sent with the next frame. The next frame sent
+ * may be for a later tick, so every tick kept is applied whether or not it is
+ * sent.
+ *
+ * @param snapshot The tick, with the changes in the statistics.
+ */
+void StreamView::take_stats(const SnapshotBuffer::Snapshot& snapshot)
+{
+    for (std::size_t k = 0; k < snapshot.stats.size(); k++)
+    {
+        const SnapshotBuffer::StatChanges& changes = snapshot.stats[k];
+        for (std::size_t i = 0; i < changes.positions.size(); i++)
+        {
+            int pos = changes.positions[i];
+            stat_values[k][pos] = changes.stored[i];
+            if (client >= 0 && !is_unsent[k][pos])
+            {
+                is_unsent[k][pos] = true;
+                unsent[k].push_back(pos);
+            }
+        }
+    }
+}
+
+/**
+ * Adds a tick message holding what changed since the last frame sent. This is
+ * the tick and the number of workers, then the number of workers that moved,
+ * each as the gap from the previous one moved and its new position. Then,
+ * for each statistic, the common factor and the number of positions whose
+ * stored value changed, each as the gap from the previous one changed and its
+ * stored value. The value at a position is its stored value times the factor,
+ * so decaying a statistic only changes its factor.
+ *
+ * The factors and stored values are the ones the simulation kept with the
+ * tick, so they all belong to the same tick as the workers.
+ *
+ * @param snapshot The workers at the end of the tick.
+ */
+void StreamView::add_tick(const SnapshotBuffer::Snapshot& snapshot)
+{
+    CheckpointWriter writer;
+    writer.write_int(TICK_MESSAGE);
+    writer.write_int(snapshot.tick);
+
+    const std::vector<int>& positions = snapshot.positions;
+    writer.write_int(positions.size());
+    changed.clear();
+    for (std::size_t i = 0; i < positions.size(); i++)
+    {
+        if (i >= sent_positions.size() || positions[i] != sent_positions[i])
+            changed.push_back(i);
+    }
+    writer.write_int(changed.size());
+    int last = 0;
+    for (auto& i : changed)
+    {
+        writer.write_int(i - last);
+        writer.write_int(positions[i]);
+        last = i;
+    }
+    sent_positions = positions;
+
+    for (int k = 0; k < SnapshotBuffer::NUM_STATS; k++)
+    {
+        // The positions are sent in order, as gaps.
+        std::sort(unsent[k].begin(), unsent[k].end());
+
+        writer.write_double(snapshot.stats[k].factor);
+        writer.write_int(unsent[k].size());
+        last = 0;
+        for (auto& pos : unsent[k])
+        {
+            writer.write_int(pos - last);
+            writer.write_double(stat_values[k][pos]);
+            is_unsent[k][pos] = false;
+            last = pos;
+        }
+        unsent[k].clear();
+    }
+
+    add_message(writer);
+    frames_sent++;
+}
+
+/**
+ * Adds a message to the pending messages, after its length.
+ *
+ * @param writer The message.
+ */
+void StreamView::add_message(CheckpointWriter& writer)
+{
+    std::string data = writer.get_data();
+    uint32_t size = data.size();
+    for (int i = 0; i < 4; i++)
+        pending.push_back((char) ((size >> (8 * i)) & 0xff));
+    pending.append(data);
+}
+
+/**
+ * Set the warehouse to render.
+ *
+ * @param warehouse The warehouse to render.
+ */
+void StreamView::set_warehouse(Warehouse *warehouse)
+{
+    this->warehouse = warehouse;
+}
+
+/**
+ * Sets the length of the simulation. The view runs until the simulation
+ * finishes instead.
+ *
+ * @param start_time The start time of the simulation.
+ * @param sim_length The length of the simulation in seconds.
+ */
+void StreamView::set_sim_params(time_t start_time, int sim_length)
+{
+    this->start_time = start_time;
+    this->sim_length = sim_length;
+}
+
+/**
+ * Set the buffer the simulation publishes the workers to.
+ *
+ * @param snapshots The buffer.
+ */
+void StreamView::set_snapshot_buffer(SnapshotBuffer *snapshots)
+{
+    this->snapshots = snapshots;
+}
+
+/**
+ * Set the number of times each second to check for ticks and clients.
+ *
+ * @param frame_rate The number of checks each second, or 0 to check as often
+ * as possible.
+ */
+void StreamView::set_frame_rate(int frame_rate)
+{
+    this->frame_rate = frame_rate;
+}
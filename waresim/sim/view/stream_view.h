@@ -0,0 +1,105 @@
+#ifndef SIM_VIEW_STREAM_VIEW_H
+#define SIM_VIEW_STREAM_VIEW_H
+
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "view.h"
+#include "../checkpoint/checkpoint_writer.h"
+
+/**
+ * A view that streams the simulation to another process, such as a dashboard,
+ * over a Unix domain socket. It draws nothing itself. One client is served at
+ * a time. A client is first sent the layout of the warehouse, and then a frame
+ * for every tick with the workers that moved and the statistics that changed.
+ *
+ * Each message is its length as four little-endian bytes followed by the
+ * message, which is encoded like a checkpoint: integers as zigzag varints and
+ * doubles as their little-endian bits. Changes are sent against the last frame
+ * the client was sent, so a tick that is skipped loses nothing but its own
+ * timing. Ticks are skipped, rather than holding up the simulation, whenever
+ * the client has not read the previous frame yet. The statistics are taken
+ * from the changes the simulation kept with each tick, never from the
+ * warehouse itself.
+ */
+class StreamView : public View
+{
+    public:
+        StreamView(const std::string&);
+        ~StreamView();
+
+        // Open the socket and ask for every tick to be kept.
+        void setup() override;
+        // Stream the kept ticks until the simulation finishes.
+        void run() override;
+        // Set the warehouse to render.
+        void set_warehouse(Warehouse *) override;
+        // Sets the length of the simulation to render.
+        void set_sim_params(time_t, int) override;
+        // Set the buffer the simulation publishes the workers to.
+        void set_snapshot_buffer(SnapshotBuffer *) override;
+        // Set the number of times each second to check for kept ticks.
+        void set_frame_rate(int) override;
+
+        // The types of message.
+        static const int LAYOUT_MESSAGE = 0;
+        static const int TICK_MESSAGE = 1;
+    private:
+        // Accept a client if one is waiting.
+        void accept_client();
+        // Disconnect the client.
+        void close_client();
+        // Send as much of the pending messages as the socket takes.
+        void flush();
+        // Add the layout of the warehouse to the pending messages.
+        void add_layout();
+        // Apply the changes in the statistics kept with a tick.
+        void take_stats(const SnapshotBuffer::Snapshot&);
+        // Add the changes in a tick to the pending messages.
+        void add_tick(const SnapshotBuffer::Snapshot&);
+        // Add a message to the pending messages.
+        void add_message(CheckpointWriter&);
+
+        // The warehouse to render.
+        Warehouse *warehouse = nullptr;
+        // The buffer the simulation publishes the workers to.
+        SnapshotBuffer *snapshots = nullptr;
+        // The number of times each second to check for kept ticks.
+        int frame_rate = 60;
+        // The start time of the simulation.
+        time_t start_time;
+        // The length of the simulation.
+        int sim_length;
+
+        // The path of the socket.
+        std::string path;
+        // The socket clients connect to, or -1.
+        int server = -1;
+        // The connection to the client, or -1 if there is none.
+        int client = -1;
+        // The messages not yet sent, and how much of them has been sent.
+        std::string pending{};
+        std::size_t pending_sent = 0;
+
+        // The position of each worker in the last frame sent.
+        std::vector<int> sent_positions{};
+        // The stored values of each statistic in the last tick taken.
+        std::vector<std::vector<double>> stat_values{};
+        // The positions of each statistic changed since the last frame sent,
+        // and whether each position is among them.
+        std::vector<std::vector<int>> unsent{};
+        std::vector<std::vector<bool>> is_unsent{};
+        // The workers that moved, reused between frames.
+        std::vector<int> changed{};
+
+        // The number of frames sent and skipped.
+        long frames_sent = 0;
+        long frames_skipped = 0;
+
+        // The most ticks kept waiting to be sent.
+        const std::size_t MAX_CAPTURES = 256;
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <ctime>
 
+#include "../concurrent/snapshot_buffer.h"
 #include "../warehouse.h"
 #include "../thread/thread.h"
 
@@ -23,6 +24,10 @@ class View //: public Thread
         virtual void set_warehouse(Warehouse *) = 0;
         // Sets the length of the simulation to render.
         virtual void set_sim_params(time_t, int) = 0;
+        // Set the buffer the simulation publishes the workers to.
+        virtual void set_snapshot_buffer(SnapshotBuffer *) = 0;
+        // Set the number of frames to render each second.
+        virtual void set_frame_rate(int) = 0;
     private:
         // The warehouse to render.
         Warehouse *warehouse = nullptr;
@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "constants.h"
@@ -64,6 +66,7 @@ std::vector<std::string> Warehouse::read_file(std::string filename)
 Warehouse Warehouse::parse_default_warehouse(std::string warehouse_file)
 {
     Warehouse warehouse;
+    std::shared_ptr<Layout> plan = std::make_shared<Layout>();
 
     // Read warehouse layout file.
     auto lines = read_file(warehouse_file);
@@ -98,12 +101,12 @@ Warehouse Warehouse::parse_default_warehouse(std::string warehouse_file)
                 case BIN_MARKER:
                     layout[pos] = BIN_LOC;
                     // Push back a new bin location.
-                    warehouse.bins.push_back(pos);
+                    plan->bins.push_back(pos);
                     break;
                 case DROP_MARKER:
                     layout[pos] = DROP_LOC;
                     // Push back a new drop location.
-                    warehouse.drops.push_back(pos);
+                    plan->drops.push_back(pos);
                     break;
                 case WORKER_MARKER:
                     layout[pos] = WORKER_LOC;
@@ -114,7 +117,7 @@ Warehouse Warehouse::parse_default_warehouse(std::string warehouse_file)
                 case WALL_MARKER:
                     layout[pos] = WALL_LOC;
                     // Push back a new wall at this location.
-                    warehouse.walls.push_back(pos);
+                    plan->walls.push_back(pos);
                     break;
                 default:
                     // If we find an invalid marker, we will ignore it and continue.
@@ -130,24 +133,217 @@ Warehouse Warehouse::parse_default_warehouse(std::string warehouse_file)
         }
     }
 
-    // Set warehouse layout.
-    warehouse.layout = layout;
+    // Set warehouse layout. Copies of the warehouse share it.
+    plan->cells = layout;
+    warehouse.layout = plan;
+
+    // Index the workers by their position.
+    warehouse.worker_index = WorkerIndex(warehouse.width, warehouse.height,
+            INDEX_BUCKET_SIZE);
+    for (std::size_t i = 0; i < warehouse.workers.size(); i++)
+        warehouse.worker_index.insert(i, warehouse.workers[i].get_pos());
+
+    // Allocate the statistics, which start at zero.
+    warehouse.heat_window = StatPyramid(warehouse.width, warehouse.height);
+    warehouse.heat_total = StatPyramid(warehouse.width, warehouse.height);
+    warehouse.deadlock_pyramid = StatPyramid(warehouse.width, warehouse.height);
+    warehouse.contention_pyramid =
+        StatPyramid(warehouse.width, warehouse.height);
+
+    return warehouse;
+}
+
+/**
+ * Writes the warehouse and its statistics to a checkpoint. Everything needed
+ * to continue the simulation exactly is written, including the order of the
+ * worker locations and the moves of the current iteration.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void Warehouse::save(CheckpointWriter& writer)
+{
+    writer.write_int(height);
+    writer.write_int(width);
+    writer.write_ints(layout->cells);
+
+    writer.write_int(workers.size());
+    for (auto& worker : workers)
+        worker.save(writer);
+    writer.write_ints(worker_locs);
+
+    // The index of the worker at each location.
+    std::vector<int> occupants;
+    for (int pos : worker_locs)
+        occupants.push_back(worker_index.get_worker(pos));
+    writer.write_ints(occupants);
+
+    heat_window.save(writer);
+    heat_total.save(writer);
+    save_spots(writer, deadlock_spots);
+    save_spots(writer, contention_spots);
+    writer.write_ints(curr_moves);
+    writer.write_double(decay_factor);
+}
+
+/**
+ * Returns the warehouse written to a checkpoint by save(). The bins, walls
+ * and drops are found from the layout in the same order as when parsing.
+ *
+ * @param reader The checkpoint to read from.
+ */
+Warehouse Warehouse::load(CheckpointReader& reader)
+{
+    Warehouse warehouse;
+    std::shared_ptr<Layout> plan = std::make_shared<Layout>();
+
+    warehouse.height = reader.read_int();
+    warehouse.width = reader.read_int();
+    plan->cells = reader.read_ints();
+    if (warehouse.height <= 0 || warehouse.width <= 0 ||
+            plan->cells.size() != (std::size_t) warehouse.height*warehouse.width)
+        throw("Invalid warehouse dimensions in checkpoint.");
+
+    for (std::size_t pos = 0; pos < plan->cells.size(); pos++)
+    {
+        switch (plan->cells[pos])
+        {
+            case BIN_LOC:
+                plan->bins.push_back(pos);
+                break;
+            case DROP_LOC:
+                plan->drops.push_back(pos);
+                break;
+            case WALL_LOC:
+                plan->walls.push_back(pos);
+                break;
+        }
+    }
+    warehouse.layout = plan;
+
+    for (long long i = reader.read_int(); i > 0; i--)
+    {
+        Worker worker(0);
+        worker.load(reader);
+        warehouse.workers.push_back(worker);
+    }
+    warehouse.worker_locs = reader.read_ints();
+
+    std::vector<int> occupants = reader.read_ints();
+    if (occupants.size() != warehouse.worker_locs.size())
+        throw("Invalid worker locations in checkpoint.");
+    warehouse.worker_index = WorkerIndex(warehouse.width, warehouse.height,
+            INDEX_BUCKET_SIZE);
+    for (std::size_t i = 0; i < occupants.size(); i++)
+        warehouse.worker_index.insert(occupants[i], warehouse.worker_locs[i]);
+
+    warehouse.heat_window = StatPyramid(warehouse.width, warehouse.height);
+    warehouse.heat_window.load(reader);
+    warehouse.heat_total = StatPyramid(warehouse.width, warehouse.height);
+    warehouse.heat_total.load(reader);
+    warehouse.deadlock_spots = load_spots(reader);
+    warehouse.contention_spots = load_spots(reader);
+
+    // The levels of the deadlocks and contentions are not written.
+    warehouse.deadlock_pyramid = StatPyramid(warehouse.width, warehouse.height);
+    for (auto& spot : warehouse.deadlock_spots)
+        warehouse.deadlock_pyramid.add(spot.first, spot.second);
+    warehouse.contention_pyramid =
+        StatPyramid(warehouse.width, warehouse.height);
+    for (auto& spot : warehouse.contention_spots)
+        warehouse.contention_pyramid.add(spot.first, spot.second);
+    warehouse.curr_moves = reader.read_ints();
+    warehouse.decay_factor = reader.read_double();
+
+    return warehouse;
+}
+
+/**
+ * Writes a map of spots to a checkpoint, sorted by position so that the same
+ * map is always written the same way.
+ *
+ * @param writer The checkpoint to write to.
+ * @param spots The number of times something happened at each spot.
+ */
+void Warehouse::save_spots(CheckpointWriter& writer,
+        const std::unordered_map<int,int>& spots)
+{
+    std::vector<std::pair<int,int>> sorted(spots.begin(), spots.end());
+    std::sort(sorted.begin(), sorted.end());
 
-    // Reserve memory for statistics.
-    warehouse.heat_window.reserve(layout.size());
-    warehouse.heat_total.reserve(layout.size());
+    writer.write_int(sorted.size());
+    for (auto& spot : sorted)
+    {
+        writer.write_int(spot.first);
+        writer.write_int(spot.second);
+    }
+}
 
-    // Populate the array with default values.
-    int dim = warehouse.width * warehouse.height;
-    for (int i = 0; i < dim; i++)
+/**
+ * Reads a map of spots written by save_spots().
+ *
+ * @param reader The checkpoint to read from.
+ */
+std::unordered_map<int,int> Warehouse::load_spots(CheckpointReader& reader)
+{
+    std::unordered_map<int,int> spots;
+    for (long long i = reader.read_int(); i > 0; i--)
     {
-        warehouse.heat_window.push_back(0);
-        warehouse.heat_total.push_back(0);
+        int pos = reader.read_int();
+        spots[pos] = reader.read_int();
     }
 
+    return spots;
+}
+
+/**
+ * Returns a warehouse that shares the layout of this one but has no workers
+ * and no statistics. Only the layout and the dimensions are read, and they
+ * never change during a simulation, so this can be called while the warehouse
+ * is being simulated on another thread.
+ *
+ * @return The empty warehouse.
+ */
+Warehouse Warehouse::copy_layout()
+{
+    Warehouse warehouse;
+    warehouse.layout = layout;
+    warehouse.height = height;
+    warehouse.width = width;
+
     return warehouse;
 }
 
+/**
+ * Returns a copy of the workers, their locations and their spatial index.
+ * This is much smaller than a copy of the whole warehouse, which also holds
+ * the statistics.
+ *
+ * @return The state of the workers.
+ */
+Warehouse::WorkerState Warehouse::get_worker_state()
+{
+    WorkerState state;
+    state.workers = workers;
+    state.worker_locs = worker_locs;
+    state.worker_index = worker_index;
+
+    return state;
+}
+
+/**
+ * Replaces the workers, their locations and their spatial index with a state
+ * taken from a warehouse with the same layout. The state is swapped in, so
+ * the argument is left holding the old state.
+ *
+ * @param state The state of the workers.
+ */
+void Warehouse::set_worker_state(WorkerState& state)
+{
+    std::swap(workers, state.workers);
+    std::swap(worker_locs, state.worker_locs);
+    std::swap(worker_index, state.worker_index);
+}
+
 /**
  * Move a worker from the start index to the end index. We do not do any error
  * checking since we assuming valid start and end locations.
@@ -160,37 +356,57 @@ void Warehouse::move_worker(int start, int end)
     worker_locs.erase(it);
     // Add the end location.
     worker_locs.push_back(end);
+    // Update the spatial index.
+    worker_index.move(start, end);
 
     // Update total heat map.
-    heat_total[end] = heat_total[end] + 1;
+    heat_total.add(end, 1);
 
     // Update statistics.
     curr_moves.push_back(end);
 }
 
+/**
+ * Moves several workers at once. A worker may move into a position that
+ * another worker is leaving in the same call.
+ *
+ * @param moves The start and end position of each worker that moves.
+ */
+void Warehouse::move_workers(const std::vector<std::pair<int,int>>& moves)
+{
+    for (auto& m : moves)
+    {
+        // Replace the start location with the end location.
+        auto it = std::find(worker_locs.begin(), worker_locs.end(), m.first);
+        *it = m.second;
+
+        // Update total heat map.
+        heat_total.add(m.second, 1);
+
+        // Update statistics.
+        curr_moves.push_back(m.second);
+    }
+
+    // Update the spatial index.
+    worker_index.move_all(moves);
+}
+
 /**
  * Marks that all workers have been moved. This is the time to update decaying
  * statistics.
  */
 void Warehouse::update_iteration()
 {
-    // Update the heat window.
-    // Our current position in the heat window vector.
-    int pos = 0;
-    for (auto& sum : heat_window)    
-    {
-        sum *= decay_factor;
+    // Decay the heat window. This only touches every spot once in a long
+    // while, when the lazy decay is folded in.
+    heat_window.scale(decay_factor, thread_pool);
 
-        // If we moved to this spot this turn, we will add one to the decaying
-        // window for this spot.
-        if (std::find(curr_moves.begin(), curr_moves.end(), pos) 
-                != curr_moves.end())
-        {
-            sum += 1;
-        }
-    
-        pos++;
-    }
+    // Add one to the decaying window of each spot we moved to this turn. A
+    // spot moved to several times is only counted once.
+    std::sort(curr_moves.begin(), curr_moves.end());
+    auto end = std::unique(curr_moves.begin(), curr_moves.end());
+    for (auto it = curr_moves.begin(); it != end; ++it)
+        heat_window.add(*it, 1);
 
     curr_moves.clear();
 }
@@ -209,6 +425,7 @@ void Warehouse::mark_contention(int pos)
     // Default value if not found will be 0.
     int& val = contention_spots[pos];
     val++;
+    contention_pyramid.add(pos, 1);
 }
 
 /**
@@ -224,6 +441,7 @@ void Warehouse::mark_deadlock(int pos)
     // Default value if not found will be 0.
     int& val = deadlock_spots[pos];
     val++;
+    deadlock_pyramid.add(pos, 1);
 }
 
 
@@ -244,17 +462,18 @@ std::vector<Worker>& Warehouse::get_workers()
  */
 std::vector<int> Warehouse::get_bins()
 {
-    return bins;
+    return layout->bins;
 }
 
 /**
- * Returns the layout for the warehouse.
+ * Returns the layout for the warehouse. The layout never changes, so it is
+ * returned by reference rather than copied.
  *
  * @return The layout of the warehouse.
  */
-std::vector<int> Warehouse::get_layout()
+const std::vector<int>& Warehouse::get_layout()
 {
-    return layout;
+    return layout->cells;
 }
 
 /**
@@ -287,6 +506,17 @@ std::vector<int> Warehouse::get_worker_locs()
     return worker_locs;
 }
 
+/**
+ * Returns the spatial index of the workers. The index is kept up to date as
+ * workers are moved.
+ *
+ * @return A reference to the spatial index of the workers.
+ */
+WorkerIndex& Warehouse::get_worker_index()
+{
+    return worker_index;
+}
+
 /**
  * Return the wall locations.
  *
@@ -294,7 +524,7 @@ std::vector<int> Warehouse::get_worker_locs()
  */
 std::vector<int> Warehouse::get_walls()
 {
-    return walls;
+    return layout->walls;
 }
 
 /**
@@ -304,7 +534,7 @@ std::vector<int> Warehouse::get_walls()
  */
 std::vector<int> Warehouse::get_drops()
 {
-    return drops;
+    return layout->drops;
 }
 
 /**
@@ -314,7 +544,8 @@ std::vector<int> Warehouse::get_drops()
  */
 std::vector<int> Warehouse::get_heat_total()
 {
-    return heat_total;
+    std::vector<double> totals = heat_total.get_values();
+    return std::vector<int>(totals.begin(), totals.end());
 }
 
 /**
@@ -324,7 +555,20 @@ std::vector<int> Warehouse::get_heat_total()
  */
 std::vector<double> Warehouse::get_heat_window()
 {
-    return heat_window;
+    return heat_window.get_values();
+}
+
+/**
+ * Get the decaying heat at a single position. This avoids copying the whole
+ * heat window when only a few positions are needed.
+ *
+ * @param pos The position to look up.
+ *
+ * @return The heat window value at the position.
+ */
+double Warehouse::get_heat(int pos)
+{
+    return heat_window.get(pos);
 }
 
 /**
@@ -347,6 +591,47 @@ std::unordered_map<int,int> Warehouse::get_contention_spots()
     return contention_spots;
 }
 
+/**
+ * Get the decaying heat map along with its coarser levels, which the view
+ * draws from.
+ *
+ * @return The heat window.
+ */
+const StatPyramid& Warehouse::get_heat_window_pyramid()
+{
+    return heat_window;
+}
+
+/**
+ * Get the total heat map along with its coarser levels.
+ *
+ * @return The total heat map.
+ */
+const StatPyramid& Warehouse::get_heat_total_pyramid()
+{
+    return heat_total;
+}
+
+/**
+ * Get the number of contentions at each spot along with its coarser levels.
+ *
+ * @return The contentions.
+ */
+const StatPyramid& Warehouse::get_contention_pyramid()
+{
+    return contention_pyramid;
+}
+
+/**
+ * Get the number of deadlocks at each spot along with its coarser levels.
+ *
+ * @return The deadlocks.
+ */
+const StatPyramid& Warehouse::get_deadlock_pyramid()
+{
+    return deadlock_pyramid;
+}
+
 /**
  * Set the decay factory used for the heat window.
  *
@@ -356,3 +641,13 @@ void Warehouse::set_decay_factor(double factor)
 {
     this->decay_factor = factor;
 }
+
+/**
+ * Set the thread pool used to update the statistics.
+ *
+ * @param pool The thread pool to use.
+ */
+void Warehouse::set_thread_pool(ThreadPool *pool)
+{
+    this->thread_pool = pool;
+}
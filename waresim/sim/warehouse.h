@@ -1,24 +1,56 @@
 #ifndef SIM_WAREHOUSE_H
 #define SIM_WAREHOUSE_H
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "checkpoint/checkpoint_reader.h"
+#include "checkpoint/checkpoint_writer.h"
+#include "concurrent/thread_pool.h"
+#include "index/stat_pyramid.h"
+#include "index/worker_index.h"
 #include "worker.h"
 
 class Warehouse
 {
     public:
+        // The part of the warehouse that changes as the workers move, which
+        // is all a pipelined dispatcher needs to see of each tick.
+        struct WorkerState
+        {
+            // The workers in the warehouse.
+            std::vector<Worker> workers{};
+            // The locations of the workers in the warehouse.
+            std::vector<int> worker_locs{};
+            // Spatial index of the workers in the warehouse.
+            WorkerIndex worker_index;
+        };
+
         Warehouse();
         ~Warehouse();
 
         // Return the warehouse resulting from parsing the default representation
         // found in the given file.
         static Warehouse parse_default_warehouse(std::string);
+        // Return the warehouse written to a checkpoint.
+        static Warehouse load(CheckpointReader&);
+        // Write the warehouse to a checkpoint.
+        void save(CheckpointWriter&);
+        // Return a warehouse with the same layout, but no workers or
+        // statistics.
+        Warehouse copy_layout();
+        // Get a copy of the state of the workers.
+        WorkerState get_worker_state();
+        // Replace the state of the workers.
+        void set_worker_state(WorkerState&);
 
         // Move a worker's marker.
         void move_worker(int, int);
+        // Move several workers' markers at once.
+        void move_workers(const std::vector<std::pair<int,int>>&);
         // Mark that a spot has experienced a backoff by some worker at this 
         // position.
         void mark_contention(int);
@@ -33,6 +65,8 @@ class Warehouse
         std::vector<Worker>& get_workers();
         // Get the worker locations.
         std::vector<int> get_worker_locs();
+        // Get the spatial index of the workers.
+        WorkerIndex& get_worker_index();
         // Get the bin locations in the warehouse.
         std::vector<int> get_bins();
         // Get the drop locations in the warehouse.
@@ -40,36 +74,63 @@ class Warehouse
         // Get the wall locations.
         std::vector<int> get_walls();
         // Get the warehouse layout.
-        std::vector<int> get_layout();
+        const std::vector<int>& get_layout();
         // Get the total heat map.
         std::vector<int> get_heat_total();
         // Get the decaying heat map.
         std::vector<double> get_heat_window();
+        // Get the decaying heat at a single position.
+        double get_heat(int);
         // Get the deadlock spots.
         std::unordered_map<int,int> get_deadlock_spots();
         // Get the contention spots.
         std::unordered_map<int,int> get_contention_spots();
+        // Get the decaying heat map and its coarser levels.
+        const StatPyramid& get_heat_window_pyramid();
+        // Get the total heat map and its coarser levels.
+        const StatPyramid& get_heat_total_pyramid();
+        // Get the number of contentions at each spot and its coarser levels.
+        const StatPyramid& get_contention_pyramid();
+        // Get the number of deadlocks at each spot and its coarser levels.
+        const StatPyramid& get_deadlock_pyramid();
         // Set the decay factor for the heat window.
         void set_decay_factor(double);
+        // Set the thread pool used to update the statistics.
+        void set_thread_pool(ThreadPool *);
 
         // Mark that all workers have been moved.
         void update_iteration();
     private:
         // Reads the file and returns a vector containing its lines.
         static std::vector<std::string> read_file(std::string);
+        // Writes a map of spots to a checkpoint.
+        static void save_spots(CheckpointWriter&,
+                const std::unordered_map<int,int>&);
+        // Reads a map of spots from a checkpoint.
+        static std::unordered_map<int,int> load_spots(CheckpointReader&);
+
+        // The parts of the warehouse that never change during a simulation.
+        struct Layout
+        {
+            // The marker at each position.
+            std::vector<int> cells{};
+            // Bins in the warehouse.
+            std::vector<int> bins{};
+            // The walls in the warehouse.
+            std::vector<int> walls{};
+            // Drop-off locations in the warehouse.
+            std::vector<int> drops{};
+        };
 
-        // The warehouse layout.
-        std::vector<int> layout;
-        // Bins in the warehouse.
-        std::vector<int> bins{};
+        // The warehouse layout. It is immutable once parsed, so copies of the
+        // warehouse share it instead of copying it.
+        std::shared_ptr<const Layout> layout = std::make_shared<Layout>();
         // The workers in the warehouse.
         std::vector<Worker> workers{};
         // The locations of the workers in the warehouse.
         std::vector<int> worker_locs{};
-        // The walls in the warehouse.
-        std::vector<int> walls{};
-        // Drop-off locations in the warehouse.
-        std::vector<int> drops{};
+        // Spatial index of the workers in the warehouse.
+        WorkerIndex worker_index;
         // The height and width of the warehouse.
         int height, width;
 
@@ -77,16 +138,19 @@ class Warehouse
          * Statistics
          */
         // An exponentially decaying window of the number of times a spot in
-        // the warehouse has been touched. We use float, but this can be changed
-        // if precision is important.
-        std::vector<double> heat_window{};
+        // the warehouse has been touched. It is decayed lazily.
+        StatPyramid heat_window;
         // Holds the total number of times a spot in the warehouse has been
         // touched.
-        std::vector<int> heat_total{};
+        StatPyramid heat_total;
         // Holds the total number of times a deadlock has occurred in a spot.
         std::unordered_map<int,int> deadlock_spots{};
         // Holds the total number of times a conention has occurred in a spot.
         std::unordered_map<int,int> contention_spots{};
+        // The deadlocks and contentions again, summed over coarser levels for
+        // the view.
+        StatPyramid deadlock_pyramid;
+        StatPyramid contention_pyramid;
 
         // For exponential decaying window support. Tracks the moves that have
         // been made this iteration.
@@ -98,6 +162,9 @@ class Warehouse
         // Massive Datasets - RLU (2013)), but we need to tune it depending on
         // how fast we want spots to 'cool off'.
         double decay_factor = 1.0 - (0.1);
+
+        // The thread pool used to update the statistics, if any.
+        ThreadPool *thread_pool = nullptr;
 };
 
 #endif
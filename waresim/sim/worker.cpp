@@ -111,6 +111,17 @@ std::vector<Order> Worker::get_orders()
     return orders;
 }
 
+/**
+ * Returns the number of orders this worker is responsible for: the orders it
+ * has yet to pick up plus the orders it has yet to drop off.
+ *
+ * @return The number of orders the worker has not dropped off yet.
+ */
+int Worker::get_load()
+{
+    return orders.size() + orders_ready.size();
+}
+
 /**
  * Returns the order the worker is currently fulfilling.
  *
@@ -245,3 +256,49 @@ int Worker::get_initial_pos()
 {
     return initial_pos;
 }
+
+/**
+ * Writes the worker, its orders and its path to a checkpoint.
+ *
+ * @param writer The checkpoint to write to.
+ */
+void Worker::save(CheckpointWriter& writer)
+{
+    writer.write_int(my_id);
+    writer.write_int(initial_pos);
+    writer.write_int(pos);
+    writer.write_int(dest);
+    writer.write_int(orders.size());
+    for (auto& order : orders)
+        order.save(writer);
+    writer.write_int(orders_ready.size());
+    for (auto& order : orders_ready)
+        order.save(writer);
+    writer.write_bool(routed);
+    writer.write_bool(drop_needed);
+    current_order.save(writer);
+    writer.write_ints(path);
+}
+
+/**
+ * Restores the worker written by save(), replacing all of its state.
+ *
+ * @param reader The checkpoint to read from.
+ */
+void Worker::load(CheckpointReader& reader)
+{
+    my_id = reader.read_int();
+    initial_pos = reader.read_int();
+    pos = reader.read_int();
+    dest = reader.read_int();
+    orders.clear();
+    for (long long i = reader.read_int(); i > 0; i--)
+        orders.push_back(Order::load(reader));
+    orders_ready.clear();
+    for (long long i = reader.read_int(); i > 0; i--)
+        orders_ready.push_back(Order::load(reader));
+    routed = reader.read_bool();
+    drop_needed = reader.read_bool();
+    current_order = Order::load(reader);
+    path = reader.read_ints();
+}
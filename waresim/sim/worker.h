@@ -25,6 +25,8 @@ class Worker
         void set_routed(bool);
         // Return the orders assigned to this worker.
         std::vector<Order> get_orders();
+        // Return the number of orders the worker has not dropped off yet.
+        int get_load();
         // Return the orders the worker has picked up.
         std::vector<Order> get_ready_orders();
         // Get the current order.
@@ -55,6 +57,10 @@ class Worker
         void set_current_dest(int);
         // Get the current destination for the worker.
         int get_current_dest();
+        // Writes the worker to a checkpoint.
+        void save(CheckpointWriter&);
+        // Restores the worker from a checkpoint.
+        void load(CheckpointReader&);
 
     private:
         static int curr_id;
@@ -1,23 +1,297 @@
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "parser/config_parser.h"
+#include "parser/sweep_parser.h"
+#include "sim/concurrent/thread_pool.h"
 #include "sim/algo/contention/backoff_algo.h"
 #include "sim/algo/contention/contention_algo.h"
+#include "sim/algo/contention/wait_for_algo.h"
 #include "sim/algo/dispatch/dispatch_algo.h"
+#include "sim/algo/dispatch/matching_dispatch_algo.h"
+#include "sim/algo/dispatch/nearest_dispatch_algo.h"
 #include "sim/algo/dispatch/rand_dispatch_algo.h"
 #include "sim/algo/ordering/order_algo.h"
 #include "sim/algo/ordering/rand_order_algo.h"
+#include "sim/algo/path/distance_cache.h"
 #include "sim/algo/path/path_algo.h"
 #include "sim/algo/path/shortest_path_algo.h"
+#include "sim/algo/planning/ecbs_planning_algo.h"
+#include "sim/algo/planning/planning_algo.h"
 #include "sim/algo/routing/routing_algo.h"
 #include "sim/algo/routing/fcfs_routing_algo.h"
+#include "sim/algo/routing/tour_routing_algo.h"
+#include "sim/replay/replay_log.h"
+#include "sim/replicates.h"
 #include "sim/simulation.h"
+#include "sim/sweep.h"
 #include "sim/view/empty_view.h"
 #include "sim/view/opengl_view.h"
+#include "sim/view/software_view.h"
+#include "sim/view/stream_view.h"
 #include "sim/view/view.h"
 
+/**
+ * Returns a new dispatch algorithm.
+ *
+ * @param name The name of the algorithm in the config file.
+ * @param pool The thread pool the algorithm may use.
+ * @param distances The distance cache to share, or nullptr.
+ */
+DispatchAlgo *make_dispatch_algo(std::string name, ThreadPool *pool,
+        DistanceCache *distances)
+{
+    // Add statements as more dispatch algorithms are added.
+    if (name == "Nearest")
+        return new NearestDispatchAlgo();
+
+    if (name == "Matching")
+    {
+        MatchingDispatchAlgo *algo = new MatchingDispatchAlgo(pool);
+        if (distances != nullptr)
+            algo->set_distance_cache(distances);
+        return algo;
+    }
+
+    return new RandDispatchAlgo(Rand(std::rand()));
+}
+
+/**
+ * Returns a new routing algorithm.
+ *
+ * @param name The name of the algorithm in the config file.
+ * @param drop_weight The weight given to congestion around drop locations.
+ * @param distances The distance cache to share, or nullptr.
+ */
+RoutingAlgo *make_routing_algo(std::string name, double drop_weight,
+        DistanceCache *distances)
+{
+    // Add statements as more routing algorithms are added.
+    if (name == "Tour")
+    {
+        TourRoutingAlgo *algo = new TourRoutingAlgo();
+        if (distances != nullptr)
+            algo->set_distance_cache(distances);
+        return algo;
+    }
+
+    FCFSRoutingAlgo *algo = new FCFSRoutingAlgo(drop_weight);
+    if (distances != nullptr)
+        algo->set_distance_cache(distances);
+    return algo;
+}
+
+/**
+ * Returns a new pathfinding algorithm.
+ */
+PathAlgo *make_path_algo()
+{
+    // Add statements as more pathfinding algorithms are added.
+    return new ShortestPathAlgo(Rand(std::rand()));
+}
+
+/**
+ * Returns a new order generating algorithm.
+ *
+ * @param order_rate The probability that an order arrives each tick.
+ */
+OrderAlgo *make_order_algo(double order_rate)
+{
+    // Add statements as more ordering algorithms are added.
+    return new RandOrderAlgo(Rand(std::rand()), order_rate);
+}
+
+/**
+ * Returns a new contention algorithm.
+ *
+ * @param name The name of the algorithm in the config file.
+ */
+ContentionAlgo *make_contention_algo(std::string name)
+{
+    // Add statements as more contention algorithms are added.
+    if (name == "WaitFor")
+        return new WaitForAlgo();
+    return new BackoffAlgo();
+}
+
+/**
+ * Returns new algorithms for a headless run, as given in the config file.
+ *
+ * @param parser The parsed config file.
+ * @param thread_pool The thread pool the algorithms may use.
+ * @param distances The distance cache to share.
+ */
+Replicates::Algos make_algos(ConfigParser& parser, ThreadPool *thread_pool,
+        DistanceCache *distances)
+{
+    Replicates::Algos algos;
+    algos.dispatch_algo = make_dispatch_algo(parser.get_dispatch_algo(),
+            thread_pool, distances);
+    algos.routing_algo = make_routing_algo(parser.get_routing_algo(),
+            parser.get_drop_weight(), distances);
+    algos.path_algo = make_path_algo();
+    algos.order_algo = make_order_algo(parser.get_order_rate());
+    algos.contention_algo = make_contention_algo(parser.get_contention_algo());
+
+    return algos;
+}
+
+/**
+ * Deletes the algorithms of headless runs.
+ *
+ * @param all_algos The algorithms of each run.
+ */
+void delete_algos(std::vector<Replicates::Algos>& all_algos)
+{
+    for (auto& algos : all_algos)
+    {
+        delete algos.dispatch_algo;
+        delete algos.routing_algo;
+        delete algos.path_algo;
+        delete algos.order_algo;
+        delete algos.contention_algo;
+    }
+}
+
+/**
+ * Runs the simulation given in the config file headless on the event engine
+ * for ForkAt ticks, so that sweeps and replicates can fork from it instead of
+ * each simulating the warm up again.
+ *
+ * @param parser The parsed config file.
+ * @param thread_pool The thread pool the simulation may use.
+ * @param distances The distance cache to share.
+ * @param all_algos The algorithms of the simulation are added to these.
+ *
+ * @return The simulation, which the caller owns.
+ */
+Simulation *warm_up(ConfigParser& parser, ThreadPool *thread_pool,
+        DistanceCache *distances, std::vector<Replicates::Algos>& all_algos)
+{
+    Replicates::Algos algos = make_algos(parser, thread_pool, distances);
+    all_algos.push_back(algos);
+
+    Simulation *origin = new Simulation(0, parser.get_warehouse_file());
+    origin->set_order_algo(algos.order_algo);
+    origin->set_dispatch_algo(algos.dispatch_algo);
+    origin->set_routing_algo(algos.routing_algo);
+    origin->set_path_algo(algos.path_algo);
+    origin->set_contention_algo(algos.contention_algo);
+    origin->set_decay_factor(parser.get_decay_factor());
+    origin->set_thread_pool(thread_pool);
+    origin->set_wait_time(0);
+    origin->set_event_driven(true);
+    origin->set_ticks(parser.get_fork_at());
+    origin->set_restore(parser.get_restore());
+    origin->simulate();
+
+    return origin;
+}
+
+/**
+ * Runs the number of replicates given in the config file, each with its own
+ * algorithms, and reports their metrics. The algorithms are created here, in
+ * order, so each replicate's seeds follow from the config seed.
+ *
+ * @param parser The parsed config file.
+ * @param thread_pool The thread pool to run the replicates on.
+ */
+void run_replicates(ConfigParser& parser, ThreadPool *thread_pool)
+{
+    Replicates replicates(parser.get_warehouse_file());
+    replicates.set_ticks(parser.get_ticks());
+    replicates.set_decay_factor(parser.get_decay_factor());
+    replicates.set_thread_pool(thread_pool);
+    replicates.set_log_dir(parser.get_log_dir());
+
+    std::vector<Replicates::Algos> all_algos;
+    Simulation *origin = nullptr;
+    if (parser.get_fork_at() > 0)
+    {
+        origin = warm_up(parser, thread_pool,
+                replicates.get_distance_cache(), all_algos);
+        replicates.set_origin(origin);
+    }
+    else if (parser.get_restore() != "")
+    {
+        replicates.set_restore(parser.get_restore());
+    }
+
+    for (int i = 0; i < parser.get_replicates(); i++)
+    {
+        all_algos.push_back(make_algos(parser, thread_pool,
+                    replicates.get_distance_cache()));
+        replicates.add(all_algos.back());
+    }
+
+    replicates.run();
+
+    delete origin;
+    delete_algos(all_algos);
+}
+
+/**
+ * Runs every point of the sweep file given in the config file and writes a
+ * table of their results. Each point uses the config file with the point's
+ * values in place of the config's, and runs its replicates (at least one).
+ * The random generators are seeded again from the seed at every point, so
+ * the points only differ by their values.
+ *
+ * @param parser The parsed config file.
+ * @param thread_pool The thread pool to run the points on.
+ */
+void run_sweep(ConfigParser& parser, ThreadPool *thread_pool)
+{
+    SweepParser sweep_parser(parser.get_sweep());
+    sweep_parser.parse();
+
+    Sweep sweep;
+    sweep.set_thread_pool(thread_pool);
+    sweep.set_log_dir(parser.get_log_dir());
+
+    std::vector<Replicates::Algos> all_algos;
+    Simulation *origin = nullptr;
+    if (parser.get_fork_at() > 0)
+    {
+        std::srand(parser.get_seed());
+        origin = warm_up(parser, thread_pool,
+                sweep.get_distance_cache(parser.get_warehouse_file()),
+                all_algos);
+        sweep.set_origin(origin);
+    }
+    else if (parser.get_restore() != "")
+    {
+        sweep.set_restore(parser.get_restore());
+    }
+
+    for (auto& values : sweep_parser.get_points())
+    {
+        ConfigParser point = parser;
+        for (auto& value : values)
+            point.set(value.first, value.second);
+
+        std::string warehouse = point.get_warehouse_file();
+        sweep.add_point(values, warehouse, point.get_ticks(),
+                point.get_decay_factor());
+
+        std::srand(point.get_seed());
+        for (int i = 0; i < std::max(1, point.get_replicates()); i++)
+        {
+            all_algos.push_back(make_algos(point, thread_pool,
+                        sweep.get_distance_cache(warehouse)));
+            sweep.add_replicate(all_algos.back());
+        }
+    }
+
+    sweep.run();
+
+    delete origin;
+    delete_algos(all_algos);
+}
+
 /**
  * @author Joshua A. Campbell
  *
@@ -37,7 +311,15 @@ int main(int argc, char **argv)
 
     // Set up the configuration file parser and parse the config file.
     ConfigParser parser(std::string{argv[1]});
-    parser.parse();
+    try
+    {
+        parser.parse();
+    }
+    catch (const char *msg)
+    {
+        std::cout << msg << std::endl;
+        return 1;
+    }
 
     // Get config parameters.
     // These should be self-explanatory, but for more details see
@@ -54,37 +336,115 @@ int main(int argc, char **argv)
     std::string order_param     = parser.get_order_algo();
     std::string contention      = parser.get_contention_algo();
     double decay_factor         = parser.get_decay_factor();
-    
+    double drop_weight          = parser.get_drop_weight();
+    std::string planner         = parser.get_planner();
+    int planner_budget          = parser.get_planner_budget();
+    std::string moves           = parser.get_moves();
+    std::string engine          = parser.get_engine();
+    long ticks                  = parser.get_ticks();
+    double order_rate           = parser.get_order_rate();
+    int pipeline                = parser.get_pipeline();
+    int threads                 = parser.get_threads();
+    int replicates              = parser.get_replicates();
+
+    // Sweeps and replicates run headless, without a view.
+    if (parser.get_sweep() != "")
+    {
+        ThreadPool *thread_pool = new ThreadPool(threads);
+        try
+        {
+            run_sweep(parser, thread_pool);
+        }
+        catch (const char *msg)
+        {
+            std::cout << msg << std::endl;
+            delete thread_pool;
+            return 1;
+        }
+        delete thread_pool;
+        return 0;
+    }
+    if (replicates > 0)
+    {
+        std::srand(seed);
+        ThreadPool *thread_pool = new ThreadPool(threads);
+        try
+        {
+            run_replicates(parser, thread_pool);
+        }
+        catch (const char *msg)
+        {
+            std::cout << msg << std::endl;
+            delete thread_pool;
+            return 1;
+        }
+        delete thread_pool;
+        return 0;
+    }
+
     // Set up the view.
     View *view;
     if (view_param == "OpenGL")
         view = new OpenGLView();
+    else if (view_param == "Software")
+        view = new SoftwareView(parser.get_frames(), parser.get_frame_every());
+    else if (view_param == "Stream")
+        view = new StreamView(parser.get_socket());
     else
         view = new EmptyView();
+    view->set_frame_rate(parser.get_fps());
+
+    // A replay uses the seed of the run it replays, so that the algorithms
+    // are seeded the same way.
+    ReplayLog *replay = nullptr;
+    if (parser.get_replay() != "")
+    {
+        replay = new ReplayLog();
+        try
+        {
+            replay->load(parser.get_replay());
+        }
+        catch (const char *msg)
+        {
+            std::cout << msg << std::endl;
+            delete replay;
+            delete view;
+            return 1;
+        }
+        seed = replay->get_seed();
+    }
+    ReplayLog *recorder = nullptr;
+    if (parser.get_record() != "")
+    {
+        recorder = new ReplayLog();
+        recorder->set_seed(seed);
+    }
 
     // Set random seed. All other random generators should be seeded in a
     // deterministic order using std::rand(). We reset the seed because the
     // view might set the seed for itself.
     std::srand(seed);
 
-    // Add statements as more dispatch algorithms are added.
-    DispatchAlgo *dispatch_algo = new RandDispatchAlgo(Rand(std::rand()));
-
-    // Add statements as more routing algorithms are added.
-    RoutingAlgo *routing_algo = new FCFSRoutingAlgo();
-
-    // Add statements as more pathfinding algorithms are added.
-    PathAlgo *path_algo = new ShortestPathAlgo(Rand(std::rand()));
+    // The thread pool shared by the simulation and its algorithms.
+    ThreadPool *thread_pool = new ThreadPool(threads);
 
-    // Add statements as more ordering algorithms are added.
-    OrderAlgo *order_algo = new RandOrderAlgo(Rand(std::rand()));
+    DispatchAlgo *dispatch_algo =
+        make_dispatch_algo(dispatch_param, thread_pool, nullptr);
+    RoutingAlgo *routing_algo =
+        make_routing_algo(routing_param, drop_weight, nullptr);
+    PathAlgo *path_algo = make_path_algo();
+    OrderAlgo *order_algo = make_order_algo(order_rate);
+    ContentionAlgo *contention_algo = make_contention_algo(contention);
 
-    // Add statements as more contention algorithms are added.
-    ContentionAlgo *contention_algo = new BackoffAlgo();
+    // Add statements as more planning algorithms are added.
+    PlanningAlgo *planning_algo = nullptr;
+    if (planner == "ECBS")
+        planning_algo = new ECBSPlanningAlgo(planner_budget);
 
     // Set up the simulation.
     Simulation sim(sim_length, warehouse);
     sim.set_contention_algo(contention_algo);
+    sim.set_planning_algo(planning_algo);
     sim.set_dispatch_algo(dispatch_algo);
     sim.set_routing_algo(routing_algo);
     sim.set_order_algo(order_algo);
@@ -93,18 +453,43 @@ int main(int argc, char **argv)
     sim.set_log_dir(log_dir);
     sim.set_wait_time(wait_time);
     sim.set_decay_factor(decay_factor);
+    sim.set_two_phase(moves == "TwoPhase");
+    sim.set_event_driven(engine == "Event");
+    sim.set_ticks(ticks);
+    sim.set_pipeline(pipeline);
+    sim.set_thread_pool(thread_pool);
+    sim.set_checkpoint(parser.get_checkpoint(), parser.get_checkpoint_every());
+    sim.set_restore(parser.get_restore());
+    sim.set_recorder(recorder);
+    sim.set_replay(replay);
 
-    // Start the simulation and wait for it to finish.
-    sim.start();
+    // Start the simulation and wait for it to finish. Starting fails if the
+    // checkpoint to restore cannot be read.
+    try
+    {
+        sim.start();
+    }
+    catch (const char *msg)
+    {
+        std::cout << msg << std::endl;
+        return 1;
+    }
     sim.join();
 
+    if (recorder != nullptr)
+        recorder->save(parser.get_record());
+
     // Delete allocated memory.
     delete dispatch_algo;
     delete routing_algo;
     delete path_algo;
     delete order_algo;
     delete contention_algo;
+    delete planning_algo;
     delete view;
+    delete thread_pool;
+    delete recorder;
+    delete replay;
 
     return 0;
 }